@@ -51,7 +51,63 @@
 
 /*==================[external functions definition]==========================*/
 
-// C++ version 0.4 char* style "itoa":
+// Digits are generated least significant first and reversed at the end.
+// Base 10 does one 64-bit division every 9 digits and divides the 32-bit
+// chunks by 10 with a reciprocal multiplication; power of two bases only
+// shift and mask. Other bases keep the generic per-digit division.
+static const char digitTable[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+static uint8_t decimalChunkToString( uint32_t value, char* ptr, bool_t fixed ){
+   uint8_t count = 0;
+   do {
+      // value / 10 for any 32 bit value: 0xCCCCCCCD = ceil(2^35 / 10)
+      uint32_t q = (uint32_t)(((uint64_t)value * 0xCCCCCCCDu) >> 35);
+      ptr[count++] = (char)('0' + (value - q * 10));
+      value = q;
+   } while( fixed ? count < 9 : value );
+   return count;
+}
+
+static char* magnitudeToReversedString( uint64_t value, char* ptr, uint8_t base ){
+   if( base == 10 ){
+      while( value > 0xFFFFFFFFu ){
+         uint64_t q = value / 1000000000u;
+         ptr += decimalChunkToString( (uint32_t)(value - q * 1000000000u), ptr, TRUE );
+         value = q;
+      }
+      ptr += decimalChunkToString( (uint32_t)value, ptr, FALSE );
+   }
+   else if( (base & (base - 1)) == 0 ){
+      uint8_t shift = 0;
+      while( (1u << shift) < base ){
+         shift++;
+      }
+      do {
+         *ptr++ = digitTable[value & (base - 1)];
+         value >>= shift;
+      } while( value );
+   }
+   else {
+      do {
+         uint64_t q = value / base;
+         *ptr++ = digitTable[value - q * base];
+         value = q;
+      } while( value );
+   }
+   return ptr;
+}
+
+static void reverseString( char* ptr1, char* ptr ){
+   char tmp_char;
+   *ptr-- = '\0';
+   while(ptr1 < ptr) {
+      tmp_char = *ptr;
+      *ptr--= *ptr1;
+      *ptr1++ = tmp_char;
+   }
+}
+
+// Based on C++ version 0.4 char* style "itoa":
 // Written by Luk�s Chmela
 // Released under GPLv3.
 // Modified by Eric Pernia.
@@ -62,27 +118,16 @@ bool_t int64ToString( int64_t value, char* result, uint8_t base ){
       return FALSE;
    }
 
-   char* ptr = result, *ptr1 = result, tmp_char;
-   int64_t tmp_value;
-
-   do {
-      tmp_value = value;
-      value /= (int64_t)base;
-      *ptr++ = "zyxwvutsrqponmlkjihgfedcba9876543210123456789abcdefghijklmnopqrstuvwxyz" [35 + (tmp_value - value * (int64_t)base)];
-   } while ( value );
+   uint64_t magnitude = (value < 0) ? 0u - (uint64_t)value : (uint64_t)value;
+   char* ptr = magnitudeToReversedString( magnitude, result, base );
 
    // Apply negative sign
-   if (tmp_value < 0) *ptr++ = '-';
-   *ptr-- = '\0';
-   while(ptr1 < ptr) {
-      tmp_char = *ptr;
-      *ptr--= *ptr1;
-      *ptr1++ = tmp_char;
-   }
+   if (value < 0) *ptr++ = '-';
+   reverseString( result, ptr );
    return TRUE;
 }
 
-// C++ version 0.4 char* style "itoa":
+// Based on C++ version 0.4 char* style "itoa":
 // Written by Luk�s Chmela
 // Released under GPLv3.
 // Modified by Eric Pernia.
@@ -93,23 +138,7 @@ bool_t uint64ToString( uint64_t value, char* result, uint8_t base ){
       return FALSE;
    }
 
-   char* ptr = result, *ptr1 = result, tmp_char;
-   uint64_t tmp_value;
-
-   do {
-      tmp_value = value;
-      value /= (uint64_t)base;
-      *ptr++ = "zyxwvutsrqponmlkjihgfedcba9876543210123456789abcdefghijklmnopqrstuvwxyz" [35 + (tmp_value - value * (uint64_t)base)];
-   } while ( value );
-
-   // Apply negative sign
-   if (tmp_value < 0) *ptr++ = '-';
-   *ptr-- = '\0';
-   while(ptr1 < ptr) {
-      tmp_char = *ptr;
-      *ptr--= *ptr1;
-      *ptr1++ = tmp_char;
-   }
+   reverseString( result, magnitudeToReversedString( value, result, base ) );
    return TRUE;
 }
 
@@ -0,0 +1,83 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+#include "fsm.h"
+
+
+#define     ARMING_PERIOD_MSEC      6000
+#define     DOOR_DISARMING_MSEC     6000
+
+
+enum APP_State
+{
+    APP_StateNone = FSM_StateNone,
+    APP_StatePassword,
+    APP_StateActiva,
+    APP_StateDesarmada,
+    APP_StateDiegoArmando,
+    APP_StateArmada,
+    APP_StateIntruso,
+    APP_StateDesarmando,
+    APP_State_COUNT
+};
+
+
+enum APP_Event
+{
+    APP_EventTimeout = FSM_EventTimeout,
+    APP_EventPasswordAsking,
+    APP_EventPasswordAskAgain,
+    APP_EventPasswordMatch,
+    APP_EventCancel,
+    APP_EventSensorWindow,
+    APP_EventSensorDoor,
+    APP_EventRetriesExhausted,
+    APP_Event_COUNT
+};
+
+
+// MEF de la alarma en flash. Las acciones las define la aplicacion (main.c),
+// las pruebas de host las reemplazan por las propias.
+extern const struct FSM_Table AlarmTable;
+
+
+void    FEMState_DesarmadaEntry      (struct FEM *f);
+void    FEMState_DiegoArmandoEntry   (struct FEM *f);
+void    FEMState_DiegoArmandoCancel  (struct FEM *f);
+void    FEMState_DiegoArmandoTimeout (struct FEM *f);
+void    FEMState_ArmadaEntry         (struct FEM *f);
+void    FEMState_ArmadaExit          (struct FEM *f);
+void    FEMState_ArmadaSensorWindow  (struct FEM *f);
+void    FEMState_ArmadaSensorDoor    (struct FEM *f);
+void    FEMState_IntrusoEntry        (struct FEM *f);
+void    FEMState_PasswordAsking      (struct FEM *f);
+void    FEMState_DesarmandoEntry     (struct FEM *f);
+void    FEMState_DesarmandoAskAgain  (struct FEM *f);
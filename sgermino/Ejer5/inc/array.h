@@ -33,18 +33,42 @@
 #include <stdbool.h>
 
 
+// Bytes compartidos por ARRAY_InitFromArena(), 0 lo deshabilita
+#ifndef ARRAY_ARENA_SIZE
+    #define ARRAY_ARENA_SIZE    128
+#endif
+
+
+enum ARRAY_Flags
+{
+    ARRAY_FlagNone          = 0,
+    // Reserva el ultimo byte para el '\0' de ARRAY_Terminate()
+    ARRAY_FlagTerminator    = 1 << 0
+};
+
+
 struct ARRAY
 {
     uint8_t     *data;
     uint32_t    index;
     uint32_t    capacity;
+    uint32_t    flags;
 };
 
 
+// ARRAY_Init() reserva el terminador (ARRAY_FlagTerminator)
 bool        ARRAY_Init                  (struct ARRAY *a, uint8_t *data,
                                          uint32_t capacity);
+bool        ARRAY_InitFlags             (struct ARRAY *a, uint8_t *data,
+                                         uint32_t capacity, uint32_t flags);
+// Toma capacity bytes del arena estatico; se devuelven en orden inverso
+bool        ARRAY_InitFromArena         (struct ARRAY *a, uint32_t capacity,
+                                         uint32_t flags);
+bool        ARRAY_ReleaseToArena        (struct ARRAY *a);
+uint32_t    ARRAY_ArenaFree             ();
 void        ARRAY_Reset                 (struct ARRAY *a);
 uint32_t    ARRAY_Elements              (struct ARRAY *a);
+uint32_t    ARRAY_Free                  (struct ARRAY *a);
 bool        ARRAY_Full                  (struct ARRAY *a);
 bool        ARRAY_Append                (struct ARRAY *a, uint8_t element);
 bool        ARRAY_AppendString          (struct ARRAY *a, const char *str);
@@ -55,3 +79,5 @@ bool        ARRAY_Terminate             (struct ARRAY *a);
 bool        ARRAY_CheckAlnumChars       (struct ARRAY *a);
 bool        ARRAY_CheckDecimalChars     (struct ARRAY *a);
 bool        ARRAY_CheckEqualContents    (struct ARRAY *a, struct ARRAY *b);
+bool        ARRAY_CheckEqualContentsConstTime
+                                        (struct ARRAY *a, struct ARRAY *b);
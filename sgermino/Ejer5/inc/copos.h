@@ -1,5 +1,6 @@
 #pragma once
 #include <stdint.h>
+#include <stdbool.h>
 
 
 /* The maximum number of tasks required at any one time during the execution
@@ -8,6 +9,88 @@
    #define SCHEDULER_MAX_TASKS   (15)
 #endif
 
+/* Timer wheel backend: schedulerUpdate() only visits one wheel slot per tick
+   and schedulerDispatchTasks() only runs through the tasks that are due. Set
+   to 0 to use the original backend, which scans every task slot each tick. */
+#ifndef SCHEDULER_TIMER_WHEEL
+   #define SCHEDULER_TIMER_WHEEL   (1)
+#endif
+
+/* Number of slots in the timer wheel. MUST be a power of two. Tasks with
+   periods up to this value never wait a full wheel revolution. */
+#ifndef SCHEDULER_WHEEL_SLOTS
+   #define SCHEDULER_WHEEL_SLOTS   (64)
+#endif
+
+/* Tickless idle: when no task is due, schedulerDispatchTasks() sleeps until
+   the next task deadline instead of waking up on every tick. */
+#ifndef SCHEDULER_TICKLESS
+   #define SCHEDULER_TICKLESS      (1)
+#endif
+
+/* Per task execution time, release jitter and missed deadline statistics,
+   measured with the DWT cycle counter (clock_gettime() on host builds). */
+#ifndef SCHEDULER_PROFILE
+   #define SCHEDULER_PROFILE       (1)
+#endif
+
+/* Longest hyperperiod (ticks) schedulerAnalyze() will replay */
+#ifndef SCHEDULER_ANALYSIS_MAX_TICKS
+   #define SCHEDULER_ANALYSIS_MAX_TICKS    (100000)
+#endif
+
+/* Hard bound on the work of a single analysis, counted in release checks
+   (one task at one tick: a division and a compare). schedulerAnalyze() and
+   schedulerAddTask() with auto offset
+   enabled run it synchronously; schedulerPutProfileMessage() runs it in
+   steps, see SCHEDULER_ANALYSIS_STEP_CHECKS:
+     - schedulerAnalyze():          hyperperiod * tasks to replay, and
+                                    hyperperiod * tasks * (tasks + 3) / 2
+                                    to also suggest balanced offsets
+     - schedulerBalancedDelay():    hyperperiod * tasks
+   Steps over the bound are skipped. With the 7 tasks of main.c (14000
+   ticks hyperperiod) schedulerAnalyze() needs 490000 and the auto offset
+   adds at boot at most 253232 in total. The host replay in
+   test/test_copos_analysis.c times those adds (about 0.5 ms on an x86-64
+   PC); they have not been timed on the target. */
+#ifndef SCHEDULER_ANALYSIS_MAX_CHECKS
+   #define SCHEDULER_ANALYSIS_MAX_CHECKS   (500000)
+#endif
+
+/* Release checks schedulerPutProfileMessage() spends on the analysis in each
+   call, see schedulerAnalyzeStep(). A full analysis takes up to
+   SCHEDULER_ANALYSIS_MAX_CHECKS / SCHEDULER_ANALYSIS_STEP_CHECKS calls. */
+#ifndef SCHEDULER_ANALYSIS_STEP_CHECKS
+   #define SCHEDULER_ANALYSIS_STEP_CHECKS  (50000)
+#endif
+
+
+/* Order in which schedulerDispatchTasks() runs the tasks that are due */
+typedef enum
+{
+    // Each due task once, by position in the task array (original behavior)
+    SCHEDULER_DISPATCH_SLOT_ORDER = 0,
+    // Highest priority first, re-checked after each task
+    SCHEDULER_DISPATCH_PRIORITY,
+    // Earliest absolute deadline first, re-checked after each task
+    SCHEDULER_DISPATCH_EDF
+}
+eDispatchPolicy_t;
+
+
+/* What to do with the pending runs of a periodic task that was released
+   again before its previous run could start */
+typedef enum
+{
+    // Run once per release, back to back (original behavior)
+    SCHEDULER_OVERRUN_CATCHUP = 0,
+    // A single run covers every pending release
+    SCHEDULER_OVERRUN_COALESCE,
+    // Drop the late runs and wait for the next release
+    SCHEDULER_OVERRUN_SKIP
+}
+eOverrunPolicy_t;
+
 
 typedef struct
 {
@@ -21,10 +104,121 @@ typedef struct
     int32_t period;
     // Incremented (by scheduler) when task is due to execute
     int32_t runMe;
+    // Higher values run first (SCHEDULER_DISPATCH_PRIORITY)
+    uint8_t priority;
+    // Ticks from release to deadline, 0 uses the period
+    // - see schedulerSetTaskDeadline() for further details
+    uint32_t deadline;
+    // Tick at which the oldest pending run is due (SCHEDULER_DISPATCH_EDF)
+    uint32_t deadlineTicks;
+    // eOverrunPolicy_t
+    uint8_t overrunPolicy;
+    // Runs that started with more than one release pending
+    uint32_t overruns;
+    // Releases that did not get a run of their own (coalesced or skipped)
+    uint32_t droppedRuns;
+#if SCHEDULER_TIMER_WHEEL
+    // Wheel revolutions left before the task is due
+    uint32_t rounds;
+    // Wheel slot the task is linked into
+    uint8_t slot;
+    // Next task (index + 1) in the same slot, 0 ends the list
+    uint8_t next;
+#endif
 }
 sTask_t;
 
 
+typedef struct
+{
+    // Completed runs
+    uint32_t runs;
+    // Execution time (profiler clock cycles)
+    uint32_t cyclesMin;
+    uint32_t cyclesMax;
+    uint64_t cyclesTotal;
+    // Cycles from release (runMe incremented) to start of execution
+    uint32_t latencyMin;
+    uint32_t latencyMax;
+    // Runs that finished after the task was released again
+    uint32_t missedDeadlines;
+    // Highest runMe value seen at dispatch
+    int32_t backlogMax;
+    // Profiler clock at the last release
+    uint32_t released;
+}
+sTaskProfile_t;
+
+
+/* Static analysis of the periodic tasks in the task array, replaying one
+   hyperperiod from their current release phases */
+typedef struct
+{
+    // Periodic tasks analyzed
+    uint32_t tasks;
+    // Sum of WCET / period, in parts per million of the CPU
+    uint32_t utilization;
+    // Least common multiple of the periods (ticks), 0 if longer than
+    // SCHEDULER_ANALYSIS_MAX_TICKS or if replaying it takes more than
+    // SCHEDULER_ANALYSIS_MAX_CHECKS (nothing else is computed)
+    uint32_t hyperperiod;
+    // Most tasks released in a single tick, and number of such ticks
+    uint32_t peakTasks;
+    uint32_t peakTicks;
+    // Ticks where more than one task is released
+    uint32_t collisionTicks;
+    // Highest sum of WCET released in a single tick (cycles), and the
+    // cycles available per tick
+    uint32_t peakCycles;
+    uint32_t tickCycles;
+    // Suggested first release delay of each task, 0 for free or one shot
+    // slots. Flattens the number of tasks released in a single tick.
+    // All 0 when balancing takes more than SCHEDULER_ANALYSIS_MAX_CHECKS.
+    uint32_t offset[SCHEDULER_MAX_TASKS];
+    // Most tasks released in a single tick with the suggested offsets
+    uint32_t balancedPeakTasks;
+}
+sSchedulerAnalysis_t;
+
+
+// Periodic task as seen by the analysis
+typedef struct
+{
+    uint32_t index;
+    uint32_t period;
+    // Release ticks are those congruent with phase modulo period
+    uint32_t phase;
+    uint32_t wcet;
+}
+sAnalysisTask_t;
+
+
+/* An analysis run a bounded step at a time, see schedulerAnalyzeBegin().
+   The result is in 'analysis' once schedulerAnalyzeStep() returns false. */
+typedef struct
+{
+    sSchedulerAnalysis_t analysis;
+    // Periodic tasks as they were at schedulerAnalyzeBegin()
+    sAnalysisTask_t set[SCHEDULER_MAX_TASKS];
+    uint32_t count;
+    // Balancing fits in SCHEDULER_ANALYSIS_MAX_CHECKS
+    bool balance;
+    // Progress: stage, tick or offset within it
+    uint8_t stage;
+    uint32_t cursor;
+    // Tasks placed so far with their balanced phases, the one being placed
+    // (index into 'set', 'count' if none) and its best offset yet
+    sAnalysisTask_t placed[SCHEDULER_MAX_TASKS];
+    uint32_t placedCount;
+    uint32_t placedMask;
+    uint32_t current;
+    uint32_t bestOffset;
+    uint32_t bestPeak;
+    uint32_t bestSum;
+}
+sSchedulerAnalysisJob_t;
+
+
 void        schedulerInit           (void);
 void        schedulerStart          (uint32_t);
 void        schedulerUpdate         (uint32_t ticks);
@@ -34,5 +228,29 @@ uint32_t    schedulerAddTask        (void (* pFunction)(void *ctx,
                                      void *context, uint32_t delay,
                                      uint32_t period);
 int8_t      schedulerModifyTaskPeriod (uint32_t taskIndex, uint32_t newPeriod);
+int8_t      schedulerSetTaskPriority (uint32_t taskIndex, uint8_t priority);
+int8_t      schedulerSetTaskDeadline (uint32_t taskIndex, uint32_t deadline);
+int8_t      schedulerSetTaskOverrunPolicy (uint32_t taskIndex,
+                                           eOverrunPolicy_t policy);
+void        schedulerSetDispatchPolicy (eDispatchPolicy_t policy);
+void        schedulerSetAutoOffset  (bool enable);
+void        schedulerSetTimerService (uint32_t (* process)(uint32_t now),
+                                      bool (* ticksToNext)(uint32_t now,
+                                                           uint32_t *ticks));
+int8_t      schedulerSignalTask     (uint32_t taskIndex);
 int8_t      schedulerDeleteTask     (uint32_t taskIndex);
 void        schedulerReportStatus   (void);
+uint32_t    schedulerTicksToRelease (uint32_t taskIndex);
+int8_t      schedulerAnalyze        (sSchedulerAnalysis_t* a,
+                                     const uint32_t wcet[]);
+int8_t      schedulerAnalyzeBegin   (sSchedulerAnalysisJob_t* j,
+                                     const uint32_t wcet[]);
+bool        schedulerAnalyzeStep    (sSchedulerAnalysisJob_t* j,
+                                     uint32_t maxChecks);
+uint32_t    schedulerBalancedDelay  (uint32_t delay, uint32_t period);
+#if SCHEDULER_PROFILE
+const sTaskProfile_t*
+            schedulerGetTaskProfile (uint32_t taskIndex);
+uint32_t    schedulerProfileRate    (void);
+void        schedulerResetProfile   (void);
+#endif
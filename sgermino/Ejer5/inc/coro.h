@@ -0,0 +1,105 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+#include "cyclic.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+    Corrutinas sin stack (protothreads) para tareas de copos.
+
+    La funcion de la tarea sigue siendo llamada por schedulerDispatchTasks()
+    y retorna en cada espera; struct CORO guarda en que linea continuar. Las
+    variables locales NO se conservan entre esperas: lo que deba sobrevivir
+    va en el contexto de la tarea. No se puede usar switch alrededor de una
+    espera dentro del cuerpo de la corrutina.
+
+    enum X tarea (struct CTX *ctx)
+    {
+        CORO_BEGIN      (&ctx->coro);
+        CORO_AWAIT      (&ctx->coro, condicion, X_Esperando);
+        ...
+        CORO_YIELD      (&ctx->coro, X_Parcial);
+        ...
+        CORO_END        (&ctx->coro, X_Terminado);
+    }
+*/
+
+
+struct CORO
+{
+    // Linea donde continuar, 0 al principio
+    uint16_t        line;
+    // Marca de tiempo de CORO_AWAIT_TICKS
+    uint32_t        waitStart;
+    // Seteada por CORO_Signal, consumida por CORO_AWAIT_SIGNAL
+    volatile bool   signaled;
+};
+
+
+#define CORO_BEGIN(c) \
+    switch ((c)->line) { case 0:
+
+// Retorna 'ret' y continua despues de esta linea en la proxima llamada
+#define CORO_YIELD(c,ret) \
+    do { (c)->line = __LINE__; return (ret); case __LINE__:; } while (0)
+
+// Retorna 'ret' mientras 'cond' sea falsa
+#define CORO_AWAIT(c,cond,ret) \
+    do { (c)->line = __LINE__; case __LINE__: \
+         if (!(cond)) return (ret); } while (0)
+
+// Espera que pasen 'timeout' ticks; 'now' es el tick actual de cada llamada
+#define CORO_AWAIT_TICKS(c,now,timeout,ret) \
+    do { (c)->waitStart = (now); \
+         CORO_AWAIT (c, (uint32_t)((now) - (c)->waitStart) >= (timeout), \
+                     ret); } while (0)
+
+// Espera datos en un buffer circular
+#define CORO_AWAIT_DATA(c,cyclic,ret) \
+    CORO_AWAIT (c, CYCLIC_Pending (cyclic), ret)
+
+// Espera un CORO_Signal() (de otra tarea o de una ISR) y lo consume
+#define CORO_AWAIT_SIGNAL(c,ret) \
+    do { CORO_AWAIT (c, (c)->signaled, ret); (c)->signaled = false; } \
+    while (0)
+
+// Vuelve al principio y retorna 'ret'
+#define CORO_RESTART(c,ret) \
+    do { (c)->line = 0; return (ret); } while (0)
+
+#define CORO_END(c,ret) \
+    } (c)->line = 0; return (ret)
+
+
+void    CORO_Init       (struct CORO *c);
+void    CORO_Signal     (struct CORO *c);
@@ -53,9 +53,13 @@ struct CYCLIC
 bool        CYCLIC_Init             (struct CYCLIC *c, uint8_t *data,
                                      uint32_t capacity);
 uint32_t    CYCLIC_Pending          (struct CYCLIC *c);
+uint32_t    CYCLIC_Free             (struct CYCLIC *c);
 bool        CYCLIC_In               (struct CYCLIC *c, const uint8_t data);
 bool        CYCLIC_InFromBuffer     (struct CYCLIC *c, const uint8_t *data,
                                      uint32_t size);
+bool        CYCLIC_InFromBufferNoOverwrite
+                                    (struct CYCLIC *c, const uint8_t *data,
+                                     uint32_t size);
 uint32_t    CYCLIC_InFromStream     (struct CYCLIC *c,
                                      STREAM_ByteInFunc streamFunc,
                                      void *streamFuncHandler,
@@ -68,4 +72,12 @@ uint32_t    CYCLIC_OutToStream      (struct CYCLIC *c,
                                      void *streamFuncHandler,
                                      uint32_t maxBytes);
 uint8_t     CYCLIC_Peek             (struct CYCLIC *c, uint32_t offset);
+// Acceso directo a porciones contiguas de c->data (sin copias)
+uint8_t *   CYCLIC_Reserve          (struct CYCLIC *c, uint32_t *size);
+bool        CYCLIC_Commit           (struct CYCLIC *c, uint32_t count);
+const uint8_t *
+            CYCLIC_PeekSpan         (struct CYCLIC *c, uint32_t offset,
+                                     uint32_t *size);
+bool        CYCLIC_Consume          (struct CYCLIC *c, uint32_t count);
+bool        CYCLIC_Discard          (struct CYCLIC *c, uint32_t count);
 bool        CYCLIC_DiscardPending   (struct CYCLIC *c);
@@ -0,0 +1,92 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+
+// Buffer circular para un unico productor y un unico consumidor que pueden
+// ejecutarse en contextos distintos (por ej. interrupcion y loop principal)
+// sin bloquear interrupciones. Cada indice y cada estadistica tiene un solo
+// escritor. Los indices corren libres (no se enmascaran al guardarlos), por
+// lo que se puede usar la capacidad completa del buffer.
+#ifdef __arm__
+    typedef volatile uint32_t   CYCLIC_SPSC_Index;
+#else
+    #include <stdatomic.h>
+    typedef _Atomic uint32_t    CYCLIC_SPSC_Index;
+#endif
+
+
+struct CYCLIC_SPSC_Producer
+{
+    CYCLIC_SPSC_Index   inIndex;
+    uint32_t            writes;
+    // Bytes rechazados por falta de espacio
+    uint32_t            overflows;
+};
+
+
+struct CYCLIC_SPSC_Consumer
+{
+    CYCLIC_SPSC_Index   outIndex;
+    uint32_t            reads;
+    uint32_t            peeks;
+    uint32_t            discards;
+};
+
+
+struct CYCLIC_SPSC
+{
+    uint8_t                         *data;
+    uint32_t                        capacity;
+    struct CYCLIC_SPSC_Producer     prod;
+    struct CYCLIC_SPSC_Consumer     cons;
+};
+
+
+bool        CYCLIC_SPSC_Init            (struct CYCLIC_SPSC *c, uint8_t *data,
+                                         uint32_t capacity);
+// Productor
+uint32_t    CYCLIC_SPSC_Free            (struct CYCLIC_SPSC *c);
+bool        CYCLIC_SPSC_In              (struct CYCLIC_SPSC *c,
+                                         const uint8_t data);
+uint32_t    CYCLIC_SPSC_InFromBuffer    (struct CYCLIC_SPSC *c,
+                                         const uint8_t *data, uint32_t size);
+// Consumidor
+uint32_t    CYCLIC_SPSC_Pending         (struct CYCLIC_SPSC *c);
+bool        CYCLIC_SPSC_Out             (struct CYCLIC_SPSC *c, uint8_t *data);
+uint32_t    CYCLIC_SPSC_OutToBuffer     (struct CYCLIC_SPSC *c, uint8_t *data,
+                                         uint32_t count);
+uint8_t     CYCLIC_SPSC_Peek            (struct CYCLIC_SPSC *c,
+                                         uint32_t offset);
+uint32_t    CYCLIC_SPSC_Discard         (struct CYCLIC_SPSC *c,
+                                         uint32_t count);
@@ -0,0 +1,64 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+
+// Conversion de numeros a texto sin snprintf ni aritmetica de doble
+// precision. Todas las funciones escriben como maximo size - 1 caracteres
+// mas el terminador y, como snprintf, devuelven el largo completo del
+// resultado (si es >= size, el texto quedo truncado).
+//
+// width: largo minimo, completando a la izquierda con pad. Con pad '0' el
+// signo o prefijo queda antes de los ceros.
+
+#ifndef FMT_FLOAT_MAX_DECIMALS
+    #define FMT_FLOAT_MAX_DECIMALS  9
+#endif
+
+// Decimales por defecto, igual que "%f"
+#define FMT_FLOAT_DECIMALS          6
+
+
+uint32_t    FMT_Uint32      (char *dst, uint32_t size, uint32_t value,
+                             uint32_t width, char pad);
+uint32_t    FMT_Int32       (char *dst, uint32_t size, int32_t value,
+                             uint32_t width, char pad);
+uint32_t    FMT_Uint64      (char *dst, uint32_t size, uint64_t value,
+                             uint32_t width, char pad);
+uint32_t    FMT_Int64       (char *dst, uint32_t size, int64_t value,
+                             uint32_t width, char pad);
+uint32_t    FMT_Hex32       (char *dst, uint32_t size, uint32_t value,
+                             uint32_t width, char pad, bool upper);
+uint32_t    FMT_Pointer     (char *dst, uint32_t size, const void *p);
+uint32_t    FMT_Float       (char *dst, uint32_t size, float value,
+                             uint32_t decimals, uint32_t width, char pad);
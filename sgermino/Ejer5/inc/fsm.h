@@ -29,6 +29,8 @@
     POSSIBILITY OF SUCH DAMAGE.
 */
 #pragma once
+#include "cyclic_spsc.h"
+#include "swtimer.h"
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -37,6 +39,16 @@
     #define FSM_MAX_RECURRING_CALLS     99
 #endif
 
+// Niveles de anidamiento de estados del motor por tabla
+#ifndef FSM_MAX_STATE_DEPTH
+    #define FSM_MAX_STATE_DEPTH         8
+#endif
+
+// Eventos en espera del motor por tabla, potencia de 2
+#ifndef FSM_EVENT_QUEUE_SIZE
+    #define FSM_EVENT_QUEUE_SIZE        8
+#endif
+
 
 enum FSM_Stage
 {
@@ -59,6 +71,56 @@ typedef enum FSM_StateReturn (* FSM_StateFunc) (struct FEM *f,
                                          enum FSM_Stage stage, uint32_t ticks);
 
 
+// Motor por tabla: estados y eventos son indices en tablas constantes (en
+// flash). El estado 0 esta reservado y el evento 0 es el timeout del estado.
+// Como destino, FSM_StateSelf sale y vuelve a entrar al estado actual.
+#define FSM_StateNone       0
+#define FSM_StateSelf       0xFF
+#define FSM_EventTimeout    0
+
+typedef void (* FSM_ActionFunc) (struct FEM *f);
+typedef void (* FSM_PostHookFunc) (void *ctx);
+typedef bool (* FSM_GuardFunc)  (struct FEM *f);
+
+
+struct FSM_TableState
+{
+    const char      *info;
+    FSM_ActionFunc  entry;
+    FSM_ActionFunc  exit;
+    // Ticks desde la entrada al estado hasta que el servicio de timers
+    // publique FSM_EventTimeout, 0 sin timeout
+    uint32_t        timeoutTicks;
+    // Estado padre: atiende los eventos que este estado no atiende
+    uint8_t         parent;
+};
+
+
+// Sin target ni action el evento no se atiende en ese estado y pasa al padre,
+// igual que si la guarda no lo permite. Sin target pero con action es una
+// transicion interna: no llama a exit ni a entry.
+struct FSM_Transition
+{
+    uint8_t         target;
+    FSM_GuardFunc   guard;
+    FSM_ActionFunc  action;
+};
+
+
+struct FSM_Table
+{
+    const struct FSM_TableState *states;
+    // stateCount x eventCount, indexada [estado][evento]
+    const struct FSM_Transition *transitions;
+    // stateCount x stateCount, el ancestro comun de cada par de estados
+    // [origen][destino]. Constante como el resto de la tabla; FSM_InitTable()
+    // lo verifica contra los padres. NULL si no hay estados anidados.
+    const uint8_t   *lca;
+    uint8_t         stateCount;
+    uint8_t         eventCount;
+};
+
+
 struct FEM
 {
     FSM_StateFunc   state;
@@ -72,6 +134,19 @@ struct FEM
     void            *app;
     FSM_StateFunc   invalidStage;
     FSM_StateFunc   maxRecCalls;
+    const struct FSM_Table *table;
+    uint8_t         stateId;
+    bool            dispatching;
+    // Eventos publicados con FSM_Post(), un solo contexto productor
+    struct CYCLIC_SPSC events;
+    uint8_t         eventData       [FSM_EVENT_QUEUE_SIZE];
+    uint32_t        eventsLost;
+    // Llamado al publicar un evento, por ej. para despertar la tarea que
+    // llama a FSM_Process()
+    FSM_PostHookFunc postHook;
+    void            *postHookCtx;
+    struct SWTIMER  timeout;
+    bool            timeoutFired;
 };
 
 
@@ -89,3 +164,11 @@ bool        FSM_GotoStage      (struct FEM *f, enum FSM_Stage newStage);
 bool        FSM_ChangeState    (struct FEM *f, FSM_StateFunc newState);
 bool        FSM_Process        (struct FEM *f, uint32_t curTicks,
                                 uint32_t timeoutTicks);
+bool        FSM_InitTable      (struct FEM *f, const struct FSM_Table *table,
+                                uint8_t initialState, void *app);
+bool        FSM_Dispatch       (struct FEM *f, uint8_t event);
+bool        FSM_Post           (struct FEM *f, uint8_t event);
+bool        FSM_Pending        (struct FEM *f);
+bool        FSM_SetPostHook    (struct FEM *f, FSM_PostHookFunc func,
+                                void *ctx);
+bool        FSM_Handles        (struct FEM *f, uint8_t event);
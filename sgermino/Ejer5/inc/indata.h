@@ -37,6 +37,11 @@
     #define INDATA_BUFFER_SIZE      32
 #endif
 
+// Eco acumulado por llamada a INDATA_Prompt()
+#ifndef INDATA_ECHO_SIZE
+    #define INDATA_ECHO_SIZE        64
+#endif
+
 
 enum INDATA_Status
 {
@@ -47,6 +52,14 @@ enum INDATA_Status
 };
 
 
+enum INDATA_Escape
+{
+    INDATA_EscapeNone = 0,
+    INDATA_EscapeStart,
+    INDATA_EscapeCsi
+};
+
+
 enum INDATA_Type
 {
     INDATA_TypeDecimal = 0,
@@ -61,7 +74,11 @@ struct INDATA
     enum INDATA_Type    type;
     struct UART         *uart;
     struct ARRAY        a;
-    uint8_t             data [INDATA_BUFFER_SIZE];
+    // Posicion de edicion en bytes, siempre al comienzo de un caracter
+    uint32_t            cursor;
+    uint8_t             utf8Pending;
+    enum INDATA_Escape  escape;
+    uint32_t            escapeParam;
 };
 
 
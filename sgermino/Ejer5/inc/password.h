@@ -0,0 +1,66 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+#include "array.h"
+#include "sha256.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+
+// Guarda el hash con sal de un password, nunca el password. El registro
+// persiste en una pagina de la EEPROM interna del LPC43xx.
+#ifndef PASSWORD_EEPROM_PAGE
+    #define PASSWORD_EEPROM_PAGE    0
+#endif
+
+#define PASSWORD_SALT_SIZE          16
+
+// Iteraciones de SHA-256 por verificacion: costo fijo que acota la
+// velocidad de un ataque por fuerza bruta
+#ifndef PASSWORD_HASH_ROUNDS
+    #define PASSWORD_HASH_ROUNDS    64
+#endif
+
+// Largo maximo de password con el que el hash sigue ocupando un solo bloque
+// de SHA-256 y la verificacion tarda siempre lo mismo
+#define PASSWORD_MAX_SIZE           (SHA256_BLOCK_SIZE - 9 - PASSWORD_SALT_SIZE)
+
+
+struct PASSWORD
+{
+    uint8_t     salt    [PASSWORD_SALT_SIZE];
+    uint8_t     hash    [SHA256_DIGEST_SIZE];
+};
+
+
+bool        PASSWORD_Load           (struct PASSWORD *p);
+bool        PASSWORD_Set            (struct PASSWORD *p, struct ARRAY *plain);
+bool        PASSWORD_Check          (struct PASSWORD *p, struct ARRAY *plain);
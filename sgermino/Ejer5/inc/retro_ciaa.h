@@ -36,11 +36,18 @@
 
 #include "array"
 #include "btn.h"
+#include "coro.h"
 #include "cyclic.h"
+#include "cyclic_spsc.h"
+#include "fmt.h"
 #include "fsm.h"
 #include "indata.h"
+#include "password.h"
+#include "sha256.h"
 #include "stream.h"
+#include "swtimer.h"
 #include "systick.h"
+#include "template.h"
 #include "text.h"
 #include "uart.h"
 #include "variant.h"
@@ -0,0 +1,62 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+
+// Servicio de timers por software: una lista ordenada por vencimiento que
+// SWTIMER_Process() recorre desde el principio, por lo que solo revisa los
+// timers vencidos. Las comparaciones son relativas (resta con signo), validas
+// a traves del desborde del contador de ticks para plazos menores a 2^31.
+// Se usa desde un unico contexto (tareas, no interrupciones).
+
+typedef void (* SWTIMER_Func) (void *ctx);
+
+
+struct SWTIMER
+{
+    struct SWTIMER  *next;
+    uint32_t        deadline;
+    SWTIMER_Func    func;
+    void            *ctx;
+    bool            active;
+};
+
+
+bool        SWTIMER_Init            (struct SWTIMER *t, SWTIMER_Func func,
+                                     void *ctx);
+bool        SWTIMER_Start           (struct SWTIMER *t, uint32_t now,
+                                     uint32_t ticks);
+bool        SWTIMER_Stop            (struct SWTIMER *t);
+bool        SWTIMER_Active          (struct SWTIMER *t);
+uint32_t    SWTIMER_Process         (uint32_t now);
+bool        SWTIMER_TicksToNext     (uint32_t now, uint32_t *ticks);
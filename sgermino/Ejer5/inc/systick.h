@@ -39,4 +39,6 @@ void                SYSTICK_SetMicrosecondPeriod    (uint32_t micro);
 void                SYSTICK_SetMillisecondPeriod    (uint32_t milli);
 uint32_t            SYSTICK_GetTickRateMicroseconds ();
 uint32_t            SYSTICK_Now                     ();
+uint32_t            SYSTICK_MaxSleepTicks           ();
+void                SYSTICK_Sleep                   (uint32_t ticks);
 SYSTICK_HookFunc    SYSTICK_SetHook                 (SYSTICK_HookFunc func);
@@ -0,0 +1,77 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+
+// Partes por template: un literal seguido (opcionalmente) de un argumento.
+// Un template con N comodines necesita al menos N + 1 partes.
+#ifndef TEMPLATE_MAX_PARTS
+    #define TEMPLATE_MAX_PARTS      12
+#endif
+
+// Valores especiales de TEMPLATE_Part.arg
+#define TEMPLATE_ARG_NONE           0xFF
+#define TEMPLATE_ARG_INVALID        0xFE
+
+
+struct TEMPLATE_Part
+{
+    // Literal: msg[offset] ... msg[offset + size - 1]
+    uint16_t    offset;
+    uint16_t    size;
+    // Indice de argumento (0 = %1) a sustituir a continuacion del literal
+    uint8_t     arg;
+};
+
+
+// Template ya separado en partes. text es la direccion de la variable TEXT_*
+// que apunta al mensaje: la direccion es constante en tiempo de compilacion
+// y el mensaje no, asi la tabla queda en flash.
+struct TEMPLATE
+{
+    const char                  **text;
+    const struct TEMPLATE_Part  *parts;
+    uint32_t                    partCount;
+};
+
+
+// Tabla generada en text_templates.c a partir de los textos (ver
+// test/gen_templates.c), un template por mensaje con comodines
+extern const struct TEMPLATE    TEMPLATE_Table[];
+extern const uint32_t           TEMPLATE_TableCount;
+
+
+uint32_t                TEMPLATE_Compile    (const char *msg,
+                                             struct TEMPLATE_Part *parts,
+                                             uint32_t maxParts);
+const struct TEMPLATE * TEMPLATE_Find       (const char *msg);
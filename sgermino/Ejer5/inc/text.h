@@ -41,6 +41,12 @@ extern const char *TEXT_FSM_STATSBEGIN;
 extern const char *TEXT_FSM_STATS1;
 extern const char *TEXT_FSM_STATS2;
 extern const char *TEXT_FSM_STATSEND;
+extern const char *TEXT_SCHEDULER_STATSBEGIN;
+extern const char *TEXT_SCHEDULER_STATS1;
+extern const char *TEXT_SCHEDULER_STATS2;
+extern const char *TEXT_SCHEDULER_STATS3;
+extern const char *TEXT_SCHEDULER_STATS4;
+extern const char *TEXT_SCHEDULER_STATSEND;
 extern const char *TEXT_INDATA_TOOLONG;
 extern const char *TEXT_INDATA_VALIDATING;
 extern const char *TEXT_INDATA_WRONGTYPEINT;
@@ -30,6 +30,7 @@
 */
 #pragma once
 #include "cyclic.h"
+#include "variant.h"
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -48,26 +49,55 @@
 #endif
 
 
+enum UART_Mode
+{
+    // UART_Recv() y UART_Send() mueven los datos entre FIFO y buffers
+    UART_ModePolled = 0,
+    // Las interrupciones de RX/THRE llenan y vacian los buffers
+    UART_ModeInterrupt,
+    // Recepcion por interrupcion, transmision por DMA en bloques contiguos
+    UART_ModeDma
+};
+
+
+// Llamada con datos nuevos en el buffer de recepcion, puede ser desde una ISR
+typedef void (* UART_RecvHookFunc) (void *ctx);
+
+
 struct UART
 {
-    struct CYCLIC   recv;
-    struct CYCLIC   send;
-    uint8_t         recvData[UART_RECV_BUFFER_SIZE];
-    uint8_t         sendData[UART_SEND_BUFFER_SIZE];
+    struct CYCLIC       recv;
+    struct CYCLIC       send;
+    uint8_t             recvData[UART_RECV_BUFFER_SIZE];
+    uint8_t             sendData[UART_SEND_BUFFER_SIZE];
+    enum UART_Mode      mode;
+    // Overruns de la FIFO de hardware detectados en modo interrupcion
+    volatile uint32_t   recvOverruns;
+    UART_RecvHookFunc   recvHook;
+    void                *recvHookCtx;
     // Platform dependant UART handler
-    void            *handler;
+    void                *handler;
 };
 
 
 bool        UART_Init               (struct UART *u, void *handler,
                                      uint32_t baudRate);
+bool        UART_SetMode            (struct UART *u, enum UART_Mode mode);
+void        UART_SetRecvHook        (struct UART *u, UART_RecvHookFunc func,
+                                     void *ctx);
 uint32_t    UART_SendPendingCount   (struct UART *u);
+uint32_t    UART_SendFree           (struct UART *u);
 uint32_t    UART_RecvPendingCount   (struct UART *u);
 bool        UART_PutBinary          (struct UART *u,
                                      const uint8_t *data, uint32_t size);
 bool        UART_PutMessage         (struct UART *u, const char *msg);
+bool        UART_PutVariant         (struct UART *u, struct VARIANT *v);
 uint32_t    UART_Send               (struct UART *u);
 uint32_t    UART_Recv               (struct UART *u);
 bool        UART_RecvInjectByte     (struct UART *u, uint8_t byte);
 uint8_t     UART_RecvPeek           (struct UART *u, uint32_t offset);
+const uint8_t *
+            UART_RecvPeekSpan       (struct UART *u, uint32_t offset,
+                                     uint32_t *size);
+bool        UART_RecvDiscard        (struct UART *u, uint32_t count);
 bool        UART_RecvDiscardPending (struct UART *u);
@@ -36,6 +36,11 @@
 
 
 bool        UART_Config     (struct UART *ctx, uint32_t baudRate);
+bool        UART_ConfigMode (struct UART *ctx, enum UART_Mode mode);
+// Bloquea/desbloquea la interrupcion de la UART (modo interrupcion)
+void        UART_IntLock    (struct UART *ctx, bool lock);
+// Inicia la transmision por interrupcion, devuelve bytes puestos en la FIFO
+uint32_t    UART_SendStart  (struct UART *ctx);
 // Get and Put conform to STREAM_ByteIn/Out prototypes
 uint32_t    UART_GetByte    (void *handler);
 bool        UART_PutByte    (void *handler, uint8_t byte);
@@ -33,6 +33,12 @@
 #include <stdbool.h>
 
 
+// Buffer que alcanza para cualquier variant formateado, terminador incluido
+// (el peor caso es un float de 39 digitos enteros, signo y 6 decimales).
+// Los strings no se formatean: se usan tal cual.
+#define VARIANT_FORMAT_SIZE     48
+
+
 enum VARIANT_Type
 {
     VARIANT_TypeUint32 = 0,
@@ -43,10 +49,11 @@ enum VARIANT_Type
 };
 
 
+// Tipo + valor: 8 bytes en el target. El texto se genera recien al
+// escribirlo, ver VARIANT_Format() y UART_PutVariant().
 struct VARIANT
 {
     enum VARIANT_Type   type;
-    char                conv[16];
     union
     {
         uint32_t    u;
@@ -66,6 +73,7 @@ void        VARIANT_SetString       (struct VARIANT *v, const char *s);
 uint32_t    VARIANT_ToUint32        (struct VARIANT *v);
 int32_t     VARIANT_ToInt32         (struct VARIANT *v);
 float       VARIANT_ToFloat         (struct VARIANT *v);
-const char* VARIANT_ToString        (struct VARIANT *v);
+uint32_t    VARIANT_Format          (struct VARIANT *v, char *dst,
+                                     uint32_t size);
 bool        VARIANT_CmpStrings      (struct VARIANT *v, struct VARIANT *s);
 bool        VARIANT_CmpUint32s      (struct VARIANT *v, struct VARIANT *s);
@@ -0,0 +1,133 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "alarm.h"
+#include <stddef.h>
+
+
+// Password: estados que atienden el ingreso de password.
+// Activa: estados en los que el password desarma la alarma.
+static const struct FSM_TableState AlarmStates[APP_State_COUNT] =
+{
+    [APP_StatePassword]     = { "Password", NULL, NULL, 0, APP_StateNone },
+    [APP_StateActiva]       = { "Activa", NULL, NULL, 0, APP_StatePassword },
+    [APP_StateDesarmada]    = { "Desarmada",
+                                FEMState_DesarmadaEntry, NULL, 0,
+                                APP_StatePassword },
+    [APP_StateDiegoArmando] = { "DiegoArmando",
+                                FEMState_DiegoArmandoEntry, NULL,
+                                ARMING_PERIOD_MSEC, APP_StateNone },
+    [APP_StateArmada]       = { "Armada",
+                                FEMState_ArmadaEntry, FEMState_ArmadaExit, 0,
+                                APP_StateActiva },
+    [APP_StateIntruso]      = { "Intruso",
+                                FEMState_IntrusoEntry, NULL, 0,
+                                APP_StateActiva },
+    [APP_StateDesarmando]   = { "Desarmando",
+                                FEMState_DesarmandoEntry, NULL,
+                                DOOR_DISARMING_MSEC, APP_StateActiva },
+};
+
+
+// AskAgain sale y vuelve a entrar al estado actual, igual que volver al
+// StageBegin.
+static const struct FSM_Transition AlarmTransitions
+                                        [APP_State_COUNT][APP_Event_COUNT] =
+{
+    [APP_StatePassword] =
+    {
+        [APP_EventPasswordAsking]   = { 0, NULL, FEMState_PasswordAsking },
+        [APP_EventPasswordAskAgain] = { FSM_StateSelf, NULL, NULL },
+    },
+    [APP_StateActiva] =
+    {
+        [APP_EventPasswordMatch]    = { APP_StateDesarmada, NULL, NULL },
+    },
+    [APP_StateDesarmada] =
+    {
+        [APP_EventPasswordMatch]    = { APP_StateDiegoArmando, NULL, NULL },
+    },
+    [APP_StateDiegoArmando] =
+    {
+        [FSM_EventTimeout]          = { APP_StateArmada, NULL,
+                                        FEMState_DiegoArmandoTimeout },
+        [APP_EventCancel]           = { APP_StateDesarmada, NULL,
+                                        FEMState_DiegoArmandoCancel },
+    },
+    [APP_StateArmada] =
+    {
+        [APP_EventSensorWindow]     = { APP_StateIntruso, NULL,
+                                        FEMState_ArmadaSensorWindow },
+        [APP_EventSensorDoor]       = { APP_StateDesarmando, NULL,
+                                        FEMState_ArmadaSensorDoor },
+    },
+    [APP_StateDesarmando] =
+    {
+        [FSM_EventTimeout]          = { APP_StateIntruso, NULL, NULL },
+        [APP_EventPasswordAskAgain] = { 0, NULL, FEMState_DesarmandoAskAgain },
+        [APP_EventPasswordMatch]    = { APP_StateDiegoArmando, NULL, NULL },
+        [APP_EventRetriesExhausted] = { APP_StateIntruso, NULL, NULL },
+    },
+};
+
+
+// Ancestro comun de cada par [origen][destino] segun los padres de
+// AlarmStates, en flash. FSM_InitTable() lo compara con los padres y
+// rechaza la tabla si no coincide.
+#define N   APP_StateNone
+#define P   APP_StatePassword
+#define A   APP_StateActiva
+
+static const uint8_t AlarmLca [APP_State_COUNT][APP_State_COUNT] =
+{
+    //                        -  Pw Ac De DA Ar In Dn
+    [APP_StateNone]         = { N, N, N, N, N, N, N, N },
+    [APP_StatePassword]     = { N, N, N, N, N, N, N, N },
+    [APP_StateActiva]       = { N, N, P, P, N, P, P, P },
+    [APP_StateDesarmada]    = { N, N, P, P, N, P, P, P },
+    [APP_StateDiegoArmando] = { N, N, N, N, N, N, N, N },
+    [APP_StateArmada]       = { N, N, P, P, N, A, A, A },
+    [APP_StateIntruso]      = { N, N, P, P, N, A, A, A },
+    [APP_StateDesarmando]   = { N, N, P, P, N, A, A, A },
+};
+
+#undef N
+#undef P
+#undef A
+
+
+const struct FSM_Table AlarmTable =
+{
+    .states         = AlarmStates,
+    .transitions    = &AlarmTransitions[0][0],
+    .lca            = &AlarmLca[0][0],
+    .stateCount     = APP_State_COUNT,
+    .eventCount     = APP_Event_COUNT,
+};
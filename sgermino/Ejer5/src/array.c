@@ -31,9 +31,33 @@
 #include "array.h"
 #include "variant.h"
 #include <string.h>
+#ifdef __arm__
+    #include "chip.h"   // CMSIS
+#endif
+
+
+#if ARRAY_ARENA_SIZE
+static uint8_t  g_arena[ARRAY_ARENA_SIZE];
+static uint32_t g_arenaUsed = 0;
+#endif
+
+
+// Elementos que se pueden agregar sin pisar el terminador reservado
+static uint32_t usable (struct ARRAY *a)
+{
+    const uint32_t Reserved = (a->flags & ARRAY_FlagTerminator)? 1 : 0;
+    return (a->capacity > Reserved)? a->capacity - Reserved : 0;
+}
 
 
 bool ARRAY_Init (struct ARRAY *a, uint8_t *data, uint32_t capacity)
+{
+    return ARRAY_InitFlags (a, data, capacity, ARRAY_FlagTerminator);
+}
+
+
+bool ARRAY_InitFlags (struct ARRAY *a, uint8_t *data, uint32_t capacity,
+                      uint32_t flags)
 {
     if (!a)
     {
@@ -49,7 +73,58 @@ bool ARRAY_Init (struct ARRAY *a, uint8_t *data, uint32_t capacity)
 
     a->data     = data;
     a->capacity = capacity;
+    a->flags    = flags;
+    return true;
+}
+
+
+bool ARRAY_InitFromArena (struct ARRAY *a, uint32_t capacity, uint32_t flags)
+{
+#if ARRAY_ARENA_SIZE
+    if (!a || capacity > ARRAY_ARENA_SIZE - g_arenaUsed)
+    {
+        return false;
+    }
+
+    if (!ARRAY_InitFlags (a, &g_arena[g_arenaUsed], capacity, flags))
+    {
+        return false;
+    }
+
+    g_arenaUsed += capacity;
     return true;
+#else
+    return false;
+#endif
+}
+
+
+bool ARRAY_ReleaseToArena (struct ARRAY *a)
+{
+#if ARRAY_ARENA_SIZE
+    // Solo la ultima porcion tomada del arena vuelve a estar disponible
+    if (!a || !a->capacity ||
+        a->data + a->capacity != &g_arena[g_arenaUsed])
+    {
+        return false;
+    }
+
+    g_arenaUsed -= a->capacity;
+    memset (a, 0, sizeof(struct ARRAY));
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+uint32_t ARRAY_ArenaFree ()
+{
+#if ARRAY_ARENA_SIZE
+    return ARRAY_ARENA_SIZE - g_arenaUsed;
+#else
+    return 0;
+#endif
 }
 
 
@@ -68,15 +143,21 @@ uint32_t ARRAY_Elements (struct ARRAY *a)
 }
 
 
+uint32_t ARRAY_Free (struct ARRAY *a)
+{
+    return (a)? usable(a) - a->index : 0;
+}
+
+
 bool ARRAY_Full (struct ARRAY *a)
 {
-    return (a && a->index == a->capacity - 1);
+    return (a && a->index >= usable(a));
 }
 
 
 bool ARRAY_Append (struct ARRAY *a, uint8_t element)
 {
-    if (ARRAY_Full(a))
+    if (!a || ARRAY_Full(a))
     {
         return false;
     }
@@ -88,36 +169,26 @@ bool ARRAY_Append (struct ARRAY *a, uint8_t element)
 
 bool ARRAY_AppendString (struct ARRAY *a, const char *str)
 {
-    if (!a || !str)
+    if (!str)
     {
         return false;
     }
 
-    while (*str)
-    {
-        if (!ARRAY_Append (a, (uint8_t)*str ++))
-        {
-            return false;
-        }
-    }
-    return true;
+    const uint32_t Size = strlen (str);
+    return (!Size || ARRAY_AppendBinary (a, (const uint8_t *) str, Size));
 }
 
 
+// Agrega todo o nada
 bool ARRAY_AppendBinary (struct ARRAY *a, const uint8_t *data, uint32_t size)
 {
-    if (!a || !data || !size)
+    if (!a || !data || !size || size > ARRAY_Free(a))
     {
         return false;
     }
 
-    while (size --)
-    {
-        if (!ARRAY_Append (a, *data ++))
-        {
-            return false;
-        }
-    }
+    memcpy (&a->data[a->index], data, size);
+    a->index += size;
     return true;
 }
 
@@ -153,7 +224,7 @@ uint32_t ARRAY_RemoveChars (struct ARRAY *a, uint32_t count)
 
 bool ARRAY_Terminate (struct ARRAY *a)
 {
-    if (!a)
+    if (!a || a->index >= a->capacity)
     {
         return false;
     }
@@ -163,6 +234,99 @@ bool ARRAY_Terminate (struct ARRAY *a)
 }
 
 
+// Validacion de a 4 bytes por vez (SWAR) para texto US-ASCII. Cada funcion
+// recibe una palabra sin bytes >= 128 y retorna true si todos sus bytes
+// estan en el rango pedido.
+#define WORD_ONES       0x01010101u
+#define WORD_HIGH_BITS  0x80808080u
+
+#ifdef __arm__
+    // Cortex-M4: USUB8 deja en los flags GE los bytes >= al sustraendo y SEL
+    // elige por byte segun esos flags
+    static uint32_t wordInRange (uint32_t w, uint8_t lo, uint8_t hi)
+    {
+        __USUB8 (w, WORD_ONES * lo);
+        const uint32_t GeLo = __SEL (0xFFFFFFFF, 0);
+        __USUB8 (WORD_ONES * hi, w);
+        return __SEL (GeLo, 0);
+    }
+
+    #define WORD_IN_RANGE_ALL   0xFFFFFFFFu
+
+    static bool wordDecimal (uint32_t w)
+    {
+        return !(__UQSUB8 (w, WORD_ONES * '9') |
+                 __UQSUB8 (WORD_ONES * '0', w));
+    }
+#else
+    // Sumando por byte 0x80 - lo se enciende el bit alto de los bytes >= lo;
+    // sin acarreo entre bytes porque son menores a 128.
+    static uint32_t wordInRange (uint32_t w, uint8_t lo, uint8_t hi)
+    {
+        return (w + WORD_ONES * (0x80 - lo)) &
+              ~(w + WORD_ONES * (0x7F - hi)) & WORD_HIGH_BITS;
+    }
+
+    #define WORD_IN_RANGE_ALL   WORD_HIGH_BITS
+
+    static bool wordDecimal (uint32_t w)
+    {
+        return (wordInRange (w, '0', '9') == WORD_IN_RANGE_ALL);
+    }
+#endif
+
+
+static bool wordAlnum (uint32_t w)
+{
+    // 0x20 pasa las mayusculas a minusculas sin sumar otros caracteres al
+    // rango 'a' - 'z'
+    return ((wordInRange (w, '0', '9') |
+             wordInRange (w | (WORD_ONES * 0x20), 'a', 'z')) ==
+            WORD_IN_RANGE_ALL);
+}
+
+
+static uint32_t loadWord (const uint8_t *data)
+{
+    uint32_t w;
+    memcpy (&w, data, sizeof(w));
+    return w;
+}
+
+
+// Valida el caracter en data, retorna sus bytes o 0 si no es alfanumerico
+static uint32_t alnumChar (const uint8_t *data, uint32_t size)
+{
+    // Basic Latin
+    if (data[0] < 128)
+    {
+        if ((data[0] >= '0' && data[0] <= '9') ||
+            (data[0] >= 'A' && data[0] <= 'Z') ||
+            (data[0] >= 'a' && data[0] <= 'z'))
+        {
+            return 1;
+        }
+    }
+    else if (size > 1 &&
+             ((data[0] & 0b11100000) == 0b11000000) &&
+             ((data[1] & 0b11000000) == 0b10000000))
+    {
+        const uint16_t Code = (data[0] & 0b00011111) << 6 |
+                              (data[1] & 0b00111111);
+        // Latin-1 Supplement
+        if ((Code >= 0x00C0 && Code <= 0x00D6) ||
+            (Code >= 0x00D8 && Code <= 0x00F6) ||
+            (Code >= 0x00F8 && Code <= 0x00FF) ||
+            // Latin Extended-A
+            (Code >= 0x0100 && Code <= 0x017F))
+        {
+            return 2;
+        }
+    }
+    return 0;
+}
+
+
 bool ARRAY_CheckAlnumChars (struct ARRAY *a)
 {
     if (!a)
@@ -170,36 +334,32 @@ bool ARRAY_CheckAlnumChars (struct ARRAY *a)
         return false;
     }
 
-    for (uint32_t i = 0; i < a->index; ++ i)
+    uint32_t i = 0;
+    while (i < a->index)
     {
-        // Basic Latin
-        if (a->data[i] < 128)
+        // De a 4 bytes mientras sean US-ASCII
+        if (i + sizeof(uint32_t) <= a->index)
         {
-            if ((a->data[i] >= '0' && a->data[i] <= '9') ||
-                (a->data[i] >= 'A' && a->data[i] <= 'Z') ||
-                (a->data[i] >= 'a' && a->data[i] <= 'z'))
+            const uint32_t W = loadWord (&a->data[i]);
+            if (!(W & WORD_HIGH_BITS))
             {
+                if (!wordAlnum (W))
+                {
+                    return false;
+                }
+
+                i += sizeof(uint32_t);
                 continue;
             }
         }
-        else if (i + 1 < a->index &&
-                 ((a->data[i + 0] & 0b11100000) == 0b11000000) &&
-                 ((a->data[i + 1] & 0b11000000) == 0b10000000))
+
+        const uint32_t Size = alnumChar (&a->data[i], a->index - i);
+        if (!Size)
         {
-            const uint16_t Code = (a->data[i + 0] & 0b00011111) << 6 |
-                                  (a->data[i + 1] & 0b00111111);
-            // Latin-1 Supplement
-            if ((Code >= 0x00C0 && Code <= 0x00D6) ||
-                (Code >= 0x00D8 && Code <= 0x00F6) ||
-                (Code >= 0x00F8 && Code <= 0x00FF) ||
-                // Latin Extended-A
-                (Code >= 0x0100 && Code <= 0x017F))
-            {
-                ++ i;
-                continue;
-            }
+            return false;
         }
-        return false;
+
+        i += Size;
     }
 
     return true;
@@ -213,7 +373,17 @@ bool ARRAY_CheckDecimalChars (struct ARRAY *a)
         return false;
     }
 
-    for (uint32_t i = 0; i < a->index; ++ i)
+    uint32_t i = 0;
+    for (; i + sizeof(uint32_t) <= a->index; i += sizeof(uint32_t))
+    {
+        const uint32_t W = loadWord (&a->data[i]);
+        if ((W & WORD_HIGH_BITS) || !wordDecimal (W))
+        {
+            return false;
+        }
+    }
+
+    for (; i < a->index; ++ i)
     {
         if (a->data[i] < '0' || a->data[i] > '9')
         {
@@ -236,9 +406,32 @@ bool ARRAY_CheckEqualContents (struct ARRAY *a, struct ARRAY *b)
 }
 
 
+// Para secretos: el tiempo depende solo de a->index, no de en que posicion
+// difieren los contenidos ni del largo de b
+bool ARRAY_CheckEqualContentsConstTime (struct ARRAY *a, struct ARRAY *b)
+{
+    if (!a || !b)
+    {
+        return false;
+    }
+
+    uint32_t diff = a->index ^ b->index;
+
+    for (uint32_t i = 0; i < a->index; ++ i)
+    {
+        // Mascara en lugar de salto: lee b->data[0] fuera del largo de b
+        const uint32_t InB  = (uint32_t)0 - (uint32_t)(i < b->index);
+        const uint8_t  Byte = b->data[i & InB];
+        diff |= (a->data[i] ^ Byte) & InB;
+    }
+
+    return (diff == 0);
+}
+
+
 bool ARRAY_Copy (struct ARRAY *a, struct ARRAY *b)
 {
-    if (!a || !b || !b->capacity || a->index >= b->capacity - 1)
+    if (!a || !b || a->index > usable(b))
     {
         return false;
     }
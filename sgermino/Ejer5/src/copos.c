@@ -34,9 +34,16 @@
  */
 #include "copos.h"
 #include "systick.h"
-#include "chip.h"   // CMSIS
 #include <string.h>
 
+// Host builds (test/) leave out the CMSIS core: no critical sections, no WFI
+// and clock_gettime() as the profiler clock.
+#ifdef __arm__
+    #include "chip.h"   // CMSIS
+#elif SCHEDULER_PROFILE
+    #include <time.h>
+#endif
+
 
 // Keeps track of time since last error was recorded (see below)
 //static int32_t errorTickCount;
@@ -51,6 +58,224 @@ sTask_t schedulerTasks[SCHEDULER_MAX_TASKS];
 // Used to display the error code
 char errorCode = 0;
 
+// Order in which due tasks are run
+static eDispatchPolicy_t dispatchPolicy = SCHEDULER_DISPATCH_SLOT_ORDER;
+
+// schedulerAddTask() picks the delay of periodic tasks
+static bool autoOffset = false;
+
+// Task being run by schedulerRunTask(), SCHEDULER_MAX_TASKS if none
+static volatile uint32_t runningTask = SCHEDULER_MAX_TASKS;
+
+// Software timer service, see schedulerSetTimerService()
+static uint32_t (* timerProcess)(uint32_t now) = NULL;
+static bool (* timerTicksToNext)(uint32_t now, uint32_t *ticks) = NULL;
+
+#if SCHEDULER_PROFILE
+// Execution statistics of each task
+static sTaskProfile_t schedulerProfile[SCHEDULER_MAX_TASKS];
+#endif
+
+
+static uint32_t enterCritical (void)
+{
+#ifdef __arm__
+    const uint32_t Primask = __get_PRIMASK ();
+    __disable_irq ();
+    return Primask;
+#else
+    return 0;
+#endif
+}
+
+
+static void exitCritical (uint32_t primask)
+{
+#ifdef __arm__
+    __set_PRIMASK (primask);
+#else
+    (void) primask;
+#endif
+}
+
+
+#if SCHEDULER_PROFILE
+static void profileClockInit (void)
+{
+#ifdef __arm__
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+
+static uint32_t profileClock (void)
+{
+#ifdef __arm__
+    return DWT->CYCCNT;
+#else
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (uint32_t)ts.tv_sec * 1000000000u + (uint32_t)ts.tv_nsec;
+#endif
+}
+
+
+static void profileTaskReset (uint32_t taskIndex)
+{
+    sTaskProfile_t* p = &schedulerProfile[taskIndex];
+    memset (p, 0, sizeof(sTaskProfile_t));
+    p->cyclesMin  = UINT32_MAX;
+    p->latencyMin = UINT32_MAX;
+}
+
+
+static void profileRelease (uint32_t taskIndex)
+{
+    schedulerProfile[taskIndex].released = profileClock ();
+}
+
+
+static void profileRun (uint32_t taskIndex, int32_t backlog, uint32_t latency,
+                        uint32_t cycles)
+{
+    sTaskProfile_t* p = &schedulerProfile[taskIndex];
+
+    ++ p->runs;
+    p->cyclesTotal += cycles;
+
+    if (cycles < p->cyclesMin)
+    {
+        p->cyclesMin = cycles;
+    }
+    if (cycles > p->cyclesMax)
+    {
+        p->cyclesMax = cycles;
+    }
+    if (latency < p->latencyMin)
+    {
+        p->latencyMin = latency;
+    }
+    if (latency > p->latencyMax)
+    {
+        p->latencyMax = latency;
+    }
+    if (backlog > p->backlogMax)
+    {
+        p->backlogMax = backlog;
+    }
+
+    // Released again before this run was over
+    if (schedulerTasks[taskIndex].runMe > 0)
+    {
+        ++ p->missedDeadlines;
+    }
+}
+
+
+const sTaskProfile_t* schedulerGetTaskProfile (uint32_t taskIndex)
+{
+    if (taskIndex >= SCHEDULER_MAX_TASKS || !schedulerTasks[taskIndex].pTask)
+    {
+        return 0;
+    }
+
+    return &schedulerProfile[taskIndex];
+}
+
+
+// Profiler clock cycles per second
+uint32_t schedulerProfileRate (void)
+{
+#ifdef __arm__
+    return SystemCoreClock;
+#else
+    return 1000000000u;
+#endif
+}
+
+
+void schedulerResetProfile (void)
+{
+    for (uint32_t i = 0; i < SCHEDULER_MAX_TASKS; ++i)
+    {
+        profileTaskReset (i);
+    }
+}
+#endif
+
+
+#if SCHEDULER_TIMER_WHEEL
+
+#if (SCHEDULER_WHEEL_SLOTS & (SCHEDULER_WHEEL_SLOTS - 1)) || \
+    SCHEDULER_WHEEL_SLOTS > 256
+    #error SCHEDULER_WHEEL_SLOTS must be a power of two up to 256
+#endif
+
+#if SCHEDULER_MAX_TASKS > 32
+    #error The timer wheel backend supports up to 32 tasks
+#endif
+
+#define WHEEL_MASK      (SCHEDULER_WHEEL_SLOTS - 1)
+
+// First task (index + 1) linked into each wheel slot, 0 if empty
+static uint8_t wheelSlots[SCHEDULER_WHEEL_SLOTS];
+
+// Ticks elapsed since the scheduler was initialized
+static uint32_t wheelTick;
+
+// One bit per task with runMe > 0
+static volatile uint32_t readyTasks;
+
+
+/*
+    Links a task into the wheel slot visited 'ticks' ticks from now (at least
+    one). Must be called from the scheduler ISR or with interrupts disabled.
+*/
+static void wheelInsert (uint32_t taskIndex, uint32_t ticks)
+{
+    if (!ticks)
+    {
+        ticks = 1;
+    }
+
+    sTask_t* t = &schedulerTasks[taskIndex];
+    t->slot     = (wheelTick + ticks) & WHEEL_MASK;
+    t->rounds   = (ticks - 1) / SCHEDULER_WHEEL_SLOTS;
+    t->next     = wheelSlots[t->slot];
+    wheelSlots[t->slot] = taskIndex + 1;
+}
+
+
+// Ticks until the task is due, as left by wheelInsert()
+static uint32_t wheelTicksLeft (const sTask_t* t)
+{
+    return ((t->slot - wheelTick - 1) & WHEEL_MASK) + 1
+                + t->rounds * SCHEDULER_WHEEL_SLOTS;
+}
+
+
+/*
+    Unlinks a task from its wheel slot. Does nothing if the task is not
+    linked (one shot tasks are unlinked when they become due).
+*/
+static void wheelRemove (uint32_t taskIndex)
+{
+    uint8_t *link = &wheelSlots[schedulerTasks[taskIndex].slot];
+    while (*link)
+    {
+        if (*link == taskIndex + 1)
+        {
+            *link = schedulerTasks[taskIndex].next;
+            return;
+        }
+        link = &schedulerTasks[*link - 1].next;
+    }
+}
+
+#endif
+
 
 /*
     Scheduler initialization function. Prepares scheduler data structures.
@@ -58,6 +283,16 @@ char errorCode = 0;
 */
 void schedulerInit (void)
 {
+#if SCHEDULER_TIMER_WHEEL
+    memset (wheelSlots, 0, sizeof(wheelSlots));
+    wheelTick   = 0;
+    readyTasks  = 0;
+#endif
+#if SCHEDULER_PROFILE
+    profileClockInit ();
+    schedulerResetProfile ();
+#endif
+
     for (uint32_t i = 0; i < SCHEDULER_MAX_TASKS; ++i)
     {
         schedulerDeleteTask (i);
@@ -70,10 +305,85 @@ void schedulerInit (void)
 }
 
 
+// Ticks from release to deadline
+static uint32_t relativeDeadline (const sTask_t* t)
+{
+    if (t->deadline)
+    {
+        return t->deadline;
+    }
+
+    // Implicit deadline: the next release, or far away for one shot tasks
+    return (t->period)? t->period : INT32_MAX;
+}
+
+
+/*
+    Marks a task as due to run. Called from the scheduler ISR.
+*/
+static void schedulerRelease (uint32_t taskIndex, uint32_t ticks)
+{
+    sTask_t* t = &schedulerTasks[taskIndex];
+
+    // Deadline of the oldest pending run, see schedulerRunTask()
+    if (++ t->runMe == 1)
+    {
+        t->deadlineTicks = ticks + relativeDeadline (t);
+    }
+
+#if SCHEDULER_TIMER_WHEEL
+    readyTasks |= 1u << taskIndex;
+#endif
+#if SCHEDULER_PROFILE
+    profileRelease (taskIndex);
+#endif
+}
+
+
 /*
     This is the scheduler ISR. It is called at a rate determined by the timer
     settings in the 'init' function.
 */
+#if SCHEDULER_TIMER_WHEEL
+void schedulerUpdate (uint32_t ticks)
+{
+    // NOTE: calculations are in *TICKS* (not milliseconds)
+    // Only the tasks linked into the current slot are visited
+    uint8_t *link = &wheelSlots[++ wheelTick & WHEEL_MASK];
+    uint32_t periodic = 0;
+
+    while (*link)
+    {
+        const uint32_t i = *link - 1;
+        sTask_t* t = &schedulerTasks[i];
+
+        if (t->rounds)
+        {
+            // Due in a later revolution of the wheel
+            -- t->rounds;
+            link = &t->next;
+            continue;
+        }
+
+        // The task is due to run
+        *link = t->next;
+        schedulerRelease (i, ticks);
+        if (t->period)
+        {
+            periodic |= 1u << i;
+        }
+    }
+
+    // Schedule regular tasks to run again. Deferred until the slot was
+    // walked, a period multiple of the wheel size maps to this same slot.
+    while (periodic)
+    {
+        const uint32_t i = __builtin_ctz (periodic);
+        periodic &= periodic - 1;
+        wheelInsert (i, schedulerTasks[i].period);
+    }
+}
+#else
 void schedulerUpdate (uint32_t ticks)
 {
     // NOTE: calculations are in *TICKS* (not milliseconds)
@@ -87,7 +397,7 @@ void schedulerUpdate (uint32_t ticks)
         }
 
         // The task is due to run
-        ++ t->runMe;
+        schedulerRelease (i, ticks);
         if (t->period)
         {
             // Schedule regular tasks to run again
@@ -95,6 +405,92 @@ void schedulerUpdate (uint32_t ticks)
         }
     }
 }
+#endif
+
+// Ticks until the next release of a task
+static uint32_t ticksToRelease (const sTask_t* t)
+{
+#if SCHEDULER_TIMER_WHEEL
+    return wheelTicksLeft (t);
+#else
+    return (t->delay > 0)? t->delay : 1;
+#endif
+}
+
+
+/*
+    Returns the number of ticks until the next release of a task, 0 if there
+    is no task at that position or it is a one shot task already released.
+*/
+uint32_t schedulerTicksToRelease (uint32_t taskIndex)
+{
+    if (taskIndex >= SCHEDULER_MAX_TASKS)
+    {
+        return 0;
+    }
+
+    const sTask_t* t = &schedulerTasks[taskIndex];
+    const uint32_t Primask = enterCritical ();
+    const uint32_t TicksLeft = (!t->pTask || (!t->period && t->runMe > 0))?
+                                    0 : ticksToRelease (t);
+    exitCritical (Primask);
+    return TicksLeft;
+}
+
+
+#if SCHEDULER_TICKLESS
+/*
+    Returns the number of ticks until the next task or software timer is
+    due, 0 if there is one ready to run. Must be called with interrupts
+    disabled.
+*/
+static uint32_t schedulerIdleTicks (void)
+{
+    uint32_t idle = UINT32_MAX;
+
+    for (uint32_t i = 0; i < SCHEDULER_MAX_TASKS; ++i)
+    {
+        const sTask_t* t = &schedulerTasks[i];
+        if (!t->pTask)
+        {
+            continue;
+        }
+
+        if (t->runMe > 0)
+        {
+            return 0;
+        }
+        const uint32_t TicksLeft = ticksToRelease (t);
+        if (TicksLeft < idle)
+        {
+            idle = TicksLeft;
+        }
+    }
+
+    // Wakes up for the next software timer too
+    uint32_t timerTicks;
+    if (timerTicksToNext && timerTicksToNext (SYSTICK_Now (), &timerTicks)
+            && timerTicks < idle)
+    {
+        idle = timerTicks;
+    }
+
+    return idle;
+}
+
+
+/*
+    Sleeps until the next task is due. Ticks skipped in between are accounted
+    for (SYSTICK_Now() and schedulerUpdate()) before returning.
+*/
+static void schedulerIdle (void)
+{
+    const uint32_t Primask = enterCritical ();
+    SYSTICK_Sleep (schedulerIdleTicks ());
+    exitCritical (Primask);
+}
+#endif
+
 
 /*
     Starts the scheduler, by enabling timer interrupts.
@@ -109,6 +505,145 @@ void schedulerStart (uint32_t tickRateMs)
 }
 
 
+/*
+    Runs a task that is due and updates its runMe counter.
+*/
+static void consumeRuns (uint32_t taskIndex, int32_t runs)
+{
+    sTask_t* t = &schedulerTasks[taskIndex];
+    const uint32_t Primask = enterCritical ();
+
+    // The task may have deleted itself
+    if (runs > t->runMe)
+    {
+        runs = t->runMe;
+    }
+
+    if (runs > 0)
+    {
+        t->runMe -= runs;
+        if (t->runMe > 0)
+        {
+            // Next pending run was released 'runs' periods later
+            t->deadlineTicks += runs * t->period;
+        }
+#if SCHEDULER_TIMER_WHEEL
+        else
+        {
+            readyTasks &= ~(1u << taskIndex);
+        }
+#endif
+    }
+
+    exitCritical (Primask);
+}
+
+
+static void schedulerRunTask (uint32_t taskIndex, uint32_t ticks)
+{
+    sTask_t* t = &schedulerTasks[taskIndex];
+    const int32_t Backlog = t->runMe;
+
+    if (Backlog > 1 && t->period)
+    {
+        // Released again before this run could start
+        ++ t->overruns;
+
+        if (t->overrunPolicy == SCHEDULER_OVERRUN_SKIP)
+        {
+            // Shed the late runs, wait for the next release
+            t->droppedRuns += Backlog;
+            consumeRuns (taskIndex, Backlog);
+            return;
+        }
+    }
+
+#if SCHEDULER_PROFILE
+    const uint32_t Start    = profileClock ();
+    const uint32_t Latency  = Start - schedulerProfile[taskIndex].released;
+#endif
+
+    // Run the task
+    runningTask = taskIndex;
+    t->pTask (t->context, ticks);
+    runningTask = SCHEDULER_MAX_TASKS;
+
+#if SCHEDULER_PROFILE
+    const uint32_t Cycles = profileClock () - Start;
+#endif
+
+    if (Backlog > 1 && t->overrunPolicy == SCHEDULER_OVERRUN_COALESCE)
+    {
+        // This run covers every release pending when it started
+        t->droppedRuns += Backlog - 1;
+        consumeRuns (taskIndex, Backlog);
+    }
+    else
+    {
+        consumeRuns (taskIndex, 1);
+    }
+
+#if SCHEDULER_PROFILE
+    profileRun (taskIndex, Backlog, Latency, Cycles);
+#endif
+
+    // Periodic tasks will automatically run again
+    // - if this is a 'one shot' task, remove it from the array
+    if (t->pTask && t->period == 0)
+    {
+        schedulerDeleteTask (taskIndex);
+    }
+}
+
+
+// True if due task 'a' should run before due task 'b'
+static bool runsBefore (const sTask_t* a, const sTask_t* b)
+{
+    if (dispatchPolicy == SCHEDULER_DISPATCH_EDF
+            && a->deadlineTicks != b->deadlineTicks)
+    {
+        return (int32_t)(a->deadlineTicks - b->deadlineTicks) < 0;
+    }
+
+    return a->priority > b->priority;
+}
+
+
+/*
+    Returns the index of the due task that should run next according to the
+    dispatch policy, SCHEDULER_MAX_TASKS if there is none. Ties are resolved
+    by position in the task array.
+*/
+static uint32_t schedulerNextTask (void)
+{
+    uint32_t next = SCHEDULER_MAX_TASKS;
+
+#if SCHEDULER_TIMER_WHEEL
+    uint32_t ready = readyTasks;
+    while (ready)
+    {
+        const uint32_t i = __builtin_ctz (ready);
+        ready &= ready - 1;
+#else
+    for (uint32_t i = 0; i < SCHEDULER_MAX_TASKS; ++i)
+    {
+#endif
+        if (schedulerTasks[i].runMe <= 0)
+        {
+            continue;
+        }
+
+        if (next == SCHEDULER_MAX_TASKS
+                || runsBefore (&schedulerTasks[i], &schedulerTasks[next]))
+        {
+            next = i;
+        }
+    }
+
+    return next;
+}
+
+
 /*
     This is the 'dispatcher' function. When a task (function)
     is due to run, schedulerDispatchTasks() will run it.
@@ -116,28 +651,56 @@ void schedulerStart (uint32_t tickRateMs)
 */
 void schedulerDispatchTasks (uint32_t ticks)
 {
-    // Dispatches (runs) the next task (if one is ready)
-    for (uint32_t i = 0; i < SCHEDULER_MAX_TASKS; ++i)
+    // Expired timers may signal tasks that run below
+    if (timerProcess)
     {
-        sTask_t* t = &schedulerTasks[i];
+        timerProcess (ticks);
+    }
 
-        if (t->runMe > 0)
+    if (dispatchPolicy != SCHEDULER_DISPATCH_SLOT_ORDER)
+    {
+        // Runs the most urgent task, then checks again: a task released
+        // meanwhile may be more urgent than the ones already due
+        uint32_t i;
+        while ((i = schedulerNextTask ()) < SCHEDULER_MAX_TASKS)
         {
-            // Run the task
-            t->pTask (t->context, ticks);
-            -- t->runMe;
+            schedulerRunTask (i, ticks);
+        }
+    }
+    else
+    {
+#if SCHEDULER_TIMER_WHEEL
+        // Dispatches (runs) only the tasks that are due
+        uint32_t ready = readyTasks;
+        while (ready)
+        {
+            const uint32_t i = __builtin_ctz (ready);
+            ready &= ready - 1;
 
-            // Periodic tasks will automatically run again
-            // - if this is a 'one shot' task, remove it from the array
-            if (t->period == 0)
+            // A previous task may have deleted this one
+            if (schedulerTasks[i].runMe > 0)
+            {
+                schedulerRunTask (i, ticks);
+            }
+        }
+#else
+        // Dispatches (runs) the next task (if one is ready)
+        for (uint32_t i = 0; i < SCHEDULER_MAX_TASKS; ++i)
+        {
+            if (schedulerTasks[i].runMe > 0)
             {
-                schedulerDeleteTask (i);
+                schedulerRunTask (i, ticks);
             }
         }
+#endif
     }
 
     schedulerReportStatus ();
+#if SCHEDULER_TICKLESS
+    schedulerIdle ();
+#elif defined(__arm__)
     __WFI ();
+#endif
 }
 
 
@@ -196,12 +759,33 @@ uint32_t schedulerAddTask (void (*pFunction)(void *ctx, uint32_t ticks),
         return SCHEDULER_MAX_TASKS;
     }
 
+    // Avoid releasing this task in the same ticks as the ones already added
+    if (autoOffset)
+    {
+        delay = schedulerBalancedDelay (delay, period);
+    }
+
     sTask_t* t = &schedulerTasks[i];
     t->pTask     = pFunction;
     t->context   = context;
     t->delay     = delay;
     t->period    = period;
     t->runMe     = 0;
+    t->priority  = 0;
+    t->deadline  = 0;
+    t->overrunPolicy = SCHEDULER_OVERRUN_CATCHUP;
+    t->overruns      = 0;
+    t->droppedRuns   = 0;
+
+#if SCHEDULER_PROFILE
+    profileTaskReset (i);
+#endif
+
+#if SCHEDULER_TIMER_WHEEL
+    const uint32_t Primask = enterCritical ();
+    wheelInsert (i, delay);
+    exitCritical (Primask);
+#endif
 
     return i;
 }
@@ -222,6 +806,142 @@ int8_t schedulerModifyTaskPeriod (uint32_t taskIndex, uint32_t newPeriod)
     schedulerTasks[taskIndex].period = newPeriod;
     return 0;
 }
+/*
+    Releases a task right away, without waiting for its next periodic
+    release, which is kept as a fallback. Safe to call from any ISR, for
+    example when data arrives. Signals to a task that is already due are
+    merged into the pending run. A task signaled while it runs gets one more
+    run: it may have checked its data before the signal.
+
+    RETURN VALUE: RETURN_ERROR or RETURN_NORMAL
+*/
+int8_t schedulerSignalTask (uint32_t taskIndex)
+{
+    if (taskIndex >= SCHEDULER_MAX_TASKS)
+    {
+        return -1;
+    }
+
+    int8_t returnCode = 0;
+    const uint32_t Primask = enterCritical ();
+
+    if (!schedulerTasks[taskIndex].pTask)
+    {
+        returnCode = -1;
+    }
+    // While running, the run being executed is still counted in runMe
+    else if (schedulerTasks[taskIndex].runMe
+                <= (taskIndex == runningTask))
+    {
+        schedulerRelease (taskIndex, SYSTICK_Now ());
+    }
+
+    exitCritical (Primask);
+    return returnCode;
+}
+
+
+/*
+    Sets the priority used by SCHEDULER_DISPATCH_PRIORITY (and to break ties
+    in SCHEDULER_DISPATCH_EDF). Higher values run first, tasks are added with
+    priority 0.
+*/
+int8_t schedulerSetTaskPriority (uint32_t taskIndex, uint8_t priority)
+{
+    if (taskIndex >= SCHEDULER_MAX_TASKS)
+    {
+        return -1;
+    }
+
+    if (!schedulerTasks[taskIndex].pTask)
+    {
+        return -1;
+    }
+
+    schedulerTasks[taskIndex].priority = priority;
+    return 0;
+}
+
+
+/*
+    Sets the relative deadline (ticks from each release) used by
+    SCHEDULER_DISPATCH_EDF. A deadline of 0 makes it equal to the period,
+    that is, a run must complete before the task is released again.
+*/
+int8_t schedulerSetTaskDeadline (uint32_t taskIndex, uint32_t deadline)
+{
+    if (taskIndex >= SCHEDULER_MAX_TASKS)
+    {
+        return -1;
+    }
+
+    if (!schedulerTasks[taskIndex].pTask)
+    {
+        return -1;
+    }
+
+    schedulerTasks[taskIndex].deadline = deadline;
+    return 0;
+}
+
+
+/*
+    Sets what happens when a periodic task is released again before its
+    previous run could start - see eOverrunPolicy_t.
+*/
+int8_t schedulerSetTaskOverrunPolicy (uint32_t taskIndex,
+                                      eOverrunPolicy_t policy)
+{
+    if (taskIndex >= SCHEDULER_MAX_TASKS)
+    {
+        return -1;
+    }
+
+    if (!schedulerTasks[taskIndex].pTask)
+    {
+        return -1;
+    }
+
+    schedulerTasks[taskIndex].overrunPolicy = policy;
+    return 0;
+}
+
+
+void schedulerSetDispatchPolicy (eDispatchPolicy_t policy)
+{
+    dispatchPolicy = policy;
+}
+
+
+/*
+    When enabled, schedulerAddTask() treats DELAY of periodic tasks as the
+    earliest first release and chooses, within one period from it, the delay
+    that minimizes the most tasks released in a single tick together with
+    the tasks already added - see schedulerBalancedDelay(). The search runs
+    inside schedulerAddTask(), bounded by SCHEDULER_ANALYSIS_MAX_CHECKS.
+*/
+void schedulerSetAutoOffset (bool enable)
+{
+    autoOffset = enable;
+}
+
+
+/*
+    Fires the expired timers of a software timer service (like
+    SWTIMER_Process() and SWTIMER_TicksToNext()) from schedulerDispatchTasks(),
+    before running the tasks that are due. With SCHEDULER_TICKLESS the idle
+    sleep also ends when the next timer is due, so the timers need no
+    periodic task polling them. NULL functions disable the service.
+*/
+void schedulerSetTimerService (uint32_t (* process)(uint32_t now),
+                               bool (* ticksToNext)(uint32_t now,
+                                                    uint32_t *ticks))
+{
+    timerProcess        = process;
+    timerTicksToNext    = ticksToNext;
+}
+
+
 /*
     Removes a task from the scheduler. Note that this does
     *not* delete the associated function from memory:
@@ -253,7 +973,15 @@ int8_t schedulerDeleteTask (uint32_t taskIndex)
         returnCode = 0; // RETURN_NORMAL;
     }
 
+#if SCHEDULER_TIMER_WHEEL
+    const uint32_t Primask = enterCritical ();
+    wheelRemove (taskIndex);
+    readyTasks &= ~(1u << taskIndex);
     memset (&schedulerTasks[taskIndex], 0, sizeof(sTask_t));
+    exitCritical (Primask);
+#else
+    memset (&schedulerTasks[taskIndex], 0, sizeof(sTask_t));
+#endif
     return returnCode; // return status
 }
 
@@ -0,0 +1,487 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "copos.h"
+#include "systick.h"
+#include <string.h>
+
+#ifdef __arm__
+    #include "chip.h"   // SystemCoreClock
+#endif
+
+
+extern sTask_t schedulerTasks[SCHEDULER_MAX_TASKS];
+
+
+static uint32_t gcd (uint32_t a, uint32_t b)
+{
+    while (b)
+    {
+        const uint32_t R = a % b;
+        a = b;
+        b = R;
+    }
+    return a;
+}
+
+
+// Tasks in 'set' released at tick 't', adding their WCET to 'cycles'
+static uint32_t releasedAt (const sAnalysisTask_t set[], uint32_t count,
+                            uint32_t t, uint32_t *cycles)
+{
+    uint32_t released = 0;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (t % set[i].period == set[i].phase)
+        {
+            ++ released;
+            if (cycles)
+            {
+                *cycles += set[i].wcet;
+            }
+        }
+    }
+
+    return released;
+}
+
+
+static uint32_t lcm (uint32_t a, uint32_t b)
+{
+    const uint64_t L = ((uint64_t) a / gcd (a, b)) * b;
+    return (L > SCHEDULER_ANALYSIS_MAX_TICKS)? 0 : L;
+}
+
+
+// Release checks (one task at one tick) to replay 'ticks' with 'count' tasks
+static bool withinBudget (uint32_t ticks, uint64_t count)
+{
+    return (ticks * count <= SCHEDULER_ANALYSIS_MAX_CHECKS);
+}
+
+
+/*
+    Collects the periodic tasks in the task array, with their current release
+    phases. Returns their hyperperiod, 0 if longer than
+    SCHEDULER_ANALYSIS_MAX_TICKS.
+*/
+static uint32_t collectTasks (sAnalysisTask_t set[], uint32_t *count,
+                              const uint32_t wcet[])
+{
+    uint32_t hyperperiod = 1;
+    *count = 0;
+
+    for (uint32_t i = 0; i < SCHEDULER_MAX_TASKS; ++i)
+    {
+        const sTask_t* t = &schedulerTasks[i];
+        if (!t->pTask || t->period <= 0)
+        {
+            continue;
+        }
+
+        sAnalysisTask_t* s = &set[(*count) ++];
+        s->index    = i;
+        s->period   = t->period;
+        s->phase    = schedulerTicksToRelease (i) % s->period;
+        s->wcet     = 0;
+
+        if (wcet)
+        {
+            s->wcet = wcet[i];
+        }
+#if SCHEDULER_PROFILE
+        else
+        {
+            s->wcet = schedulerGetTaskProfile(i)->cyclesMax;
+        }
+#endif
+        if (hyperperiod)
+        {
+            hyperperiod = lcm (hyperperiod, s->period);
+        }
+    }
+
+    return hyperperiod;
+}
+
+
+/*
+    Scores a task with that period first released at 'offset' against the
+    tasks in 'set': the most tasks released in a single tick and the total
+    collisions over the hyperperiod. Stops early once the peak goes over
+    'bound'. Returns the release checks spent.
+*/
+static uint32_t scoreOffset (const sAnalysisTask_t set[], uint32_t count,
+                             uint32_t hyperperiod, uint32_t period,
+                             uint32_t offset, uint32_t bound,
+                             uint32_t *peak, uint32_t *sum)
+{
+    const uint32_t Releases = hyperperiod / period;
+    uint32_t k = 0;
+
+    *peak   = 0;
+    *sum    = 0;
+
+    for (; k < Releases && *peak <= bound; ++k)
+    {
+        const uint32_t Tick = offset % period + k * period;
+        const uint32_t Released = releasedAt (set, count, Tick, NULL) + 1;
+        *sum += Released - 1;
+        if (Released > *peak)
+        {
+            *peak = Released;
+        }
+    }
+
+    return k * count + 1;
+}
+
+
+/*
+    Returns the first release delay in [first, first + period) that
+    minimizes the most tasks released in a single tick (and then the total
+    collisions) of a task with that period against the tasks in 'set'.
+*/
+static uint32_t bestOffset (const sAnalysisTask_t set[], uint32_t count,
+                            uint32_t hyperperiod, uint32_t period,
+                            uint32_t first)
+{
+    uint32_t best           = first;
+    uint32_t bestPeak       = UINT32_MAX;
+    uint32_t bestSum        = UINT32_MAX;
+
+    for (uint32_t offset = first; offset < first + period; ++offset)
+    {
+        uint32_t peak;
+        uint32_t sum;
+
+        scoreOffset (set, count, hyperperiod, period, offset, bestPeak,
+                     &peak, &sum);
+
+        if (peak < bestPeak || (peak == bestPeak && sum < bestSum))
+        {
+            best        = offset;
+            bestPeak    = peak;
+            bestSum     = sum;
+        }
+    }
+
+    return best;
+}
+
+
+/*
+    Returns the first release delay, not earlier than 'delay', for a new task
+    with the given period that minimizes the most tasks released in a single
+    tick together with the periodic tasks already in the task array. Returns
+    'delay' unchanged for one shot tasks or when the resulting hyperperiod is
+    longer than SCHEDULER_ANALYSIS_MAX_TICKS, or when searching it takes
+    more than SCHEDULER_ANALYSIS_MAX_CHECKS.
+*/
+uint32_t schedulerBalancedDelay (uint32_t delay, uint32_t period)
+{
+    if (!period)
+    {
+        return delay;
+    }
+
+    sAnalysisTask_t set[SCHEDULER_MAX_TASKS];
+    uint32_t count;
+    uint32_t hyperperiod = collectTasks (set, &count, NULL);
+
+    if (hyperperiod)
+    {
+        hyperperiod = lcm (hyperperiod, period);
+    }
+
+    if (!hyperperiod || !withinBudget (hyperperiod, count))
+    {
+        return delay;
+    }
+
+    // Delays 0 and 1 both release the task on the next tick
+    return bestOffset (set, count, hyperperiod, period, delay? delay : 1);
+}
+
+
+enum
+{
+    ANALYSIS_REPLAY = 0,
+    ANALYSIS_PLACE,
+    ANALYSIS_BALANCED_PEAK,
+    ANALYSIS_DONE
+};
+
+
+// Per tick release counts of one tick of the replay from the current phases
+static void replayTick (sSchedulerAnalysis_t *a, const sAnalysisTask_t set[],
+                        uint32_t count, uint32_t t)
+{
+    uint32_t cycles = 0;
+    const uint32_t Released = releasedAt (set, count, t, &cycles);
+
+    if (Released > 1)
+    {
+        ++ a->collisionTicks;
+    }
+
+    if (Released > a->peakTasks)
+    {
+        a->peakTasks = Released;
+        a->peakTicks = 1;
+    }
+    else if (Released == a->peakTasks)
+    {
+        ++ a->peakTicks;
+    }
+
+    if (cycles > a->peakCycles)
+    {
+        a->peakCycles = cycles;
+    }
+}
+
+
+/*
+    Balancing places the tasks one at a time, shortest period first, each at
+    the offset that best fits the tasks already placed. One offset of one
+    task is scored per call. Returns the release checks spent.
+*/
+static uint32_t placeStep (sSchedulerAnalysisJob_t *j)
+{
+    sSchedulerAnalysis_t *a = &j->analysis;
+
+    if (j->current == j->count)
+    {
+        // Shortest period not placed yet
+        for (uint32_t i = 0; i < j->count; ++i)
+        {
+            if (!(j->placedMask & (1u << i))
+                    && (j->current == j->count
+                        || j->set[i].period < j->set[j->current].period))
+            {
+                j->current = i;
+            }
+        }
+
+        j->bestOffset   = 1;
+        j->bestPeak     = UINT32_MAX;
+        j->bestSum      = UINT32_MAX;
+        j->cursor       = 0;
+    }
+
+    const sAnalysisTask_t *Task = &j->set[j->current];
+
+    if (j->cursor == Task->period)
+    {
+        // Every offset in [1, period] scored
+        sAnalysisTask_t *p = &j->placed[j->placedCount ++];
+        *p          = *Task;
+        p->phase    = j->bestOffset % Task->period;
+
+        a->offset[Task->index] = j->bestOffset;
+        j->placedMask |= 1u << j->current;
+        j->current = j->count;
+        return 1;
+    }
+
+    const uint32_t Offset = 1 + j->cursor ++;
+    uint32_t peak;
+    uint32_t sum;
+
+    const uint32_t Checks = scoreOffset (j->placed, j->placedCount,
+                                         a->hyperperiod, Task->period,
+                                         Offset, j->bestPeak, &peak, &sum);
+
+    if (peak < j->bestPeak || (peak == j->bestPeak && sum < j->bestSum))
+    {
+        j->bestOffset   = Offset;
+        j->bestPeak     = peak;
+        j->bestSum      = sum;
+    }
+
+    return Checks;
+}
+
+
+/*
+    Starts analyzing the periodic tasks currently in the task array:
+    utilization, hyperperiod, per tick release peaks and collisions,
+    replayed from their current release phases, and offsets that flatten
+    the per tick peak. Only the task snapshot and the utilization are taken
+    here; schedulerAnalyzeStep() does the rest.
+
+    wcet - Worst case execution time of each task slot, in cycles of the
+    profiler clock. If NULL, the maximum measured by the profiler is used
+    (0 if SCHEDULER_PROFILE is disabled).
+
+    RETURN VALUE: 0 on success, -1 on error.
+*/
+int8_t schedulerAnalyzeBegin (sSchedulerAnalysisJob_t *j,
+                              const uint32_t wcet[])
+{
+    if (!j)
+    {
+        return -1;
+    }
+
+    memset (j, 0, sizeof(sSchedulerAnalysisJob_t));
+    j->stage = ANALYSIS_DONE;
+
+    sSchedulerAnalysis_t *a = &j->analysis;
+    const uint32_t Hyperperiod = collectTasks (j->set, &j->count, wcet);
+
+    a->tasks = j->count;
+    if (!j->count)
+    {
+        return 0;
+    }
+
+#if SCHEDULER_PROFILE
+    const uint32_t ClockRate = schedulerProfileRate ();
+#elif defined(__arm__)
+    const uint32_t ClockRate = SystemCoreClock;
+#else
+    const uint32_t ClockRate = 0;
+#endif
+    a->tickCycles = ((uint64_t) ClockRate
+                        * SYSTICK_GetTickRateMicroseconds ()) / 1000000;
+
+    for (uint32_t i = 0; i < j->count && a->tickCycles; ++i)
+    {
+        a->utilization += ((uint64_t) j->set[i].wcet * 1000000)
+                            / ((uint64_t) j->set[i].period * a->tickCycles);
+    }
+
+    if (!Hyperperiod || !withinBudget (Hyperperiod, j->count))
+    {
+        return 0;
+    }
+
+    a->hyperperiod  = Hyperperiod;
+    j->stage        = ANALYSIS_REPLAY;
+    j->current      = j->count;
+
+    // On top of the replay, each placement replays the tasks already placed
+    // and then all of them once more
+    j->balance = withinBudget (Hyperperiod,
+                               (uint64_t) j->count * (j->count + 3) / 2);
+    return 0;
+}
+
+
+/*
+    Continues an analysis started by schedulerAnalyzeBegin(), spending
+    around 'maxChecks' release checks (one task at one tick). Returns true
+    while work remains: call it again, from the same task or a later run,
+    until it returns false.
+*/
+bool schedulerAnalyzeStep (sSchedulerAnalysisJob_t *j, uint32_t maxChecks)
+{
+    if (!j)
+    {
+        return false;
+    }
+
+    sSchedulerAnalysis_t *a = &j->analysis;
+    uint32_t checks = 0;
+
+    while (j->stage != ANALYSIS_DONE && checks < maxChecks)
+    {
+        if (j->stage == ANALYSIS_REPLAY)
+        {
+            if (j->cursor == a->hyperperiod)
+            {
+                j->stage  = j->balance? ANALYSIS_PLACE : ANALYSIS_DONE;
+                j->cursor = 0;
+                continue;
+            }
+
+            replayTick (a, j->set, j->count, j->cursor ++);
+            checks += j->count;
+        }
+        else if (j->stage == ANALYSIS_PLACE)
+        {
+            if (j->placedCount == j->count)
+            {
+                j->stage  = ANALYSIS_BALANCED_PEAK;
+                j->cursor = 0;
+                continue;
+            }
+
+            checks += placeStep (j);
+        }
+        else
+        {
+            if (j->cursor == a->hyperperiod)
+            {
+                j->stage = ANALYSIS_DONE;
+                continue;
+            }
+
+            const uint32_t Released = releasedAt (j->placed, j->placedCount,
+                                                  j->cursor ++, NULL);
+            if (Released > a->balancedPeakTasks)
+            {
+                a->balancedPeakTasks = Released;
+            }
+            checks += j->count;
+        }
+    }
+
+    return (j->stage != ANALYSIS_DONE);
+}
+
+
+/*
+    Runs a whole analysis at once, see schedulerAnalyzeBegin(). The work is
+    bounded by SCHEDULER_ANALYSIS_MAX_CHECKS, see copos.h: to keep a task
+    short, use schedulerAnalyzeStep() instead.
+
+    RETURN VALUE: 0 on success, -1 on error.
+*/
+int8_t schedulerAnalyze (sSchedulerAnalysis_t *a, const uint32_t wcet[])
+{
+    if (!a)
+    {
+        return -1;
+    }
+
+    sSchedulerAnalysisJob_t j;
+    schedulerAnalyzeBegin (&j, wcet);
+
+    while (schedulerAnalyzeStep (&j, UINT32_MAX))
+    {
+    }
+
+    *a = j.analysis;
+    return 0;
+}
@@ -0,0 +1,200 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "copos_util.h"
+#include "uart_util.h"
+#include "text.h"
+#include "variant.h"
+#include <stddef.h>
+#include <string.h>
+
+
+extern sTask_t schedulerTasks[SCHEDULER_MAX_TASKS];
+
+
+#if SCHEDULER_PROFILE
+// Parts: analysis start and steps, header, one per task slot and the
+// closing analysis
+#define PART_ANALYZE    1
+#define PART_HEADER     2
+#define PART_TASKS      3
+#define PART_ANALYSIS   (PART_TASKS + SCHEDULER_MAX_TASKS)
+
+
+// Worst case size UART_PutMessageArgs() can queue for 'msg'
+static uint32_t messageSize (const char *msg, uint32_t argc)
+{
+    return strlen (msg) + argc * VARIANT_FORMAT_SIZE;
+}
+
+
+static bool sendRoom (struct UART *uart, uint32_t size)
+{
+    return (UART_SendFree (uart) >= size);
+}
+
+
+static bool putHeader (struct UART *uart, sProfileReport_t *r)
+{
+    if (!sendRoom (uart, messageSize (TEXT_SCHEDULER_STATSBEGIN, 0)
+                            + messageSize (TEXT_SCHEDULER_STATS1, 1)))
+    {
+        return false;
+    }
+
+    struct VARIANT args[1];
+
+    UART_PutMessage     (uart, TEXT_SCHEDULER_STATSBEGIN);
+    VARIANT_SetUint32   (&args[0], schedulerProfileRate ());
+    UART_PutMessageArgs (uart, TEXT_SCHEDULER_STATS1, args, 1);
+    return true;
+}
+
+
+static bool putTask (struct UART *uart, sProfileReport_t *r, uint32_t i)
+{
+    const sTaskProfile_t *p = schedulerGetTaskProfile (i);
+    if (!p)
+    {
+        return true;
+    }
+
+    if (!sendRoom (uart, messageSize (TEXT_SCHEDULER_STATS2, 6)
+                            + messageSize (TEXT_SCHEDULER_STATS3, 8)))
+    {
+        return false;
+    }
+
+    struct VARIANT args[8];
+
+    // Sin ejecuciones los minimos siguen en UINT32_MAX
+    const bool Ran = (p->runs > 0);
+
+    VARIANT_SetUint32   (&args[0], i);
+    VARIANT_SetPointer  (&args[1], schedulerTasks[i].pTask);
+    VARIANT_SetUint32   (&args[2], p->runs);
+    VARIANT_SetUint32   (&args[3], Ran? p->cyclesMin : 0);
+    VARIANT_SetUint32   (&args[4], Ran? p->cyclesTotal / p->runs : 0);
+    VARIANT_SetUint32   (&args[5], p->cyclesMax);
+    UART_PutMessageArgs (uart, TEXT_SCHEDULER_STATS2, args, 6);
+
+    VARIANT_SetUint32   (&args[0], Ran? p->latencyMin : 0);
+    VARIANT_SetUint32   (&args[1], p->latencyMax);
+    VARIANT_SetUint32   (&args[2], Ran? p->latencyMax - p->latencyMin : 0);
+    VARIANT_SetUint32   (&args[3], p->missedDeadlines);
+    VARIANT_SetInt32    (&args[4], p->backlogMax);
+    VARIANT_SetUint32   (&args[5], r->analysis.analysis.offset[i]);
+    VARIANT_SetUint32   (&args[6], schedulerTasks[i].overruns);
+    VARIANT_SetUint32   (&args[7], schedulerTasks[i].droppedRuns);
+    UART_PutMessageArgs (uart, TEXT_SCHEDULER_STATS3, args, 8);
+    return true;
+}
+
+
+static bool putAnalysis (struct UART *uart, sProfileReport_t *r)
+{
+    if (!sendRoom (uart, messageSize (TEXT_SCHEDULER_STATS4, 9)
+                            + messageSize (TEXT_SCHEDULER_STATSEND, 0)))
+    {
+        return false;
+    }
+
+    const sSchedulerAnalysis_t *a = &r->analysis.analysis;
+    struct VARIANT args[9];
+
+    VARIANT_SetUint32   (&args[0], a->tasks);
+    VARIANT_SetUint32   (&args[1], a->utilization);
+    VARIANT_SetUint32   (&args[2], a->hyperperiod);
+    VARIANT_SetUint32   (&args[3], a->peakTasks);
+    VARIANT_SetUint32   (&args[4], a->peakTicks);
+    VARIANT_SetUint32   (&args[5], a->collisionTicks);
+    VARIANT_SetUint32   (&args[6], a->peakCycles);
+    VARIANT_SetUint32   (&args[7], a->tickCycles);
+    VARIANT_SetUint32   (&args[8], a->balancedPeakTasks);
+    UART_PutMessageArgs (uart, TEXT_SCHEDULER_STATS4, args, 9);
+
+    UART_PutMessage     (uart, TEXT_SCHEDULER_STATSEND);
+    return true;
+}
+#endif
+
+
+/*
+    Queues as many parts of the profile report as fit in the send buffer
+    (the whole report is larger than UART_SEND_BUFFER_SIZE). Returns true
+    while parts remain: call it again once UART_Send() made room. Each part
+    is queued whole or not at all. The schedule analysis goes first, at most
+    SCHEDULER_ANALYSIS_STEP_CHECKS per call: a long one takes several calls
+    before the header is queued.
+*/
+bool schedulerPutProfileMessage (struct UART *uart, sProfileReport_t *r)
+{
+#if SCHEDULER_PROFILE
+    while (r->part <= PART_ANALYSIS)
+    {
+        bool sent;
+
+        if (r->part < PART_ANALYZE)
+        {
+            // Las tareas no periodicas quedan con offset 0
+            sent = !schedulerAnalyzeBegin (&r->analysis, NULL);
+        }
+        else if (r->part < PART_HEADER)
+        {
+            // Las tareas muestran los offsets sugeridos: el analisis termina
+            // antes, de a un paso por llamada
+            sent = !schedulerAnalyzeStep (&r->analysis,
+                                          SCHEDULER_ANALYSIS_STEP_CHECKS);
+        }
+        else if (r->part < PART_TASKS)
+        {
+            sent = putHeader (uart, r);
+        }
+        else if (r->part < PART_ANALYSIS)
+        {
+            sent = putTask (uart, r, r->part - PART_TASKS);
+        }
+        else
+        {
+            sent = putAnalysis (uart, r);
+        }
+
+        if (!sent)
+        {
+            return true;
+        }
+
+        ++ r->part;
+    }
+
+    r->part = 0;
+#endif
+    return false;
+}
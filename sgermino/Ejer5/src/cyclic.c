@@ -32,6 +32,60 @@
 #include <string.h>
 
 
+// Copia en como maximo dos bloques: hasta el final del buffer y desde el
+// comienzo. Si size supera la capacidad solo sobreviven los ultimos bytes.
+static inline void copyIn (struct CYCLIC *c, const uint8_t *data, uint32_t size)
+{
+    // CYCLIC_In(): un memcpy de tamano variable cuesta mas que el byte
+    if (size == 1)
+    {
+        c->data[c->inIndex] = *data;
+        c->inIndex = (c->inIndex + 1) & (c->capacity - 1);
+        return;
+    }
+
+    if (size > c->capacity)
+    {
+        data += size - c->capacity;
+        c->inIndex = (c->inIndex + size - c->capacity) & (c->capacity - 1);
+        size = c->capacity;
+    }
+
+    const uint32_t First = (size < c->capacity - c->inIndex)?
+                                size : c->capacity - c->inIndex;
+
+    memcpy (&c->data[c->inIndex], data, First);
+    if (size > First)
+    {
+        memcpy (c->data, &data[First], size - First);
+    }
+
+    c->inIndex = (c->inIndex + size) & (c->capacity - 1);
+}
+
+
+static inline void copyOut (struct CYCLIC *c, uint8_t *data, uint32_t count)
+{
+    if (count == 1)
+    {
+        *data = c->data[c->outIndex];
+        c->outIndex = (c->outIndex + 1) & (c->capacity - 1);
+        return;
+    }
+
+    const uint32_t First = (count < c->capacity - c->outIndex)?
+                                count : c->capacity - c->outIndex;
+
+    memcpy (data, &c->data[c->outIndex], First);
+    if (count > First)
+    {
+        memcpy (&data[First], c->data, count - First);
+    }
+
+    c->outIndex = (c->outIndex + count) & (c->capacity - 1);
+}
+
+
 bool CYCLIC_Init (struct CYCLIC *c, uint8_t *data, uint32_t capacity)
 {
     if (!c || !data || !capacity)
@@ -64,6 +118,18 @@ uint32_t CYCLIC_Pending (struct CYCLIC *c)
 }
 
 
+// inIndex == outIndex es buffer vacio: como maximo capacity - 1 pendientes
+uint32_t CYCLIC_Free (struct CYCLIC *c)
+{
+    if (!c)
+    {
+        return 0;
+    }
+
+    return c->capacity - 1 - CYCLIC_Pending (c);
+}
+
+
 bool CYCLIC_In (struct CYCLIC *c, const uint8_t data)
 {
     return CYCLIC_InFromBuffer (c, &data, 1);
@@ -79,11 +145,7 @@ bool CYCLIC_InFromBuffer (struct CYCLIC *c, const uint8_t *data, uint32_t size)
 
     const uint32_t Pending = CYCLIC_Pending (c);
 
-    for (uint32_t i = size; i; --i)
-    {
-        c->data[c->inIndex] = *data ++;
-        c->inIndex = (c->inIndex + 1) & (c->capacity - 1);
-    }
+    copyIn (c, data, size);
 
     c->writes += size;
     if (size > c->capacity - Pending)
@@ -95,6 +157,29 @@ bool CYCLIC_InFromBuffer (struct CYCLIC *c, const uint8_t *data, uint32_t size)
 }
 
 
+// A diferencia de CYCLIC_InFromBuffer() no pisa datos pendientes: si no hay
+// lugar para todo el bloque no escribe nada y cuenta los bytes rechazados
+// como overflows.
+bool CYCLIC_InFromBufferNoOverwrite (struct CYCLIC *c, const uint8_t *data,
+                                     uint32_t size)
+{
+    if (!c || !data || !size)
+    {
+        return false;
+    }
+
+    if (size > CYCLIC_Free (c))
+    {
+        c->overflows += size;
+        return false;
+    }
+
+    copyIn (c, data, size);
+    c->writes += size;
+    return true;
+}
+
+
 uint32_t CYCLIC_InFromStream (struct CYCLIC *c,
                               STREAM_ByteInFunc streamFunc,
                               void *streamFuncHandler, uint32_t EOFSignal)
@@ -154,12 +239,7 @@ bool CYCLIC_OutToBuffer (struct CYCLIC *c, uint8_t *data, uint32_t count)
 
     c->reads += count;
 
-    while (count --)
-    {
-        *data ++ = c->data[c->outIndex];
-        c->outIndex = (c->outIndex + 1) & (c->capacity - 1);
-    }
-
+    copyOut (c, data, count);
     return true;
 }
 
@@ -210,7 +290,92 @@ uint8_t CYCLIC_Peek (struct CYCLIC *c, uint32_t offset)
 }
 
 
-bool CYCLIC_DiscardPending (struct CYCLIC *c)
+// Devuelve el espacio libre contiguo a partir de inIndex (sin pisar datos
+// pendientes) para escribir en el lugar. Los datos se publican recien con
+// CYCLIC_Commit(). Puede devolver menos que el espacio libre total si este
+// cruza el final del buffer: luego del Commit, otra llamada devuelve el resto.
+uint8_t * CYCLIC_Reserve (struct CYCLIC *c, uint32_t *size)
+{
+    if (!c || !size)
+    {
+        return NULL;
+    }
+
+    const uint32_t Free = CYCLIC_Free (c);
+    const uint32_t ToEnd = c->capacity - c->inIndex;
+
+    *size = (Free < ToEnd)? Free : ToEnd;
+    return &c->data[c->inIndex];
+}
+
+
+bool CYCLIC_Commit (struct CYCLIC *c, uint32_t count)
+{
+    if (!c)
+    {
+        return false;
+    }
+
+    const uint32_t Free = CYCLIC_Free (c);
+    if (count > Free)
+    {
+        c->overflows += count - Free;
+        count = Free;
+    }
+
+    c->inIndex = (c->inIndex + count) & (c->capacity - 1);
+    c->writes += count;
+    return true;
+}
+
+
+// Devuelve la porcion contigua de datos pendientes a partir de offset, hasta
+// el final de los datos o del buffer. Cuenta como un unico peek.
+const uint8_t * CYCLIC_PeekSpan (struct CYCLIC *c, uint32_t offset,
+                                 uint32_t *size)
+{
+    if (!c || !size)
+    {
+        return NULL;
+    }
+
+    const uint32_t Pending = CYCLIC_Pending (c);
+    if (offset >= Pending)
+    {
+        *size = 0;
+        return NULL;
+    }
+
+    const uint32_t Start = (c->outIndex + offset) & (c->capacity - 1);
+    const uint32_t ToEnd = c->capacity - Start;
+
+    ++ c->peeks;
+    *size = (Pending - offset < ToEnd)? Pending - offset : ToEnd;
+    return &c->data[Start];
+}
+
+
+// Como CYCLIC_Discard() pero los datos cuentan como leidos
+bool CYCLIC_Consume (struct CYCLIC *c, uint32_t count)
+{
+    if (!c)
+    {
+        return false;
+    }
+
+    const uint32_t Pending = CYCLIC_Pending (c);
+    if (count > Pending)
+    {
+        count = Pending;
+    }
+
+    c->outIndex = (c->outIndex + count) & (c->capacity - 1);
+    c->reads += count;
+    return true;
+}
+
+
+bool CYCLIC_Discard (struct CYCLIC *c, uint32_t count)
 {
     if (!c)
     {
@@ -218,8 +383,19 @@ bool CYCLIC_DiscardPending (struct CYCLIC *c)
     }
 
     const uint32_t Pending = CYCLIC_Pending (c);
-    c->outIndex = (c->outIndex + Pending) & (c->capacity - 1);
-    c->discards += Pending;
+    if (count > Pending)
+    {
+        count = Pending;
+    }
+
+    c->outIndex = (c->outIndex + count) & (c->capacity - 1);
+    c->discards += count;
     return true;
 }
 
+
+bool CYCLIC_DiscardPending (struct CYCLIC *c)
+{
+    return CYCLIC_Discard (c, CYCLIC_Pending (c));
+}
+
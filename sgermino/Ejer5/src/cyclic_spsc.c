@@ -0,0 +1,226 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "cyclic_spsc.h"
+#include <string.h>
+
+#ifdef __arm__
+    #include "chip.h"   // CMSIS
+#endif
+
+
+// Lectura del indice del otro lado: los datos que protege deben verse
+// despues del indice (acquire).
+static inline uint32_t loadAcquire (CYCLIC_SPSC_Index *index)
+{
+#ifdef __arm__
+    const uint32_t Value = *index;
+    __DMB ();
+    return Value;
+#else
+    return atomic_load_explicit (index, memory_order_acquire);
+#endif
+}
+
+
+// Publicacion del indice propio: los datos copiados deben ser visibles
+// antes que el nuevo indice (release).
+static inline void storeRelease (CYCLIC_SPSC_Index *index, uint32_t value)
+{
+#ifdef __arm__
+    __DMB ();
+    *index = value;
+#else
+    atomic_store_explicit (index, value, memory_order_release);
+#endif
+}
+
+
+// Lectura del indice propio, solo modificado por este lado.
+static inline uint32_t loadOwn (CYCLIC_SPSC_Index *index)
+{
+#ifdef __arm__
+    return *index;
+#else
+    return atomic_load_explicit (index, memory_order_relaxed);
+#endif
+}
+
+
+bool CYCLIC_SPSC_Init (struct CYCLIC_SPSC *c, uint8_t *data, uint32_t capacity)
+{
+    if (!c || !data || !capacity)
+    {
+        return false;
+    }
+
+    // Capacity debe ser potencia de 2
+    if (capacity & (capacity - 1))
+    {
+        return false;
+    }
+
+    memset (c, 0, sizeof(struct CYCLIC_SPSC));
+
+    c->data       = data;
+    c->capacity   = capacity;
+    return true;
+}
+
+
+uint32_t CYCLIC_SPSC_Free (struct CYCLIC_SPSC *c)
+{
+    if (!c)
+    {
+        return 0;
+    }
+
+    return c->capacity - (loadOwn (&c->prod.inIndex) -
+                          loadAcquire (&c->cons.outIndex));
+}
+
+
+bool CYCLIC_SPSC_In (struct CYCLIC_SPSC *c, const uint8_t data)
+{
+    return (CYCLIC_SPSC_InFromBuffer (c, &data, 1) == 1);
+}
+
+
+// Nunca pisa datos pendientes: escribe lo que entra y devuelve esa cantidad.
+uint32_t CYCLIC_SPSC_InFromBuffer (struct CYCLIC_SPSC *c, const uint8_t *data,
+                                   uint32_t size)
+{
+    if (!c || !data || !size)
+    {
+        return 0;
+    }
+
+    const uint32_t In   = loadOwn (&c->prod.inIndex);
+    const uint32_t Free = c->capacity - (In - loadAcquire (&c->cons.outIndex));
+
+    if (size > Free)
+    {
+        c->prod.overflows += size - Free;
+        size = Free;
+    }
+
+    const uint32_t Start = In & (c->capacity - 1);
+    const uint32_t First = (size < c->capacity - Start)?
+                                size : c->capacity - Start;
+
+    memcpy (&c->data[Start], data, First);
+    memcpy (c->data, &data[First], size - First);
+
+    c->prod.writes += size;
+    storeRelease (&c->prod.inIndex, In + size);
+    return size;
+}
+
+
+uint32_t CYCLIC_SPSC_Pending (struct CYCLIC_SPSC *c)
+{
+    if (!c)
+    {
+        return 0;
+    }
+
+    return loadAcquire (&c->prod.inIndex) - loadOwn (&c->cons.outIndex);
+}
+
+
+bool CYCLIC_SPSC_Out (struct CYCLIC_SPSC *c, uint8_t *data)
+{
+    return (CYCLIC_SPSC_OutToBuffer (c, data, 1) == 1);
+}
+
+
+uint32_t CYCLIC_SPSC_OutToBuffer (struct CYCLIC_SPSC *c, uint8_t *data,
+                                  uint32_t count)
+{
+    if (!c || !data || !count)
+    {
+        return 0;
+    }
+
+    const uint32_t Out     = loadOwn (&c->cons.outIndex);
+    const uint32_t Pending = loadAcquire (&c->prod.inIndex) - Out;
+
+    if (count > Pending)
+    {
+        count = Pending;
+    }
+
+    const uint32_t Start = Out & (c->capacity - 1);
+    const uint32_t First = (count < c->capacity - Start)?
+                                count : c->capacity - Start;
+
+    memcpy (data, &c->data[Start], First);
+    memcpy (&data[First], c->data, count - First);
+
+    c->cons.reads += count;
+    storeRelease (&c->cons.outIndex, Out + count);
+    return count;
+}
+
+
+// Antes llamar a CYCLIC_SPSC_Pending() para conocer la cantidad de datos
+// disponibles
+uint8_t CYCLIC_SPSC_Peek (struct CYCLIC_SPSC *c, uint32_t offset)
+{
+    if (!c)
+    {
+        return 0;
+    }
+
+    ++ c->cons.peeks;
+    return c->data[(loadOwn (&c->cons.outIndex) + offset) &
+                   (c->capacity - 1)];
+}
+
+
+uint32_t CYCLIC_SPSC_Discard (struct CYCLIC_SPSC *c, uint32_t count)
+{
+    if (!c)
+    {
+        return 0;
+    }
+
+    const uint32_t Out     = loadOwn (&c->cons.outIndex);
+    const uint32_t Pending = loadAcquire (&c->prod.inIndex) - Out;
+
+    if (count > Pending)
+    {
+        count = Pending;
+    }
+
+    c->cons.discards += count;
+    storeRelease (&c->cons.outIndex, Out + count);
+    return count;
+}
@@ -0,0 +1,379 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "fmt.h"
+
+
+// Maximo de caracteres de un numero sin relleno: float de 39 digitos
+// enteros, punto y FMT_FLOAT_MAX_DECIMALS decimales.
+#define FMT_MAX_CHARS   (39 + 1 + FMT_FLOAT_MAX_DECIMALS)
+
+
+static const char g_hexLower[16] = "0123456789abcdef";
+static const char g_hexUpper[16] = "0123456789ABCDEF";
+
+static const uint32_t g_pow10[10] = { 1, 10, 100, 1000, 10000, 100000,
+                                      1000000, 10000000, 100000000,
+                                      1000000000 };
+
+
+struct OUT
+{
+    char        *dst;
+    uint32_t    size;
+    uint32_t    len;
+};
+
+
+static inline void put (struct OUT *o, char c)
+{
+    if (o->len + 1 < o->size)
+    {
+        o->dst[o->len] = c;
+    }
+    ++ o->len;
+}
+
+
+static uint32_t finish (struct OUT *o)
+{
+    if (o->size)
+    {
+        o->dst[(o->len < o->size)? o->len : o->size - 1] = '\0';
+    }
+    return o->len;
+}
+
+
+// n / 10 exacto para todo n de 32 bits: 0xCCCCCCCD = ceil(2^35 / 10)
+static inline uint32_t div10 (uint32_t n)
+{
+    return (uint32_t)(((uint64_t)n * 0xCCCCCCCDu) >> 35);
+}
+
+
+// Los digitos se generan en orden inverso (unidades primero)
+static uint32_t decDigits (char *rev, uint32_t value)
+{
+    uint32_t count = 0;
+    do
+    {
+        const uint32_t Q = div10 (value);
+        rev[count ++] = (char)('0' + (value - Q * 10));
+        value = Q;
+    }
+    while (value);
+    return count;
+}
+
+
+static uint32_t decDigitsFixed (char *rev, uint32_t value, uint32_t digits)
+{
+    for (uint32_t i = 0; i < digits; ++i)
+    {
+        const uint32_t Q = div10 (value);
+        rev[i] = (char)('0' + (value - Q * 10));
+        value = Q;
+    }
+    return digits;
+}
+
+
+// Una division de 64 bits cada 9 digitos en lugar de una por digito
+static uint32_t decDigits64 (char *rev, uint64_t value)
+{
+    uint32_t count = 0;
+    while (value > UINT32_MAX)
+    {
+        const uint64_t Q = value / 1000000000u;
+        count += decDigitsFixed (&rev[count],
+                                 (uint32_t)(value - Q * 1000000000u), 9);
+        value = Q;
+    }
+    return count + decDigits (&rev[count], (uint32_t)value);
+}
+
+
+// mant * 2^shift, hasta 128 bits (parte entera de un float muy grande)
+static uint32_t decDigitsBig (char *rev, uint32_t mant, uint32_t shift)
+{
+    uint32_t w[4] = { 0, 0, 0, 0 };
+    const uint32_t Word = shift / 32;
+    const uint32_t Bit  = shift % 32;
+
+    w[Word] = mant << Bit;
+    if (Bit && Word < 3)
+    {
+        w[Word + 1] = mant >> (32 - Bit);
+    }
+
+    uint32_t count = 0;
+    while (w[3] || w[2] || w[1])
+    {
+        uint64_t rem = 0;
+        for (int32_t i = 3; i >= 0; --i)
+        {
+            const uint64_t Cur = (rem << 32) | w[i];
+            w[i] = (uint32_t)(Cur / 1000000000u);
+            rem  = Cur - (uint64_t)w[i] * 1000000000u;
+        }
+        count += decDigitsFixed (&rev[count], (uint32_t)rem, 9);
+    }
+    return count + decDigits (&rev[count], w[0]);
+}
+
+
+static uint32_t hexDigits (char *rev, uint64_t value, const char *table)
+{
+    uint32_t count = 0;
+    do
+    {
+        rev[count ++] = table[value & 0xF];
+        value >>= 4;
+    }
+    while (value);
+    return count;
+}
+
+
+static uint32_t emit (char *dst, uint32_t size, const char *prefix,
+                      const char *rev, uint32_t count, uint32_t width,
+                      char pad)
+{
+    struct OUT o = { dst, size, 0 };
+
+    uint32_t prefixLen = 0;
+    while (prefix[prefixLen])
+    {
+        ++ prefixLen;
+    }
+
+    uint32_t fill = (width > prefixLen + count)? width - prefixLen - count : 0;
+
+    if (pad != '0')
+    {
+        while (fill)
+        {
+            put (&o, pad);
+            -- fill;
+        }
+    }
+
+    for (uint32_t i = 0; i < prefixLen; ++i)
+    {
+        put (&o, prefix[i]);
+    }
+
+    while (fill)
+    {
+        put (&o, '0');
+        -- fill;
+    }
+
+    while (count)
+    {
+        put (&o, rev[-- count]);
+    }
+
+    return finish (&o);
+}
+
+
+uint32_t FMT_Uint32 (char *dst, uint32_t size, uint32_t value,
+                     uint32_t width, char pad)
+{
+    char rev[FMT_MAX_CHARS];
+    return emit (dst, size, "", rev, decDigits (rev, value), width, pad);
+}
+
+
+uint32_t FMT_Int32 (char *dst, uint32_t size, int32_t value,
+                    uint32_t width, char pad)
+{
+    char rev[FMT_MAX_CHARS];
+    const uint32_t Magnitude = (value < 0)? 0u - (uint32_t)value
+                                          : (uint32_t)value;
+    return emit (dst, size, (value < 0)? "-" : "", rev,
+                 decDigits (rev, Magnitude), width, pad);
+}
+
+
+uint32_t FMT_Uint64 (char *dst, uint32_t size, uint64_t value,
+                     uint32_t width, char pad)
+{
+    char rev[FMT_MAX_CHARS];
+    return emit (dst, size, "", rev, decDigits64 (rev, value), width, pad);
+}
+
+
+uint32_t FMT_Int64 (char *dst, uint32_t size, int64_t value,
+                    uint32_t width, char pad)
+{
+    char rev[FMT_MAX_CHARS];
+    const uint64_t Magnitude = (value < 0)? 0u - (uint64_t)value
+                                          : (uint64_t)value;
+    return emit (dst, size, (value < 0)? "-" : "", rev,
+                 decDigits64 (rev, Magnitude), width, pad);
+}
+
+
+uint32_t FMT_Hex32 (char *dst, uint32_t size, uint32_t value,
+                    uint32_t width, char pad, bool upper)
+{
+    char rev[FMT_MAX_CHARS];
+    return emit (dst, size, "", rev,
+                 hexDigits (rev, value, upper? g_hexUpper : g_hexLower),
+                 width, pad);
+}
+
+
+// Mismo formato que "%p" de newlib
+uint32_t FMT_Pointer (char *dst, uint32_t size, const void *p)
+{
+    char rev[FMT_MAX_CHARS];
+    return emit (dst, size, "0x", rev,
+                 hexDigits (rev, (uintptr_t)p, g_hexLower), 0, ' ');
+}
+
+
+/*
+    Equivalente a "%.*f": redondeo al par mas cercano sobre el valor exacto
+    del float. El float se descompone en mantisa y exponente, la parte
+    entera se convierte como entero y la fraccion se escala por 10^decimals
+    con aritmetica entera de 64 bits.
+*/
+uint32_t FMT_Float (char *dst, uint32_t size, float value, uint32_t decimals,
+                    uint32_t width, char pad)
+{
+    union
+    {
+        float       f;
+        uint32_t    u;
+    }
+    bits = { .f = value };
+
+    const char *    Sign = (bits.u >> 31)? "-" : "";
+    const uint32_t  Exp  = (bits.u >> 23) & 0xFF;
+    uint32_t        mant = bits.u & 0x7FFFFF;
+
+    if (Exp == 0xFF)
+    {
+        struct OUT o = { dst, size, 0 };
+        const char *Text = mant? "nan" : "inf";
+        const uint32_t Len = Sign[0]? 4 : 3;
+
+        for (uint32_t i = Len; i < width; ++i)
+        {
+            put (&o, ' ');
+        }
+        if (Sign[0])
+        {
+            put (&o, '-');
+        }
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            put (&o, Text[i]);
+        }
+        return finish (&o);
+    }
+
+    if (decimals > FMT_FLOAT_MAX_DECIMALS)
+    {
+        decimals = FMT_FLOAT_MAX_DECIMALS;
+    }
+
+    if (Exp)
+    {
+        mant |= 0x800000;
+    }
+
+    // |value| = mant * 2^e
+    const int32_t E = (int32_t)(Exp? Exp : 1) - 150;
+
+    char     rev[FMT_MAX_CHARS];
+    uint32_t count = 0;
+
+    if (E >= 0)
+    {
+        // Sin parte fraccionaria
+        for (uint32_t i = 0; i < decimals; ++i)
+        {
+            rev[count ++] = '0';
+        }
+        if (decimals)
+        {
+            rev[count ++] = '.';
+        }
+
+        count += (E <= 40)? decDigits64 (&rev[count], (uint64_t)mant << E)
+                          : decDigitsBig (&rev[count], mant, (uint32_t)E);
+    }
+    else
+    {
+        const uint32_t K        = (uint32_t)(-E);
+        uint32_t       intPart  = (K < 32)? mant >> K : 0;
+        const uint32_t FracBits = (K < 32)? mant & ((1u << K) - 1) : mant;
+
+        // fracBits / 2^K * 10^decimals, redondeado al par mas cercano
+        const uint64_t Scaled = (uint64_t)FracBits * g_pow10[decimals];
+        uint32_t frac = 0;
+
+        if (K < 64)
+        {
+            const uint64_t Half = (uint64_t)1 << (K - 1);
+            const uint64_t Rem  = Scaled & (((uint64_t)1 << K) - 1);
+
+            frac = (uint32_t)(Scaled >> K);
+            // En empate, el ultimo digito impreso debe quedar par
+            const uint32_t Last = decimals? frac : intPart;
+            if (Rem > Half || (Rem == Half && (Last & 1)))
+            {
+                ++ frac;
+            }
+        }
+
+        // El redondeo puede pasar a la parte entera (por ej. 0.9999999)
+        if (frac == g_pow10[decimals])
+        {
+            frac = 0;
+            ++ intPart;
+        }
+
+        if (decimals)
+        {
+            count += decDigitsFixed (&rev[count], frac, decimals);
+            rev[count ++] = '.';
+        }
+
+        count += decDigits (&rev[count], intPart);
+    }
+
+    return emit (dst, size, Sign, rev, count, width, pad);
+}
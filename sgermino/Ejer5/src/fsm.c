@@ -30,6 +30,7 @@
 */
 #include "fsm.h"
 #include "systick.h"
+#include "swtimer.h"
 #include <string.h>
 
 
@@ -89,15 +90,31 @@ bool FSM_SetStateInfo (struct FEM *f, const char* info)
 }
 
 
+// Las comparaciones de ticks restan en lugar de comparar vencimientos
+// absolutos, por lo que funcionan a traves del desborde del contador.
+static bool expired (uint32_t deadline, uint32_t now)
+{
+    return ((int32_t)(now - deadline) >= 0);
+}
+
+
+// stateCountdownTicks en 0 indica cuenta regresiva inactiva
+static uint32_t countdownDeadline (uint32_t now, uint32_t timeoutTicks)
+{
+    const uint32_t Deadline = now + timeoutTicks;
+    return Deadline? Deadline : 1;
+}
+
+
 bool FSM_StateTimeout (struct FEM *f, uint32_t timeoutTicks)
 {
-    return (f && f->stateStartTicks + timeoutTicks >= SYSTICK_Now());
+    return (f && SYSTICK_Now() - f->stateStartTicks >= timeoutTicks);
 }
 
 
 bool FSM_StageTimeout (struct FEM *f, uint32_t timeoutTicks)
 {
-    return (f && f->stageStartTicks + timeoutTicks <= SYSTICK_Now());
+    return (f && SYSTICK_Now() - f->stageStartTicks >= timeoutTicks);
 }
 
 
@@ -108,15 +125,16 @@ bool FSM_StateCountdown (struct FEM *f, uint32_t timeoutTicks)
         return false;
     }
 
-    const uint32_t NextTimeout = SYSTICK_Now() + timeoutTicks;
+    const uint32_t Now = SYSTICK_Now ();
 
     if (!f->stateCountdownTicks)
     {
-        f->stateCountdownTicks = NextTimeout;
+        f->stateCountdownTicks = countdownDeadline (Now, timeoutTicks);
     }
-    else if (SYSTICK_Now() >= f->stateCountdownTicks)
+    else if (expired (f->stateCountdownTicks, Now))
     {
-        f->stateCountdownTicks = timeoutTicks? NextTimeout : 0;
+        f->stateCountdownTicks = timeoutTicks?
+                                countdownDeadline (Now, timeoutTicks) : 0;
         return true;
     }
 
@@ -133,12 +151,13 @@ uint32_t FSM_StateCountdownSeconds (struct FEM *f)
 
     const uint32_t Now = SYSTICK_Now ();
 
-    if (Now >= f->stateCountdownTicks)
+    if (expired (f->stateCountdownTicks, Now))
     {
         return 0;
     }
 
-    return (f->stateCountdownTicks - Now) / SYSTICK_GetTickRateMicroseconds();
+    return ((uint64_t)(f->stateCountdownTicks - Now) *
+                        SYSTICK_GetTickRateMicroseconds()) / 1000000;
 }
 
 
@@ -174,6 +193,367 @@ bool FSM_ChangeState (struct FEM *f, FSM_StateFunc newState)
 }
 
 
+static uint8_t parentOf (struct FEM *f, uint8_t stateId)
+{
+    return f->table->states[stateId].parent;
+}
+
+
+static const struct FSM_Transition * transitionAt (struct FEM *f,
+                                                   uint8_t stateId,
+                                                   uint8_t event)
+{
+    const struct FSM_Table *t = f->table;
+    const struct FSM_Transition *tr =
+                            &t->transitions[stateId * t->eventCount + event];
+
+    return (tr->target || tr->action)? tr : NULL;
+}
+
+
+// Ancestro comun mas profundo que es ancestro propio de ambos estados: hasta
+// ahi se sale y desde ahi se entra en una transicion externa.
+static uint8_t lcaOf (struct FEM *f, uint8_t a, uint8_t b)
+{
+    const struct FSM_Table *t = f->table;
+    return t->lca? t->lca[a * t->stateCount + b] : FSM_StateNone;
+}
+
+
+static bool isAncestor (const struct FSM_Table *t, uint8_t ancestor,
+                        uint8_t stateId)
+{
+    while (stateId != FSM_StateNone)
+    {
+        stateId = t->states[stateId].parent;
+        if (stateId == ancestor)
+        {
+            return true;
+        }
+    }
+
+    return (ancestor == FSM_StateNone);
+}
+
+
+// Padres validos, profundidad acotada y lca igual al que resulta de los
+// padres. Se calcula una vez al iniciar; las transiciones solo lo indexan.
+static bool checkLca (const struct FSM_Table *t)
+{
+    for (uint32_t i = 0; i < t->stateCount; ++i)
+    {
+        // Padre valido y profundidad acotada (sin ciclos)
+        uint32_t depth = 0;
+        for (uint8_t s = i; s != FSM_StateNone; s = t->states[s].parent)
+        {
+            if (s >= t->stateCount || ++ depth > FSM_MAX_STATE_DEPTH)
+            {
+                return false;
+            }
+        }
+
+        if (!t->lca)
+        {
+            if (t->states[i].parent != FSM_StateNone)
+            {
+                return false;
+            }
+            continue;
+        }
+
+        for (uint32_t j = 0; j < t->stateCount; ++j)
+        {
+            uint8_t lca = (i == FSM_StateNone)? FSM_StateNone :
+                                                t->states[i].parent;
+            while (!isAncestor (t, lca, j))
+            {
+                lca = t->states[lca].parent;
+            }
+
+            if (t->lca[i * t->stateCount + j] != lca)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+static void tableSetCurrent (struct FEM *f, uint8_t stateId)
+{
+    const struct FSM_TableState *s = &f->table->states[stateId];
+    const uint32_t Now = SYSTICK_Now ();
+
+    f->stateId                = stateId;
+    f->info                   = s->info;
+    f->stateCalls             = 0;
+    f->stateStartTicks        = Now;
+    f->stateCountdownTicks    = s->timeoutTicks?
+                                countdownDeadline (Now, s->timeoutTicks) : 0;
+    f->timeoutFired           = false;
+
+    if (s->timeoutTicks)
+    {
+        SWTIMER_Start (&f->timeout, Now, s->timeoutTicks);
+    }
+    else
+    {
+        SWTIMER_Stop (&f->timeout);
+    }
+
+    FSM_GotoStage (f, FSM_StageMain);
+}
+
+
+// Callback del timer del estado actual
+static void stateTimeout (void *ctx)
+{
+    struct FEM *f = (struct FEM *) ctx;
+
+    f->timeoutFired = true;
+    FSM_Post (f, FSM_EventTimeout);
+}
+
+
+// Entra a target y a sus ancestros por debajo de from, de afuera hacia adentro
+static void tableEnter (struct FEM *f, uint8_t from, uint8_t target)
+{
+    uint8_t path[FSM_MAX_STATE_DEPTH];
+    uint32_t depth = 0;
+
+    for (uint8_t s = target; s != from; s = parentOf (f, s))
+    {
+        path[depth ++] = s;
+    }
+
+    tableSetCurrent (f, target);
+
+    while (depth)
+    {
+        const FSM_ActionFunc Entry = f->table->states[path[-- depth]].entry;
+        if (Entry)
+        {
+            Entry (f);
+        }
+    }
+}
+
+
+// Sale del estado actual y de sus ancestros por debajo de to, de adentro
+// hacia afuera
+static void tableExit (struct FEM *f, uint8_t to)
+{
+    for (uint8_t s = f->stateId; s != to; s = parentOf (f, s))
+    {
+        const FSM_ActionFunc Exit = f->table->states[s].exit;
+        if (Exit)
+        {
+            Exit (f);
+        }
+    }
+}
+
+
+static bool tableDispatch (struct FEM *f, uint8_t event)
+{
+    // La entrada al estado inicial se hace con el primer evento o proceso
+    if (f->stage == FSM_StageBegin)
+    {
+        tableEnter (f, FSM_StateNone, f->stateId);
+    }
+
+    // El primer estado, desde el actual hacia sus ancestros, que atiende el
+    // evento y cuya guarda lo permite
+    uint8_t source = f->stateId;
+    const struct FSM_Transition *tr = NULL;
+
+    for (; source != FSM_StateNone; source = parentOf (f, source))
+    {
+        tr = transitionAt (f, source, event);
+        if (tr && (!tr->guard || tr->guard (f)))
+        {
+            break;
+        }
+    }
+
+    if (source == FSM_StateNone)
+    {
+        return false;
+    }
+
+    if (!tr->target)
+    {
+        tr->action (f);
+        return true;
+    }
+
+    uint8_t target = tr->target;
+    if (target == FSM_StateSelf)
+    {
+        source = target = f->stateId;
+    }
+
+    const uint8_t Lca = lcaOf (f, source, target);
+
+    tableExit (f, Lca);
+
+    if (tr->action)
+    {
+        tr->action (f);
+    }
+
+    tableEnter (f, Lca, target);
+    return true;
+}
+
+
+static bool tableProcess (struct FEM *f)
+{
+    if (f->stage == FSM_StageBegin)
+    {
+        tableEnter (f, FSM_StateNone, f->stateId);
+    }
+
+    // Sin eventos (incluido el timeout) no hay nada que hacer
+    if (!FSM_Pending (f))
+    {
+        return true;
+    }
+
+    ++ f->stateCalls;
+    ++ f->stageCalls;
+
+    uint8_t event;
+    while (CYCLIC_SPSC_Out (&f->events, &event))
+    {
+        if (event == FSM_EventTimeout)
+        {
+            // Timeout de un estado del que ya se salio
+            if (!f->timeoutFired)
+            {
+                continue;
+            }
+
+            f->timeoutFired         = false;
+            f->stateCountdownTicks  = 0;
+        }
+
+        FSM_Dispatch (f, event);
+    }
+
+    return true;
+}
+
+
+bool FSM_InitTable (struct FEM *f, const struct FSM_Table *table,
+                    uint8_t initialState, void *app)
+{
+    if (!table || initialState == FSM_StateNone ||
+        initialState >= table->stateCount || !checkLca (table) ||
+        !FSM_Init (f, app))
+    {
+        return false;
+    }
+
+    f->table    = table;
+    f->stateId  = initialState;
+    f->info     = table->states[initialState].info;
+    CYCLIC_SPSC_Init (&f->events, f->eventData, sizeof(f->eventData));
+    SWTIMER_Init     (&f->timeout, stateTimeout, f);
+
+    FSM_GotoStage (f, FSM_StageBegin);
+    return true;
+}
+
+
+bool FSM_Dispatch (struct FEM *f, uint8_t event)
+{
+    if (!f || !f->table || event >= f->table->eventCount)
+    {
+        return false;
+    }
+
+    // Un evento generado desde una accion se encola: se atiende en
+    // FSM_Process() al terminar la transicion en curso (run-to-completion)
+    if (f->dispatching)
+    {
+        return FSM_Post (f, event);
+    }
+
+    f->dispatching = true;
+    const bool Handled = tableDispatch (f, event);
+    f->dispatching = false;
+    return Handled;
+}
+
+
+bool FSM_Post (struct FEM *f, uint8_t event)
+{
+    if (!f || !f->table || event >= f->table->eventCount)
+    {
+        return false;
+    }
+
+    if (!CYCLIC_SPSC_In (&f->events, event))
+    {
+        ++ f->eventsLost;
+        return false;
+    }
+
+    if (f->postHook)
+    {
+        f->postHook (f->postHookCtx);
+    }
+
+    return true;
+}
+
+
+bool FSM_SetPostHook (struct FEM *f, FSM_PostHookFunc func, void *ctx)
+{
+    if (!f)
+    {
+        return false;
+    }
+
+    f->postHook     = func;
+    f->postHookCtx  = ctx;
+    return true;
+}
+
+
+bool FSM_Pending (struct FEM *f)
+{
+    if (!f || !f->table)
+    {
+        return false;
+    }
+
+    return (CYCLIC_SPSC_Pending (&f->events) != 0);
+}
+
+
+bool FSM_Handles (struct FEM *f, uint8_t event)
+{
+    if (!f || !f->table || event >= f->table->eventCount)
+    {
+        return false;
+    }
+
+    for (uint8_t s = f->stateId; s != FSM_StateNone; s = parentOf (f, s))
+    {
+        if (transitionAt (f, s, event))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
 bool FSM_Process (struct FEM *f, uint32_t curTicks,
                   uint32_t timeoutTicks)
 {
@@ -182,11 +562,13 @@ bool FSM_Process (struct FEM *f, uint32_t curTicks,
         return false;
     }
 
-    if (timeoutTicks)
+    if (f->table)
     {
-        timeoutTicks = curTicks + timeoutTicks;
+        return tableProcess (f);
     }
 
+    const uint32_t Deadline = curTicks + timeoutTicks;
+
     uint32_t recurringCalls = 0;
     enum FSM_StateReturn ret;
     do
@@ -196,7 +578,7 @@ bool FSM_Process (struct FEM *f, uint32_t curTicks,
             return false;
         }
 
-        if (timeoutTicks && SYSTICK_Now() >= timeoutTicks)
+        if (timeoutTicks && expired (Deadline, SYSTICK_Now()))
         {
             break;
         }
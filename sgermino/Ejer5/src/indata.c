@@ -43,7 +43,13 @@ bool INDATA_Init (struct INDATA *d, struct UART *uart)
 
     memset (d, 0, sizeof(struct INDATA));
 
-    ARRAY_Init (&d->a, d->data, sizeof(d->data));
+    // El buffer de edicion sale del arena de ARRAY
+    if (!ARRAY_InitFromArena (&d->a, INDATA_BUFFER_SIZE,
+                              ARRAY_FlagTerminator))
+    {
+        return false;
+    }
+
     d->uart = uart;
     return true;
 }
@@ -56,8 +62,12 @@ bool INDATA_Begin (struct INDATA *d, enum INDATA_Type type)
         return false;
     }
 
-    d->status = INDATA_StatusPrompt;
-    d->type   = type;
+    d->status       = INDATA_StatusPrompt;
+    d->type         = type;
+    d->cursor       = 0;
+    d->utf8Pending  = 0;
+    d->escape       = INDATA_EscapeNone;
+    d->escapeParam  = 0;
     ARRAY_Reset (&d->a);
     return true;
 }
@@ -74,15 +84,236 @@ enum INDATA_Status INDATA_Status (struct INDATA *d)
 }
 
 
-static bool checkEndOfIndex (struct INDATA *d)
+// Eco acumulado durante una llamada a INDATA_Prompt(), se envia en una sola
+// escritura (o al llenarse)
+struct Echo
+{
+    struct UART *uart;
+    uint32_t    size;
+    uint8_t     buf [INDATA_ECHO_SIZE];
+};
+
+
+static void echoFlush (struct Echo *e)
+{
+    if (e->size)
+    {
+        UART_PutBinary (e->uart, e->buf, e->size);
+        e->size = 0;
+    }
+}
+
+
+static void echoBytes (struct Echo *e, const uint8_t *data, uint32_t size)
+{
+    while (size)
+    {
+        if (e->size == sizeof(e->buf))
+        {
+            echoFlush (e);
+        }
+
+        uint32_t count = sizeof(e->buf) - e->size;
+        if (count > size)
+        {
+            count = size;
+        }
+
+        memcpy (&e->buf[e->size], data, count);
+        e->size += count;
+        data    += count;
+        size    -= count;
+    }
+}
+
+
+static void echoString (struct Echo *e, const char *str)
+{
+    echoBytes (e, (const uint8_t *) str, strlen(str));
+}
+
+
+// Mueve el cursor de la terminal n columnas, code 'C' (derecha) o 'D'
+// (izquierda). TERM_CURSOR_LEFT/RIGHT solo aceptan constantes.
+static void echoCursor (struct Echo *e, uint32_t n, char code)
+{
+    if (!n)
+    {
+        return;
+    }
+
+    char seq[sizeof(TERM_CSI) + 11];
+    uint32_t i = sizeof(seq);
+
+    seq[-- i] = '\0';
+    seq[-- i] = code;
+    do
+    {
+        seq[-- i] = '0' + n % 10;
+        n /= 10;
+    }
+    while (n);
+
+    echoString (e, TERM_CSI);
+    echoString (e, &seq[i]);
+}
+
+
+// Comienzo de un caracter: US-ASCII o primer byte de uno multibyte, mismo
+// criterio que ARRAY_RemoveChars()
+static bool charStart (uint8_t byte)
+{
+    return (byte <= 127 || byte >= 192);
+}
+
+
+static uint32_t prevChar (struct INDATA *d, uint32_t pos)
+{
+    while (pos && !charStart (d->a.data[-- pos]))
+    {
+    }
+    return pos;
+}
+
+
+static uint32_t nextChar (struct INDATA *d, uint32_t pos)
+{
+    // Avanza antes de leer: con el cursor en el ultimo caracter no se lee
+    // data[index]
+    while (++ pos < d->a.index && !charStart (d->a.data[pos]))
+    {
+    }
+    return (pos < d->a.index)? pos : d->a.index;
+}
+
+
+static uint32_t countChars (struct INDATA *d, uint32_t from, uint32_t to)
+{
+    uint32_t chars = 0;
+    for (; from < to; ++from)
+    {
+        chars += charStart (d->a.data[from]);
+    }
+    return chars;
+}
+
+
+// Reescribe desde el cursor hasta el final, borra las columnas que quedaron
+// libres y vuelve el cursor a su lugar
+static void redrawTail (struct INDATA *d, struct Echo *e, uint32_t erased)
+{
+    const uint32_t Tail = d->a.index - d->cursor;
+
+    echoBytes (e, &d->a.data[d->cursor], Tail);
+    for (uint32_t i = 0; i < erased; ++i)
+    {
+        echoString (e, " ");
+    }
+    echoCursor (e, countChars (d, d->cursor, d->a.index) + erased, 'D');
+}
+
+
+static void removeBytes (struct INDATA *d, uint32_t from, uint32_t to)
+{
+    memmove (&d->a.data[from], &d->a.data[to], d->a.index - to);
+    d->a.index -= to - from;
+}
+
+
+static void insertByte (struct INDATA *d, struct Echo *e, uint8_t val)
 {
     if (ARRAY_Full (&d->a))
     {
+        echoFlush (e);
         UART_PutMessage (d->uart, TEXT_INDATA_TOOLONG);
         d->status = INDATA_StatusInvalid;
-        return false;
+        return;
     }
-    return true;
+
+    memmove (&d->a.data[d->cursor + 1], &d->a.data[d->cursor],
+             d->a.index - d->cursor);
+    d->a.data[d->cursor ++] = val;
+    ++ d->a.index;
+
+    echoBytes (e, &val, 1);
+
+    // Bytes de continuacion que faltan para completar un caracter multibyte
+    if (val >= 0xF0)
+    {
+        d->utf8Pending = 3;
+    }
+    else if (val >= 0xE0)
+    {
+        d->utf8Pending = 2;
+    }
+    else if (val >= 0xC0)
+    {
+        d->utf8Pending = 1;
+    }
+    else if (val >= 0x80 && d->utf8Pending)
+    {
+        -- d->utf8Pending;
+    }
+    else
+    {
+        d->utf8Pending = 0;
+    }
+
+    // Lo que sigue al cursor se redibuja recien con el caracter completo
+    if (!d->utf8Pending && d->cursor < d->a.index)
+    {
+        redrawTail (d, e, 0);
+    }
+}
+
+
+static void backspace (struct INDATA *d, struct Echo *e)
+{
+    if (!d->cursor)
+    {
+        return;
+    }
+
+    if (d->cursor == d->a.index)
+    {
+        ARRAY_RemoveChars (&d->a, 1);
+        d->cursor = d->a.index;
+        echoString (e, TERM_CURSOR_LEFT(1) " " TERM_CURSOR_LEFT(1));
+        return;
+    }
+
+    const uint32_t Prev = prevChar (d, d->cursor);
+    removeBytes (d, Prev, d->cursor);
+    d->cursor = Prev;
+    echoString (e, TERM_CURSOR_LEFT(1));
+    redrawTail (d, e, 1);
+}
+
+
+static void deleteChar (struct INDATA *d, struct Echo *e)
+{
+    if (d->cursor == d->a.index)
+    {
+        return;
+    }
+
+    removeBytes (d, d->cursor, nextChar (d, d->cursor));
+    redrawTail (d, e, 1);
+}
+
+
+static void moveCursor (struct INDATA *d, struct Echo *e, uint32_t pos)
+{
+    if (pos < d->cursor)
+    {
+        echoCursor (e, countChars (d, pos, d->cursor), 'D');
+    }
+    else
+    {
+        echoCursor (e, countChars (d, d->cursor, pos), 'C');
+    }
+
+    d->cursor = pos;
 }
 
 
@@ -118,31 +349,89 @@ static void validate (struct INDATA *d)
 }
 
 
-static bool checkInteraction (struct INDATA *d, uint8_t val)
+// Secuencias de escape: ESC [ C / D (flechas), ESC [ H / F (inicio, fin),
+// ESC [ 3 ~ (suprimir). El resto se ignora.
+static void escape (struct INDATA *d, struct Echo *e, uint8_t val)
 {
+    if (d->escape == INDATA_EscapeStart)
+    {
+        d->escape = (val == '[')? INDATA_EscapeCsi : INDATA_EscapeNone;
+        return;
+    }
+
+    if (val >= '0' && val <= '9')
+    {
+        d->escapeParam = d->escapeParam * 10 + (val - '0');
+        return;
+    }
+
+    d->escape = INDATA_EscapeNone;
+
+    switch (val)
+    {
+        case 'C':
+            moveCursor (d, e, nextChar (d, d->cursor));
+            break;
+
+        case 'D':
+            moveCursor (d, e, prevChar (d, d->cursor));
+            break;
+
+        case 'H':
+            moveCursor (d, e, 0);
+            break;
+
+        case 'F':
+            moveCursor (d, e, d->a.index);
+            break;
+
+        case '~':
+            if (d->escapeParam == 3)
+            {
+                deleteChar (d, e);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+static void edit (struct INDATA *d, struct Echo *e, uint8_t val)
+{
+    if (d->escape != INDATA_EscapeNone)
+    {
+        escape (d, e, val);
+        return;
+    }
+
     switch (val)
     {
         case 0x0D:  // CR (Enter)
+            echoFlush (e);
             ARRAY_Terminate (&d->a);
             validate (d);
-            return false;
+            break;
 
+        case 0x08:  // BS
         case 0x7F:  // DEL (Backspace)
-            if (ARRAY_RemoveChars (&d->a, 1))
-            {
-                UART_PutMessage (d->uart, TERM_CURSOR_LEFT(1) " "
-                                 TERM_CURSOR_LEFT(1));
-            }
+            backspace (d, e);
+            break;
+
+        case 0x1B:  // ESC
+            d->escape       = INDATA_EscapeStart;
+            d->escapeParam  = 0;
             break;
 
         default:
-        {
-            ARRAY_Append    (&d->a, val);
-            UART_PutBinary  (d->uart, &val, 1);
+            // Otros caracteres de control no forman parte del dato
+            if (val >= 0x20)
+            {
+                insertByte (d, e, val);
+            }
             break;
-        }
     }
-    return true;
 }
 
 
@@ -153,15 +442,38 @@ bool INDATA_Prompt (struct INDATA *d)
         return false;
     }
 
+    struct Echo echo;
+    echo.uart = d->uart;
+    echo.size = 0;
+
     const uint32_t Pending = UART_RecvPendingCount (d->uart);
-    for (uint32_t i = 0; i < Pending; ++i)
+    uint32_t offset = 0;
+
+    // Edita directamente sobre las porciones contiguas del buffer de
+    // recepcion, hasta terminar o que el ingreso deje de estar en curso
+    while (d->status == INDATA_StatusPrompt && offset < Pending)
     {
-        if (!checkEndOfIndex    (d) ||
-            !checkInteraction   (d, UART_RecvPeek (d->uart, i)))
+        uint32_t size;
+        const uint8_t *span = UART_RecvPeekSpan (d->uart, offset, &size);
+        if (size > Pending - offset)
         {
-            break;
+            size = Pending - offset;
+        }
+
+        uint32_t i = 0;
+        while (d->status == INDATA_StatusPrompt && i < size)
+        {
+            edit (d, &echo, span[i ++]);
         }
+
+        offset += i;
     }
+
+    echoFlush (&echo);
+
+    // Consume solo lo editado: lo que sigue al Enter (o al dato invalido) y
+    // lo que llego por interrupcion queda para quien lo lea despues
+    UART_RecvDiscard (d->uart, offset);
     return true;
 }
 
@@ -34,10 +34,15 @@
 #include "term.h"
 #include "array.h"
 #include "indata.h"
+#include "password.h"
 #include "fsm.h"
 #include "fsm_util.h"
+#include "alarm.h"
 #include "btn.h"
 #include "copos.h"
+#include "copos_util.h"
+#include "coro.h"
+#include "swtimer.h"
 #include "systick.h"
 #include "text.h"
 #include "text_app.h"
@@ -74,20 +79,6 @@ Actividad
 */
 
 
-enum FSM_StateReturn FEMState_Desarmada (struct FEM *f,
-                                        enum FSM_Stage stage, uint32_t ticks);
-enum FSM_StateReturn FEMState_DiegoArmando (struct FEM *f,
-                                       enum FSM_Stage stage, uint32_t ticks);
-enum FSM_StateReturn FEMState_Armada (struct FEM *f,
-                                      enum FSM_Stage stage, uint32_t ticks);
-enum FSM_StateReturn FEMState_Intruso (struct FEM *f,
-                                       enum FSM_Stage stage, uint32_t ticks);
-enum FSM_StateReturn FEMState_Desarmando (struct FEM *f,
-                                          enum FSM_Stage stage, uint32_t ticks);
-
-
-#define     ARMING_PERIOD_MSEC      6000
-#define     DOOR_DISARMING_MSEC     6000
 #define     DOOR_DISARM_MAX_RETRIES 3
 
 #define     SENSOR_DOOR             0b0001
@@ -110,15 +101,19 @@ struct APP
     struct UART         uart;
     struct INDATA       indata;
     struct FEM          mainFem;
-    struct ARRAY        password;
-    uint8_t             passwordData    [INDATA_BUFFER_SIZE];
+    struct PASSWORD     password;
     bool                passwordInRequest;
-    bool                cancelRequest;
     uint32_t            disarmRetries;
     uint32_t            sensorStatus;
     uint32_t            ledStatus;
     uint32_t            tecDebounce     [4];
     struct VARIANT      vtmp;
+    uint32_t            processTask;
+    uint32_t            alarmTask;
+    struct CORO         passwordCoro;
+    // Reporte del comando 't', se envia por partes
+    sProfileReport_t    profile;
+    bool                profileInRequest;
 };
 
 
@@ -132,14 +127,24 @@ bool APP_Init (struct APP *a)
     memset (a, 0, sizeof(struct APP));
 
     UART_Init       (&a->uart, DEBUG_UART, 9600);
+    // uartRecvTask y uartSendTask quedan como respaldo del modo polled
+    UART_SetMode    (&a->uart, UART_ModeDma);
     INDATA_Init     (&a->indata, &a->uart);
-    ARRAY_Init      (&a->password, a->passwordData,
-                     sizeof(a->passwordData));
-    FSM_Init        (&a->mainFem, a);
-    FSM_ChangeState (&a->mainFem, FEMState_Desarmada);
+    // Falla si el lca de AlarmTable no coincide con los padres de los estados
+    if (!FSM_InitTable (&a->mainFem, &AlarmTable, APP_StateDesarmada, a))
+    {
+        return false;
+    }
 
-    // Password inicial
-    ARRAY_AppendString (&a->password, "1234");
+    // Password inicial si la EEPROM no tiene uno guardado
+    if (!PASSWORD_Load (&a->password))
+    {
+        struct ARRAY initial;
+        ARRAY_InitFromArena (&initial, PASSWORD_MAX_SIZE, ARRAY_FlagNone);
+        ARRAY_AppendString  (&initial, "1234");
+        PASSWORD_Set        (&a->password, &initial);
+        ARRAY_ReleaseToArena (&initial);
+    }
     return true;
 }
 
@@ -147,7 +152,7 @@ bool APP_Init (struct APP *a)
 void APP_ClearRequests (struct APP *a)
 {
     a->passwordInRequest  = false;
-    a->cancelRequest      = false;
+    CORO_Init (&a->passwordCoro);
 
     // Cancela cualquier pedido de input en progreso
     if (INDATA_Status(&a->indata) == INDATA_StatusPrompt)
@@ -173,42 +178,64 @@ bool APP_UpdateLed (struct APP *a, uint8_t led, bool on,
 }
 
 
+// Publica un evento en la MEF, fsmPostHook() adelanta alarmFEMTask
+void APP_Post (struct APP *a, enum APP_Event event)
+{
+    FSM_Post (&a->mainFem, event);
+}
+
+
+void APP_PostSensorEvent (struct APP *a)
+{
+    // Discrimina cual sensor se activo
+    if (a->sensorStatus & ~SENSOR_DOOR)
+    {
+        APP_Post (a, APP_EventSensorWindow);
+    }
+    else if (a->sensorStatus & SENSOR_DOOR)
+    {
+        APP_Post (a, APP_EventSensorDoor);
+    }
+}
+
+
+// Corrutina: uartProcessTask la llama mientras el estado atiende el password,
+// hasta que retorna Match o AskAgain. APP_ClearRequests() la vuelve al
+// principio.
 enum APP_PasswordLogicAction APP_PasswordLogic (struct APP *a)
 {
     struct UART   *uart   = (struct UART *)   &a->uart;
     struct INDATA *indata = (struct INDATA *) &a->indata;
+    struct CORO   *c      = (struct CORO *)   &a->passwordCoro;
 
-    switch (INDATA_Status(indata))
-    {
-        // No entrando datos
-        case INDATA_StatusDisabled:
-        default:
-            if (a->passwordInRequest)
-            {
-                // Se pidio ingresar password
-                APP_ClearRequests   (a);
-                UART_PutMessage     (uart, TEXT_PASSWORDINPUT);
-                //  9)  Cuando se esté esperando que el usuario ingrese una
-                //      contraseña se debe encender el led RGB azul.
-                APP_UpdateLed       (a, LED_BLUE, true, false);
-                INDATA_Begin        (indata, INDATA_TypeAlphanum);
-                return APP_PasswordLogicAction_Asking;
-            }
-            return APP_PasswordLogicAction_None;
+    CORO_BEGIN (c);
+
+    // Espera que se pida ingresar password
+    CORO_AWAIT (c, a->passwordInRequest, APP_PasswordLogicAction_None);
 
-        // Aun se esta ingresando
-        case INDATA_StatusPrompt:
-            return APP_PasswordLogicAction_None;
+    APP_ClearRequests   (a);
+    UART_PutMessage     (uart, TEXT_PASSWORDINPUT);
+    //  9)  Cuando se esté esperando que el usuario ingrese una
+    //      contraseña se debe encender el led RGB azul.
+    APP_UpdateLed       (a, LED_BLUE, true, false);
+    INDATA_Begin        (indata, INDATA_TypeAlphanum);
+    CORO_YIELD (c, APP_PasswordLogicAction_Asking);
 
+    // Aun se esta ingresando
+    CORO_AWAIT (c, INDATA_Status(indata) != INDATA_StatusPrompt,
+                APP_PasswordLogicAction_None);
+
+    switch (INDATA_Status(indata))
+    {
         // Datos disponibles
         case INDATA_StatusReady:
             UART_PutMessage (uart, TEXT_CHECKINGPASSWORD);
-            if (ARRAY_CheckEqualContents (&a->password, INDATA_Data(indata)))
+            if (PASSWORD_Check (&a->password, INDATA_Data(indata)))
             {
                 UART_PutMessage (uart, TEXT_PASSWORDMATCH);
                 INDATA_End      (indata);
                 APP_UpdateLed   (a, LED_BLUE, false, false);
-                return APP_PasswordLogicAction_Match;
+                CORO_RESTART    (c, APP_PasswordLogicAction_Match);
             }
             UART_PutMessage (uart, TEXT_WRONGPASSWORD);
             break;
@@ -217,274 +244,180 @@ enum APP_PasswordLogicAction APP_PasswordLogic (struct APP *a)
         case INDATA_StatusInvalid:
             UART_PutMessage (uart, TEXT_INVALIDPASSWORD);
             break;
+
+        // Ingreso cancelado
+        default:
+            CORO_RESTART (c, APP_PasswordLogicAction_None);
     }
 
     INDATA_End      (indata);
     APP_UpdateLed   (a, LED_BLUE, false, false);
-    return APP_PasswordLogicAction_AskAgain;
+    CORO_END (c, APP_PasswordLogicAction_AskAgain);
 }
 
 
-enum FSM_StateReturn FEMState_Desarmada (struct FEM *f,
-                                        enum FSM_Stage stage, uint32_t ticks)
+// Corre la logica de password si el estado actual la atiende y publica el
+// resultado como evento.
+void APP_PostPasswordEvent (struct APP *a)
 {
-    FSM_SetStateInfo (f, __FUNCTION__);
-
-    struct APP  *app  = (struct APP *)  f->app;
-    struct UART *uart = (struct UART *) &app->uart;
+    if (!FSM_Handles (&a->mainFem, APP_EventPasswordMatch))
+    {
+        return;
+    }
 
-    switch (stage)
+    switch (APP_PasswordLogic (a))
     {
-        case FSM_StageBegin:
-            APP_ClearRequests   (app);
-            //  6)  Cuando la alarma esté desarmada se debe encender el led RGB
-            //      verde fijo.
-            APP_UpdateLed       (app, LED_GREEN, true, false);
-            UART_PutMessage     (uart, TEXT_PASSWORDTOARM);
-            FSM_GotoStage       (f, FSM_StageMain);
+        case APP_PasswordLogicAction_Asking:
+            APP_Post (a, APP_EventPasswordAsking);
             break;
 
-        case FSM_StageMain:
-        {
-            const enum APP_PasswordLogicAction Pl = APP_PasswordLogic (app);
-            if (Pl == APP_PasswordLogicAction_Asking)
-            {
-                APP_UpdateLed       (app, LED_GREEN, false, false);
-            }
-            else if (Pl == APP_PasswordLogicAction_AskAgain)
-            {
-                FSM_GotoStage       (f, FSM_StageBegin);
-            }
-            else if (Pl == APP_PasswordLogicAction_Match)
-            {
-                FSM_ChangeState     (f, FEMState_DiegoArmando);
-            }
+        case APP_PasswordLogicAction_AskAgain:
+            APP_Post (a, APP_EventPasswordAskAgain);
             break;
-        }
 
-        case FSM_StageEnd:
+        case APP_PasswordLogicAction_Match:
+            APP_Post (a, APP_EventPasswordMatch);
             break;
-    }
 
-    return FSM_StateReturnYield;
+        default:
+            break;
+    }
 }
 
 
-enum FSM_StateReturn FEMState_DiegoArmando (struct FEM *f,
-                                       enum FSM_Stage stage, uint32_t ticks)
+static struct APP * appOf (struct FEM *f)
 {
-    FSM_SetStateInfo (f, __FUNCTION__);
+    return (struct APP *) f->app;
+}
 
-    struct APP  *app  = (struct APP *)  f->app;
-    struct UART *uart = (struct UART *) &app->uart;
 
-    switch (stage)
-    {
-        case FSM_StageBegin:
-            APP_ClearRequests   (app);
-            VARIANT_SetUint32   (&app->vtmp, ARMING_PERIOD_MSEC / 1000);
-            UART_PutMessageArgs (uart, TEXT_ALARMARMINGBEGIN,
-                                 &app->vtmp, 1);
-            APP_UpdateLed       (app, LED_GREEN, true, true);
-            FSM_GotoStage       (f, FSM_StageMain);
-            break;
+void FEMState_DesarmadaEntry (struct FEM *f)
+{
+    struct APP *app = appOf (f);
 
-        case FSM_StageMain:
-            if (app->cancelRequest)
-            {
-                APP_ClearRequests   (app);
-                UART_PutMessage     (uart, TEXT_ALARMARMINGCANCELLED);
-                FSM_ChangeState     (f, FEMState_Desarmada);
-            }
-            else if (FSM_StageTimeout (f, ARMING_PERIOD_MSEC))
-            {
-                FSM_GotoStage (f, FSM_StageEnd);
-            }
-            break;
+    APP_ClearRequests   (app);
+    //  6)  Cuando la alarma esté desarmada se debe encender el led RGB
+    //      verde fijo.
+    APP_UpdateLed       (app, LED_GREEN, true, false);
+    UART_PutMessage     (&app->uart, TEXT_PASSWORDTOARM);
+}
 
-        case FSM_StageEnd:
-            UART_PutMessage     (uart, TEXT_ALARMARMINGEND);
-            APP_UpdateLed       (app, LED_GREEN, false, false);
-            FSM_ChangeState     (f, FEMState_Armada);
-            break;
-    }
 
-    return FSM_StateReturnYield;
+void FEMState_DiegoArmandoEntry (struct FEM *f)
+{
+    struct APP *app = appOf (f);
+
+    APP_ClearRequests   (app);
+    VARIANT_SetUint32   (&app->vtmp, ARMING_PERIOD_MSEC / 1000);
+    UART_PutMessageArgs (&app->uart, TEXT_ALARMARMINGBEGIN, &app->vtmp, 1);
+    APP_UpdateLed       (app, LED_GREEN, true, true);
 }
 
 
-enum FSM_StateReturn FEMState_Armada (struct FEM *f,
-                                      enum FSM_Stage stage, uint32_t ticks)
+void FEMState_DiegoArmandoCancel (struct FEM *f)
 {
-    FSM_SetStateInfo (f, __FUNCTION__);
+    struct APP *app = appOf (f);
 
-    struct APP  *app  = (struct APP *)  f->app;
-    struct UART *uart = (struct UART *) &app->uart;
+    APP_ClearRequests   (app);
+    UART_PutMessage     (&app->uart, TEXT_ALARMARMINGCANCELLED);
+}
 
-    switch (stage)
-    {
-        case FSM_StageBegin:
-            APP_ClearRequests   (app);
-            UART_PutMessage     (uart, TEXT_ARMEDPASSWORDTODISARM);
-            //  7)  Cuando la alarma esté armada se debe encender el led RGB
-            //      rojo fijo
-            APP_UpdateLed       (app, LED_RED, true, false);
-            FSM_GotoStage       (f, FSM_StageMain);
-            break;
 
-        case FSM_StageMain:
-        {
-            // Se activo un sensor?
-            if (app->sensorStatus)
-            {
-                FSM_GotoStage   (f, FSM_StageEnd);
-                return FSM_StateReturnAgain;
-            }
+void FEMState_DiegoArmandoTimeout (struct FEM *f)
+{
+    struct APP *app = appOf (f);
 
-            const enum APP_PasswordLogicAction Pl = APP_PasswordLogic (app);
-            if (Pl == APP_PasswordLogicAction_Asking)
-            {
-                APP_UpdateLed   (app, LED_RED, false, false);
-            }
-            else if (Pl == APP_PasswordLogicAction_AskAgain)
-            {
-                FSM_GotoStage   (f, FSM_StageBegin);
-            }
-            else if (Pl == APP_PasswordLogicAction_Match)
-            {
-                FSM_ChangeState (f, FEMState_Desarmada);
-            }
-            break;
-        }
+    UART_PutMessage     (&app->uart, TEXT_ALARMARMINGEND);
+    APP_UpdateLed       (app, LED_GREEN, false, false);
+}
 
-        case FSM_StageEnd:
-            // Discrimina cual sensor se activo
-            if (app->sensorStatus & ~SENSOR_DOOR)
-            {
-               UART_PutMessage  (uart, TEXT_SENSORWINDOW);
-               FSM_ChangeState  (f, FEMState_Intruso);
-            }
-            else if (app->sensorStatus & SENSOR_DOOR)
-            {
-               UART_PutMessage  (uart, TEXT_SENSORDOOR);
-               FSM_ChangeState  (f, FEMState_Desarmando);
-            }
 
-            APP_UpdateLed (app, LED_RED, false, false);
-            break;
-    }
+void FEMState_ArmadaEntry (struct FEM *f)
+{
+    struct APP *app = appOf (f);
+
+    APP_ClearRequests   (app);
+    UART_PutMessage     (&app->uart, TEXT_ARMEDPASSWORDTODISARM);
+    //  7)  Cuando la alarma esté armada se debe encender el led RGB
+    //      rojo fijo
+    APP_UpdateLed       (app, LED_RED, true, false);
+    // Un sensor que ya estaba activo dispara la alarma al armarla
+    APP_PostSensorEvent (app);
+}
 
-    return FSM_StateReturnYield;
+
+void FEMState_ArmadaExit (struct FEM *f)
+{
+    APP_UpdateLed (appOf(f), LED_RED, false, false);
 }
 
 
-enum FSM_StateReturn FEMState_Intruso (struct FEM *f,
-                                        enum FSM_Stage stage, uint32_t ticks)
+void FEMState_ArmadaSensorWindow (struct FEM *f)
 {
-    FSM_SetStateInfo (f, __FUNCTION__);
+    UART_PutMessage (&appOf(f)->uart, TEXT_SENSORWINDOW);
+}
 
-    struct APP  *app  = (struct APP *)  f->app;
-    struct UART *uart = (struct UART *) &app->uart;
 
-    switch (stage)
-    {
-        case FSM_StageBegin:
-            APP_ClearRequests   (app);
-            UART_PutMessage     (uart, TEXT_INTRUDERPASSWORDTODISARM);
-            //  8)  Cuando la alarma esté disparada (intruso) se debe parpadear
-            //      el led RGB rojo.
-            APP_UpdateLed       (app, LED_RED, true, true);
-            FSM_GotoStage       (f, FSM_StageMain);
-            break;
+void FEMState_ArmadaSensorDoor (struct FEM *f)
+{
+    UART_PutMessage (&appOf(f)->uart, TEXT_SENSORDOOR);
+}
 
-        case FSM_StageMain:
-        {
-            const enum APP_PasswordLogicAction Pl = APP_PasswordLogic (app);
-            if (Pl == APP_PasswordLogicAction_Asking)
-            {
-                APP_UpdateLed   (app, LED_RED, false, false);
-            }
-            else if (Pl == APP_PasswordLogicAction_AskAgain)
-            {
-                FSM_GotoStage   (f, FSM_StageBegin);
-            }
-            else if (Pl == APP_PasswordLogicAction_Match)
-            {
-                FSM_ChangeState (f, FEMState_Desarmada);
-            }
-            break;
-        }
 
-        case FSM_StageEnd:
-            break;
-    }
+void FEMState_IntrusoEntry (struct FEM *f)
+{
+    struct APP *app = appOf (f);
 
-    return FSM_StateReturnYield;
+    APP_ClearRequests   (app);
+    UART_PutMessage     (&app->uart, TEXT_INTRUDERPASSWORDTODISARM);
+    //  8)  Cuando la alarma esté disparada (intruso) se debe parpadear
+    //      el led RGB rojo.
+    APP_UpdateLed       (app, LED_RED, true, true);
 }
 
 
-enum FSM_StateReturn FEMState_Desarmando (struct FEM *f, enum FSM_Stage stage,
-                                          uint32_t ticks)
+// El led azul de ingreso de password reemplaza al del estado
+void FEMState_PasswordAsking (struct FEM *f)
 {
-    FSM_SetStateInfo (f, __FUNCTION__);
+    struct APP *app = appOf (f);
 
-    struct APP  *app  = (struct APP *)  f->app;
-    struct UART *uart = (struct UART *) &app->uart;
+    APP_UpdateLed (app, LED_GREEN, false, false);
+    APP_UpdateLed (app, LED_RED, false, false);
+}
 
-    switch (stage)
-    {
-        case FSM_StageBegin:
-            app->disarmRetries = 0;
-            APP_ClearRequests   (app);
-            FSM_StateCountdown  (f, DOOR_DISARMING_MSEC);
-            VARIANT_SetUint32   (&app->vtmp, FSM_StateCountdownSeconds(f));
-            UART_PutMessageArgs (uart, TEXT_DOORPASSWORDTODISARM,
-                                 &app->vtmp, 1);
-            APP_UpdateLed       (app, LED_RED, true, false);
-            FSM_GotoStage       (f, FSM_StageMain);
-            return FSM_StateReturnAgain;
-
-        case FSM_StageMain:
-            if (FSM_StateCountdown (f, 0))
-            {
-                FSM_ChangeState (f, FEMState_Intruso);
-                return FSM_StateReturnYield;
-            }
 
-            const enum APP_PasswordLogicAction Pl = APP_PasswordLogic (app);
-            if (Pl == APP_PasswordLogicAction_Asking)
-            {
-                APP_UpdateLed       (app, LED_RED, false, false);
-            }
-            else if (Pl == APP_PasswordLogicAction_AskAgain)
-            {
-                if (++ app->disarmRetries >= DOOR_DISARM_MAX_RETRIES)
-                {
-                    FSM_ChangeState (f, FEMState_Intruso);
-                    return FSM_StateReturnYield;
-                }
-                // Reintenta
-                APP_UpdateLed       (app, LED_RED, true, false);
-                VARIANT_SetUint32   (&app->vtmp, DOOR_DISARM_MAX_RETRIES -
-                                     app->disarmRetries);
-                UART_PutMessageArgs (uart, TEXT_DOORPASSWORDTODISARMAGAIN,
-                                     &app->vtmp, 1);
-                VARIANT_SetUint32   (&app->vtmp,
-                                     FSM_StateCountdownSeconds(f));
-                UART_PutMessageArgs (uart, TEXT_DOORPASSWORDTODISARM,
-                                     &app->vtmp, 1);
-            }
-            else if (Pl == APP_PasswordLogicAction_Match)
-            {
-                FSM_ChangeState     (f, FEMState_DiegoArmando);
-            }
-            break;
+void FEMState_DesarmandoEntry (struct FEM *f)
+{
+    struct APP *app = appOf (f);
+
+    app->disarmRetries = 0;
+    APP_ClearRequests   (app);
+    VARIANT_SetUint32   (&app->vtmp, FSM_StateCountdownSeconds(f));
+    UART_PutMessageArgs (&app->uart, TEXT_DOORPASSWORDTODISARM,
+                         &app->vtmp, 1);
+    APP_UpdateLed       (app, LED_RED, true, false);
+}
 
-        case FSM_StageEnd:
-            break;
+
+void FEMState_DesarmandoAskAgain (struct FEM *f)
+{
+    struct APP  *app  = appOf (f);
+    struct UART *uart = &app->uart;
+
+    if (++ app->disarmRetries >= DOOR_DISARM_MAX_RETRIES)
+    {
+        FSM_Dispatch (f, APP_EventRetriesExhausted);
+        return;
     }
 
-    return FSM_StateReturnYield;
+    // Reintenta
+    APP_UpdateLed       (app, LED_RED, true, false);
+    VARIANT_SetUint32   (&app->vtmp, DOOR_DISARM_MAX_RETRIES -
+                         app->disarmRetries);
+    UART_PutMessageArgs (uart, TEXT_DOORPASSWORDTODISARMAGAIN,
+                         &app->vtmp, 1);
+    VARIANT_SetUint32   (&app->vtmp, FSM_StateCountdownSeconds(f));
+    UART_PutMessageArgs (uart, TEXT_DOORPASSWORDTODISARM, &app->vtmp, 1);
 }
 
 
@@ -513,13 +446,17 @@ static void processCommand (struct APP *a)
         return;
     }
 
+    const uint8_t Command = UART_RecvPeek (uart, 0);
+
+    // Consume solo lo revisado, pueden haber llegado datos por interrupcion
+    UART_RecvDiscard (uart, Pending);
+
     if (Pending != 1)
     {
         UART_PutMessage (uart, TEXT_WRONGCOMMANDSIZE);
         return;
     }
 
-    const uint8_t Command = UART_RecvPeek (uart, 0);
     switch (Command)
     {
         case 'i':
@@ -531,7 +468,7 @@ static void processCommand (struct APP *a)
             break;
 
         case 'x':
-            a->cancelRequest = true;
+            APP_Post (a, APP_EventCancel);
             break;
 
         case 's':
@@ -542,6 +479,12 @@ static void processCommand (struct APP *a)
             FSM_PutStatusMessage (&a->mainFem, uart);
             break;
 
+        case 't':
+            // Mas largo que el buffer de envio: uartProcessTask lo completa
+            memset (&a->profile, 0, sizeof(sProfileReport_t));
+            a->profileInRequest = true;
+            break;
+
         case 'c':
             UART_PutMessage (uart, TERM_CLEAR_SCREEN);
             break;
@@ -566,8 +509,16 @@ void uartProcessTask (void *ctx, uint32_t ticks)
         processCommand (app);
     }
 
-    // uartProcessTask siempre debe consumir todos los datos disponibles
-    UART_RecvDiscardPending (&app->uart);
+    APP_PostPasswordEvent (app);
+
+    if (app->profileInRequest)
+    {
+        app->profileInRequest = schedulerPutProfileMessage (&app->uart,
+                                                            &app->profile);
+    }
+
+    // INDATA_Prompt() y processCommand() consumen todos los datos que
+    // revisan; lo recibido mientras tanto queda para la proxima llamada.
 }
 
 
@@ -609,6 +560,8 @@ void debounceTecTask (void *ctx, uint32_t ticks)
             {
                 app->sensorStatus |= (1 << i);
             }
+
+            APP_PostSensorEvent (app);
         }
     }
 }
@@ -625,6 +578,8 @@ void sensorOutputsTask (void *ctx, uint32_t ticks)
 }
 
 
+// Atiende los eventos publicados, incluidos los timeouts de estado. La corre
+// el periodo o schedulerSignalTask() desde fsmPostHook().
 void alarmFEMTask (void *ctx, uint32_t ticks)
 {
     struct APP *app = (struct APP *) ctx;
@@ -632,6 +587,22 @@ void alarmFEMTask (void *ctx, uint32_t ticks)
 }
 
 
+void fsmPostHook (void *ctx)
+{
+    struct APP *app = (struct APP *) ctx;
+    schedulerSignalTask (app->alarmTask);
+}
+
+
+// Llamada desde la ISR de UART: procesa lo recibido sin esperar el periodo
+// de uartProcessTask, que queda como respaldo.
+void uartRecvHook (void *ctx)
+{
+    struct APP *app = (struct APP *) ctx;
+    schedulerSignalTask (app->processTask);
+}
+
+
 int main (void)
 {
     Board_Init_Fixed ();
@@ -643,13 +614,38 @@ int main (void)
     UART_RecvInjectByte (&app.uart, 'i');
 
     schedulerInit       ();
+    // Reparte las tareas periodicas para que no coincidan en el mismo tick.
+    // Cada alta revisa hiperperiodo * tareas, hasta
+    // SCHEDULER_ANALYSIS_MAX_CHECKS: 253232 en total para estas siete (ver
+    // copos.h).
+    schedulerSetAutoOffset      (true);
+    const uint32_t RecvTask =
     schedulerAddTask    (uartRecvTask       ,&app.uart  ,0  ,14);
+    const uint32_t SendTask =
     schedulerAddTask    (uartSendTask       ,&app.uart  ,0  ,16);
+    app.processTask =
     schedulerAddTask    (uartProcessTask    ,&app       ,0  ,140);
     schedulerAddTask    (ledUpdateTask      ,&app       ,1  ,500);
+    const uint32_t DebounceTask =
     schedulerAddTask    (debounceTecTask    ,&app       ,1  ,20);
     schedulerAddTask    (sensorOutputsTask  ,&app       ,1  ,20);
+    app.alarmTask =
     schedulerAddTask    (alarmFEMTask       ,&app       ,0  ,50);
+
+    // Recepcion y envio por UART antes que el resto de las tareas, para no
+    // perder bytes del FIFO detras de un uartProcessTask largo.
+    schedulerSetTaskPriority    (RecvTask, 2);
+    schedulerSetTaskPriority    (SendTask, 1);
+    // uartSendTask solo reinicia la transmision por DMA, repetirla no sirve.
+    // Una corrida atrasada del antirebote mide mal el tiempo, se descarta.
+    schedulerSetTaskOverrunPolicy (SendTask, SCHEDULER_OVERRUN_COALESCE);
+    schedulerSetTaskOverrunPolicy (DebounceTask, SCHEDULER_OVERRUN_SKIP);
+    schedulerSetDispatchPolicy  (SCHEDULER_DISPATCH_PRIORITY);
+    UART_SetRecvHook            (&app.uart, uartRecvHook, &app);
+    FSM_SetPostHook             (&app.mainFem, fsmPostHook, &app);
+    // Los timers (timeouts de la MEF) vencen desde el dispatcher, que duerme
+    // solo hasta el proximo
+    schedulerSetTimerService    (SWTIMER_Process, SWTIMER_TicksToNext);
     schedulerStart      (1);
 
     while (1)
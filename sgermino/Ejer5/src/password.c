@@ -0,0 +1,251 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "password.h"
+#include "systick.h"
+#include "chip.h"
+#include <stddef.h>
+#include <string.h>
+
+
+#define RECORD_MAGIC    0x31445750  // "PWD1"
+
+
+// Registro en EEPROM, se escribe y lee de a palabras de 32 bits
+struct Record
+{
+    uint32_t        magic;
+    struct PASSWORD password;
+    uint32_t        check;
+};
+
+
+static bool g_eepromInit = false;
+static bool g_iapInit    = false;
+
+
+static void eepromInit ()
+{
+    if (!g_eepromInit)
+    {
+        Chip_EEPROM_Init        (LPC_EEPROM);
+        Chip_EEPROM_SetAutoProg (LPC_EEPROM, EEPROM_AUTOPROG_OFF);
+        g_eepromInit = true;
+    }
+}
+
+
+// Los comandos IAP (como leer el ID del chip) requieren Chip_IAP_init()
+static bool iapInit ()
+{
+    if (!g_iapInit)
+    {
+        g_iapInit = (Chip_IAP_init () == IAP_CMD_SUCCESS);
+    }
+    return g_iapInit;
+}
+
+
+static void recordRead (struct Record *r)
+{
+    eepromInit ();
+
+    const volatile uint32_t *src = (const volatile uint32_t *)
+                                   EEPROM_ADDRESS(PASSWORD_EEPROM_PAGE, 0);
+    uint32_t *dst = (uint32_t *) r;
+
+    for (uint32_t i = 0; i < sizeof(struct Record) / 4; ++i)
+    {
+        dst[i] = src[i];
+    }
+}
+
+
+static void recordWrite (const struct Record *r)
+{
+    eepromInit ();
+
+    volatile uint32_t *dst = (volatile uint32_t *)
+                             EEPROM_ADDRESS(PASSWORD_EEPROM_PAGE, 0);
+    const uint32_t *src = (const uint32_t *) r;
+
+    // Se carga el registro de pagina y se programa de una vez
+    for (uint32_t i = 0; i < sizeof(struct Record) / 4; ++i)
+    {
+        dst[i] = src[i];
+    }
+
+    Chip_EEPROM_EraseProgramPage (LPC_EEPROM);
+}
+
+
+// Si IAP falla el ID queda en 0: la sal sigue mezclando el tiempo y la sal
+// anterior
+static void deviceId (uint32_t uid[4])
+{
+    if (!iapInit () || Chip_IAP_ReadUID (uid) != IAP_CMD_SUCCESS)
+    {
+        memset (uid, 0, sizeof(uint32_t) * 4);
+    }
+}
+
+
+#ifdef __arm__
+static uint32_t entropy ()
+{
+    return DWT->CYCCNT;
+}
+#else
+// Fuera del target no hay contador de ciclos: alcanza con la pila
+static uint32_t entropy ()
+{
+    uint32_t here;
+    return (uint32_t)(uintptr_t) &here;
+}
+#endif
+
+
+static uint32_t recordCheck (const struct Record *r)
+{
+    struct SHA256 s;
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    uint32_t check;
+
+    SHA256_Init     (&s);
+    SHA256_Update   (&s, (const uint8_t *) r,
+                     offsetof(struct Record, check));
+    SHA256_Final    (&s, digest);
+
+    memcpy (&check, digest, sizeof(check));
+    return check;
+}
+
+
+static void hashPassword (const uint8_t salt[PASSWORD_SALT_SIZE],
+                          struct ARRAY *plain,
+                          uint8_t hash[SHA256_DIGEST_SIZE])
+{
+    struct SHA256 s;
+
+    SHA256_Init     (&s);
+    SHA256_Update   (&s, salt, PASSWORD_SALT_SIZE);
+    SHA256_Update   (&s, plain->data, plain->index);
+    SHA256_Final    (&s, hash);
+
+    for (uint32_t i = 0; i < PASSWORD_HASH_ROUNDS; ++i)
+    {
+        SHA256_Init     (&s);
+        SHA256_Update   (&s, hash, SHA256_DIGEST_SIZE);
+        SHA256_Update   (&s, salt, PASSWORD_SALT_SIZE);
+        SHA256_Final    (&s, hash);
+    }
+}
+
+
+// La sal solo necesita ser unica: mezcla el ID del chip, la sal anterior y
+// el momento en que se cambia el password
+static void makeSalt (struct PASSWORD *p)
+{
+    struct SHA256 s;
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    uint32_t mix[6];
+
+    deviceId (mix);
+    mix[4] = SYSTICK_Now ();
+    mix[5] = entropy ();
+
+    SHA256_Init     (&s);
+    SHA256_Update   (&s, (const uint8_t *) mix, sizeof(mix));
+    SHA256_Update   (&s, p->salt, sizeof(p->salt));
+    SHA256_Final    (&s, digest);
+
+    memcpy (p->salt, digest, sizeof(p->salt));
+}
+
+
+bool PASSWORD_Load (struct PASSWORD *p)
+{
+    if (!p)
+    {
+        return false;
+    }
+
+    struct Record r;
+    recordRead (&r);
+
+    if (r.magic != RECORD_MAGIC || r.check != recordCheck (&r))
+    {
+        return false;
+    }
+
+    memcpy (p, &r.password, sizeof(struct PASSWORD));
+    return true;
+}
+
+
+bool PASSWORD_Set (struct PASSWORD *p, struct ARRAY *plain)
+{
+    if (!p || !plain || plain->index > PASSWORD_MAX_SIZE)
+    {
+        return false;
+    }
+
+    makeSalt        (p);
+    hashPassword    (p->salt, plain, p->hash);
+
+    struct Record r;
+    r.magic     = RECORD_MAGIC;
+    r.password  = *p;
+    r.check     = recordCheck (&r);
+
+    recordWrite (&r);
+    return true;
+}
+
+
+bool PASSWORD_Check (struct PASSWORD *p, struct ARRAY *plain)
+{
+    if (!p || !plain || plain->index > PASSWORD_MAX_SIZE)
+    {
+        return false;
+    }
+
+    uint8_t hash[SHA256_DIGEST_SIZE];
+    hashPassword (p->salt, plain, hash);
+
+    struct ARRAY computed;
+    struct ARRAY stored;
+    ARRAY_InitFlags (&computed, hash, sizeof(hash), ARRAY_FlagNone);
+    ARRAY_InitFlags (&stored, p->hash, sizeof(p->hash), ARRAY_FlagNone);
+    computed.index  = sizeof(hash);
+    stored.index    = sizeof(p->hash);
+
+    return ARRAY_CheckEqualContentsConstTime (&computed, &stored);
+}
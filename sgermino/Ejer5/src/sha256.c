@@ -0,0 +1,208 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "sha256.h"
+#include <string.h>
+
+
+// FIPS 180-4
+static const uint32_t K[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+
+static uint32_t ror (uint32_t x, uint32_t n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+
+static void transform (struct SHA256 *s, const uint8_t *block)
+{
+    uint32_t w[64];
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        w[i] = (uint32_t)block[i * 4 + 0] << 24 |
+               (uint32_t)block[i * 4 + 1] << 16 |
+               (uint32_t)block[i * 4 + 2] << 8  |
+               (uint32_t)block[i * 4 + 3];
+    }
+
+    for (uint32_t i = 16; i < 64; ++i)
+    {
+        const uint32_t S0 = ror(w[i - 15], 7) ^ ror(w[i - 15], 18) ^
+                            (w[i - 15] >> 3);
+        const uint32_t S1 = ror(w[i - 2], 17) ^ ror(w[i - 2], 19) ^
+                            (w[i - 2] >> 10);
+        w[i] = w[i - 16] + S0 + w[i - 7] + S1;
+    }
+
+    uint32_t a = s->state[0], b = s->state[1], c = s->state[2],
+             d = s->state[3], e = s->state[4], f = s->state[5],
+             g = s->state[6], h = s->state[7];
+
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        const uint32_t S1 = ror(e, 6) ^ ror(e, 11) ^ ror(e, 25);
+        const uint32_t Ch = (e & f) ^ (~e & g);
+        const uint32_t T1 = h + S1 + Ch + K[i] + w[i];
+        const uint32_t S0 = ror(a, 2) ^ ror(a, 13) ^ ror(a, 22);
+        const uint32_t Maj = (a & b) ^ (a & c) ^ (b & c);
+        const uint32_t T2 = S0 + Maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + T1;
+        d = c;
+        c = b;
+        b = a;
+        a = T1 + T2;
+    }
+
+    s->state[0] += a;
+    s->state[1] += b;
+    s->state[2] += c;
+    s->state[3] += d;
+    s->state[4] += e;
+    s->state[5] += f;
+    s->state[6] += g;
+    s->state[7] += h;
+}
+
+
+bool SHA256_Init (struct SHA256 *s)
+{
+    if (!s)
+    {
+        return false;
+    }
+
+    memset (s, 0, sizeof(struct SHA256));
+
+    s->state[0] = 0x6a09e667;
+    s->state[1] = 0xbb67ae85;
+    s->state[2] = 0x3c6ef372;
+    s->state[3] = 0xa54ff53a;
+    s->state[4] = 0x510e527f;
+    s->state[5] = 0x9b05688c;
+    s->state[6] = 0x1f83d9ab;
+    s->state[7] = 0x5be0cd19;
+    return true;
+}
+
+
+bool SHA256_Update (struct SHA256 *s, const uint8_t *data, uint32_t size)
+{
+    if (!s || (!data && size))
+    {
+        return false;
+    }
+
+    s->totalSize += size;
+
+    while (size)
+    {
+        uint32_t count = SHA256_BLOCK_SIZE - s->blockSize;
+        if (count > size)
+        {
+            count = size;
+        }
+
+        memcpy (&s->block[s->blockSize], data, count);
+        s->blockSize += count;
+        data         += count;
+        size         -= count;
+
+        if (s->blockSize == SHA256_BLOCK_SIZE)
+        {
+            transform (s, s->block);
+            s->blockSize = 0;
+        }
+    }
+
+    return true;
+}
+
+
+bool SHA256_Final (struct SHA256 *s, uint8_t digest[SHA256_DIGEST_SIZE])
+{
+    if (!s || !digest)
+    {
+        return false;
+    }
+
+    const uint64_t Bits = s->totalSize * 8;
+
+    // Relleno: 0x80, ceros y el largo en bits (big endian) al final del
+    // ultimo bloque
+    s->block[s->blockSize ++] = 0x80;
+    if (s->blockSize > SHA256_BLOCK_SIZE - 8)
+    {
+        memset (&s->block[s->blockSize], 0,
+                SHA256_BLOCK_SIZE - s->blockSize);
+        transform (s, s->block);
+        s->blockSize = 0;
+    }
+
+    memset (&s->block[s->blockSize], 0,
+            SHA256_BLOCK_SIZE - 8 - s->blockSize);
+
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        s->block[SHA256_BLOCK_SIZE - 1 - i] = (uint8_t)(Bits >> (i * 8));
+    }
+
+    transform (s, s->block);
+
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        digest[i * 4 + 0] = (uint8_t)(s->state[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(s->state[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(s->state[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)(s->state[i]);
+    }
+
+    // No deja rastros del dato en el contexto
+    memset (s, 0, sizeof(struct SHA256));
+    return true;
+}
@@ -0,0 +1,156 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "swtimer.h"
+#include <string.h>
+
+
+static struct SWTIMER *timers = NULL;
+
+
+// Vencio deadline en now?
+static bool expired (uint32_t deadline, uint32_t now)
+{
+    return ((int32_t)(now - deadline) >= 0);
+}
+
+
+static void removeTimer (struct SWTIMER *t)
+{
+    for (struct SWTIMER **p = &timers; *p; p = &(*p)->next)
+    {
+        if (*p == t)
+        {
+            *p = t->next;
+            break;
+        }
+    }
+
+    t->next     = NULL;
+    t->active   = false;
+}
+
+
+bool SWTIMER_Init (struct SWTIMER *t, SWTIMER_Func func, void *ctx)
+{
+    if (!t || !func)
+    {
+        return false;
+    }
+
+    memset (t, 0, sizeof(struct SWTIMER));
+    t->func = func;
+    t->ctx  = ctx;
+    return true;
+}
+
+
+bool SWTIMER_Start (struct SWTIMER *t, uint32_t now, uint32_t ticks)
+{
+    if (!t || !t->func)
+    {
+        return false;
+    }
+
+    if (t->active)
+    {
+        removeTimer (t);
+    }
+
+    t->deadline = now + ticks;
+    t->active   = true;
+
+    // Detras de los que vencen antes o al mismo tiempo: mismo orden de
+    // disparo que de inicio
+    struct SWTIMER **p = &timers;
+    while (*p && (int32_t)((*p)->deadline - t->deadline) <= 0)
+    {
+        p = &(*p)->next;
+    }
+
+    t->next = *p;
+    *p      = t;
+    return true;
+}
+
+
+bool SWTIMER_Stop (struct SWTIMER *t)
+{
+    if (!t)
+    {
+        return false;
+    }
+
+    if (t->active)
+    {
+        removeTimer (t);
+    }
+
+    return true;
+}
+
+
+bool SWTIMER_Active (struct SWTIMER *t)
+{
+    return (t && t->active);
+}
+
+
+uint32_t SWTIMER_Process (uint32_t now)
+{
+    uint32_t fired = 0;
+
+    while (timers && expired (timers->deadline, now))
+    {
+        struct SWTIMER *t = timers;
+
+        // Se quita antes de llamar a func, que puede volver a iniciarlo
+        timers      = t->next;
+        t->next     = NULL;
+        t->active   = false;
+
+        t->func (t->ctx);
+        ++ fired;
+    }
+
+    return fired;
+}
+
+
+bool SWTIMER_TicksToNext (uint32_t now, uint32_t *ticks)
+{
+    if (!timers || !ticks)
+    {
+        return false;
+    }
+
+    *ticks = expired (timers->deadline, now)? 0 : timers->deadline - now;
+    return true;
+}
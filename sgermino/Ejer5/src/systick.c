@@ -35,6 +35,11 @@
 static volatile uint32_t            g_ticks         = 0;
 static volatile SYSTICK_HookFunc    g_tickHook      = NULL;
 static uint32_t                     g_tickRateMicro = 0;
+static uint32_t                     g_tickCycles    = 0;
+
+// Shortest first period restart() programs: covers the cycles between the
+// CYCCNT read and SysTick counting again, with room to spare.
+#define RESTART_MIN_CYCLES      256
 
 
 void SysTick_Handler ()
@@ -48,18 +53,29 @@ void SysTick_Handler ()
 }
 
 
+// SYSTICK_Sleep() measures the cycles SysTick spends stopped with CYCCNT
+static void enableCycleCounter ()
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+
 void SYSTICK_SetMicrosecondPeriod (uint32_t micro)
 {
-    SysTick_Config ((SystemCoreClock * micro) / 1000000);
+    g_tickCycles = (SystemCoreClock * micro) / 1000000;
+    SysTick_Config (g_tickCycles);
     g_tickRateMicro = micro;
-
+    enableCycleCounter ();
 }
 
 
 void SYSTICK_SetMillisecondPeriod (uint32_t milli)
 {
-    SysTick_Config ((SystemCoreClock * milli) / 1000);
+    g_tickCycles = (SystemCoreClock * milli) / 1000;
+    SysTick_Config (g_tickCycles);
     g_tickRateMicro = milli * 1000;
+    enableCycleCounter ();
 }
 
 
@@ -75,6 +91,140 @@ uint32_t SYSTICK_Now ()
 }
 
 
+// Counts ticks skipped while sleeping as if SysTick_Handler had run
+static void advance (uint32_t ticks)
+{
+    while (ticks --)
+    {
+        ++ g_ticks;
+
+        if (g_tickHook)
+        {
+            g_tickHook (g_ticks);
+        }
+    }
+}
+
+
+uint32_t SYSTICK_MaxSleepTicks ()
+{
+    if (!g_tickCycles)
+    {
+        return 0;
+    }
+
+    return (SysTick_LOAD_RELOAD_Msk - g_tickCycles) / g_tickCycles + 1;
+}
+
+
+/*
+    Restarts SysTick, stopped since the cycle counter read 'stopMark', so the
+    next tick boundary happens 'cycles' cycles after the stop. Cycles spent
+    while stopped are measured with DWT->CYCCNT and taken from the first
+    period, so the tick phase (and SYSTICK_Now()) does not drift. A boundary
+    closer than RESTART_MIN_CYCLES is counted as crossed and the first period
+    runs to the one after it. Returns the number of boundaries that went by
+    (or almost) while stopped, if any.
+*/
+static uint32_t restart (uint32_t stopMark, uint32_t cycles)
+{
+    uint32_t crossed = 0;
+
+    SysTick->VAL = 0;
+
+    const uint32_t Lost = DWT->CYCCNT - stopMark;
+    while (cycles < Lost + RESTART_MIN_CYCLES)
+    {
+        cycles += g_tickCycles;
+        ++ crossed;
+    }
+
+    SysTick->LOAD = cycles - Lost - 1;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    // VAL reads zero until the first reload takes the value above, normal
+    // reload is restored only after that.
+    while (!SysTick->VAL)
+    {
+    }
+
+    SysTick->LOAD = g_tickCycles - 1;
+    return crossed;
+}
+
+
+/*
+    Sleeps until 'ticks' tick periods from now (or earlier, if any other
+    interrupt wakes the core) without taking the intermediate SysTick
+    interrupts. Must be called with interrupts disabled: the caller decides
+    how long to sleep and this function compensates SYSTICK_Now() and calls
+    the tick hook once per skipped tick before returning. The last tick, when
+    reached, is left pending for SysTick_Handler.
+*/
+void SYSTICK_Sleep (uint32_t ticks)
+{
+    if (!ticks)
+    {
+        return;
+    }
+
+    const uint32_t MaxTicks = SYSTICK_MaxSleepTicks ();
+    if (ticks > MaxTicks)
+    {
+        ticks = MaxTicks;
+    }
+
+    // A tick already pending must run first
+    if (ticks < 2 || (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk))
+    {
+        __WFI ();
+        return;
+    }
+
+    uint32_t mark = DWT->CYCCNT;
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+
+    // Tick boundary at 'ticks' periods from now, keeping the current phase.
+    const uint32_t FirstTick    = SysTick->VAL;
+    const uint32_t SleepCycles  = FirstTick + (ticks - 1) * g_tickCycles;
+
+    uint32_t crossed = restart (mark, SleepCycles);
+
+    __DSB ();
+    __WFI ();
+
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)
+    {
+        // Slept the full span, SysTick_Handler will count the last tick.
+        // SysTick is already back at the normal period.
+        advance (ticks - 1 + crossed);
+        return;
+    }
+
+    mark = DWT->CYCCNT;
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+
+    const uint32_t Remaining = SysTick->VAL;
+
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) || !Remaining)
+    {
+        // The last boundary was reached just before stopping
+        crossed += restart (mark, Remaining? Remaining : g_tickCycles);
+        advance (ticks - 1 + crossed);
+        return;
+    }
+
+    // Woken early by another interrupt: count the tick boundaries already
+    // crossed and resume normal ticking at the next one. 'Remaining' cycles
+    // are left to the end of the sleep, with 'Ahead' boundaries before it.
+    const uint32_t Ahead    = (Remaining - 1) / g_tickCycles;
+    const uint32_t NextTick = Remaining - Ahead * g_tickCycles;
+
+    crossed += restart (mark, NextTick);
+    advance (ticks - 1 - Ahead + crossed);
+}
+
+
 SYSTICK_HookFunc SYSTICK_SetHook (SYSTICK_HookFunc func)
 {
    SYSTICK_HookFunc old = g_tickHook;
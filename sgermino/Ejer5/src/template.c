@@ -0,0 +1,138 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "template.h"
+#include <string.h>
+
+
+struct Parts
+{
+    struct TEMPLATE_Part    *parts;
+    uint32_t                count;
+    uint32_t                max;
+};
+
+
+static bool addPart (struct Parts *t, uint32_t offset, uint32_t size,
+                     uint8_t arg)
+{
+    if (t->count >= t->max || offset > UINT16_MAX || size > UINT16_MAX)
+    {
+        return false;
+    }
+
+    struct TEMPLATE_Part *p = &t->parts[t->count ++];
+    p->offset   = (uint16_t) offset;
+    p->size     = (uint16_t) size;
+    p->arg      = arg;
+    return true;
+}
+
+
+/*
+    Separa msg en literales y comodines, con la misma sintaxis que
+    UART_PutMessageArgs(): "%1" a "%9" son argumentos, "%%" es un '%'
+    literal y '%' seguido de cualquier otro caracter es invalido. Un '%' al
+    final de msg se toma como literal. Devuelve la cantidad de partes o 0 si
+    no entran en maxParts.
+
+    Se usa en el host para generar TEMPLATE_Table; en el target los mensajes
+    fuera de la tabla se recorren en cada envio.
+*/
+uint32_t TEMPLATE_Compile (const char *msg, struct TEMPLATE_Part *parts,
+                           uint32_t maxParts)
+{
+    if (!msg || !parts)
+    {
+        return 0;
+    }
+
+    struct Parts t = { parts, 0, maxParts };
+
+    uint32_t start  = 0;
+    uint32_t i      = 0;
+
+    while (msg[i])
+    {
+        const char Next = msg[i + 1];
+        if (!Next)
+        {
+            if (!addPart (&t, start, i + 1 - start, TEMPLATE_ARG_NONE))
+            {
+                return 0;
+            }
+            break;
+        }
+
+        if (msg[i] != '%')
+        {
+            ++ i;
+            continue;
+        }
+
+        bool added;
+        if (Next >= '1' && Next <= '9')
+        {
+            added = addPart (&t, start, i - start, (uint8_t)(Next - '1'));
+        }
+        else if (Next == '%')
+        {
+            // El primer '%' queda como ultimo caracter del literal
+            added = addPart (&t, start, i + 1 - start, TEMPLATE_ARG_NONE);
+        }
+        else
+        {
+            added = addPart (&t, start, i - start, TEMPLATE_ARG_INVALID);
+        }
+
+        if (!added)
+        {
+            return 0;
+        }
+
+        i     += 2;
+        start  = i;
+    }
+
+    return t.count;
+}
+
+
+const struct TEMPLATE * TEMPLATE_Find (const char *msg)
+{
+    for (uint32_t i = 0; i < TEMPLATE_TableCount; ++i)
+    {
+        if (*TEMPLATE_Table[i].text == msg)
+        {
+            return &TEMPLATE_Table[i];
+        }
+    }
+    return NULL;
+}
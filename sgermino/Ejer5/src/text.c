@@ -58,7 +58,8 @@ const char *TEXT_UART_STATS2 = {
     TEXSTYLE_PREFIX_GROUP "  writes    : %3" TEXSTYLE_NL
     TEXSTYLE_PREFIX_GROUP "  overflows : %4" TEXSTYLE_NL
     TEXSTYLE_PREFIX_GROUP "  peeks     : %5" TEXSTYLE_NL
-    TEXSTYLE_PREFIX_GROUP "  discards  : %6"
+    TEXSTYLE_PREFIX_GROUP "  discards  : %6" TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "  overruns  : %7"
 };
 
 const char *TEXT_FSM_STATS1 = {
@@ -78,3 +79,36 @@ const char *TEXT_FSM_STATS2 = {
     TEXSTYLE_PREFIX_GROUP "  invalid stage   : %1" TEXSTYLE_NL
     TEXSTYLE_PREFIX_GROUP "  max rec. calls  : %2"
 };
+
+const char *TEXT_SCHEDULER_STATS1 = {
+    TEXSTYLE_PREFIX_GROUP "Clock rate  : %1 Hz"
+};
+
+const char *TEXT_SCHEDULER_STATS2 = {
+    TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "Task %1" TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "  function  : %2" TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "  runs      : %3" TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "  cycles    : %4 min, %5 avg, %6 max" TEXSTYLE_NL
+};
+
+const char *TEXT_SCHEDULER_STATS3 = {
+    TEXSTYLE_PREFIX_GROUP "  latency   : %1 min, %2 max" TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "  jitter    : %3" TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "  missed    : %4" TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "  backlog   : %5" TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "  offset    : %6 suggested" TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "  overruns  : %7, %8 runs dropped"
+};
+
+const char *TEXT_SCHEDULER_STATS4 = {
+    TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "Analysis" TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "  tasks       : %1" TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "  utilization : %2 ppm" TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "  hyperperiod : %3 ticks" TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "  peak        : %4 tasks in %5 ticks" TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "  collisions  : %6 ticks" TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "  peak cycles : %7 of %8 per tick" TEXSTYLE_NL
+    TEXSTYLE_PREFIX_GROUP "  balanced    : %9 tasks peak"
+};
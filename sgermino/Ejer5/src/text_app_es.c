@@ -49,6 +49,7 @@ const char *TEXT_WELCOME = {
     "   'a' Sensores." TEXSTYLE_NL
     "   's' Buffers de I/O." TEXSTYLE_NL
     "   'm' Máquina de estado." TEXSTYLE_NL
+    "   't' Perfil de tareas." TEXSTYLE_NL
     "   'c' Borrar pantalla." TEXSTYLE_NL
     TEXSTYLE_NL
 };
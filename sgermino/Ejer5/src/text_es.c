@@ -50,6 +50,15 @@ const char *TEXT_FSM_STATSEND = {
     TEXSTYLE_INFO_END
 };
 
+const char *TEXT_SCHEDULER_STATSBEGIN = {
+    TEXSTYLE_INFO_BEGIN "Perfil de ejecución de las tareas, en ciclos de reloj:"
+    TEXSTYLE_NL
+};
+
+const char *TEXT_SCHEDULER_STATSEND = {
+    TEXSTYLE_INFO_END
+};
+
 const char *TEXT_INDATA_TOOLONG = {
     TEXSTYLE_NL TEXSTYLE_ERROR("Dato demasiado largo.")
 };
@@ -0,0 +1,181 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+// Generado por test/gen_templates.c a partir de los textos, no editar.
+// Regenerar con: make -C sgermino/Ejer5/test templates
+#include "template.h"
+#include "text.h"
+#include "text_app.h"
+
+
+static const struct TEMPLATE_Part parts_TEXT_UART_STATS1[] =
+{
+    {    0,   30, 0x00 },
+    {   32,   21, 0x01 },
+    {   55,   21, 0x02 },
+    {   78,   21, 0x03 },
+    {  101,   21, 0x04 },
+    {  124,   21, 0x05 },
+    {  147,    2, 0xFF },
+};
+
+
+static const struct TEMPLATE_Part parts_TEXT_UART_STATS2[] =
+{
+    {    0,   33, 0x00 },
+    {   35,   21, 0x01 },
+    {   58,   21, 0x02 },
+    {   81,   21, 0x03 },
+    {  104,   21, 0x04 },
+    {  127,   21, 0x05 },
+    {  150,   21, 0x06 },
+};
+
+
+static const struct TEMPLATE_Part parts_TEXT_FSM_STATS1[] =
+{
+    {    0,   25, 0x00 },
+    {   27,   28, 0x01 },
+    {   57,   28, 0x02 },
+    {   87,   27, 0x03 },
+    {  116,   27, 0x04 },
+    {  145,   27, 0x05 },
+    {  174,   27, 0x06 },
+    {  203,   27, 0x07 },
+    {  232,   27, 0x08 },
+    {  261,    2, 0xFF },
+};
+
+
+static const struct TEMPLATE_Part parts_TEXT_FSM_STATS2[] =
+{
+    {    0,   44, 0x00 },
+    {   46,   27, 0x01 },
+};
+
+
+static const struct TEMPLATE_Part parts_TEXT_SCHEDULER_STATS1[] =
+{
+    {    0,   19, 0x00 },
+    {   21,    3, 0xFF },
+};
+
+
+static const struct TEMPLATE_Part parts_TEXT_SCHEDULER_STATS2[] =
+{
+    {    0,   12, 0x00 },
+    {   14,   21, 0x01 },
+    {   37,   21, 0x02 },
+    {   60,   21, 0x03 },
+    {   83,    6, 0x04 },
+    {   91,    6, 0x05 },
+    {   99,    6, 0xFF },
+};
+
+
+static const struct TEMPLATE_Part parts_TEXT_SCHEDULER_STATS3[] =
+{
+    {    0,   19, 0x00 },
+    {   21,    6, 0x01 },
+    {   29,   25, 0x02 },
+    {   56,   21, 0x03 },
+    {   79,   21, 0x04 },
+    {  102,   21, 0x05 },
+    {  125,   31, 0x06 },
+    {  158,    2, 0x07 },
+    {  162,   13, 0xFF },
+};
+
+
+static const struct TEMPLATE_Part parts_TEXT_SCHEDULER_STATS4[] =
+{
+    {    0,   38, 0x00 },
+    {   40,   23, 0x01 },
+    {   65,   27, 0x02 },
+    {   94,   29, 0x03 },
+    {  125,   10, 0x04 },
+    {  137,   29, 0x05 },
+    {  168,   29, 0x06 },
+    {  199,    4, 0x07 },
+    {  205,   32, 0x08 },
+    {  239,   11, 0xFF },
+};
+
+
+static const struct TEMPLATE_Part parts_TEXT_ALARMARMINGBEGIN[] =
+{
+    {    0,   10, 0x00 },
+    {   12,   68, 0xFF },
+};
+
+
+static const struct TEMPLATE_Part parts_TEXT_DOORPASSWORDTODISARM[] =
+{
+    {    0,   47, 0x00 },
+    {   49,   42, 0xFF },
+};
+
+
+static const struct TEMPLATE_Part parts_TEXT_DOORPASSWORDTODISARMAGAIN[] =
+{
+    {    0,   14, 0x00 },
+    {   16,   32, 0xFF },
+};
+
+
+const struct TEMPLATE TEMPLATE_Table[] =
+{
+    { &TEXT_UART_STATS1,
+      parts_TEXT_UART_STATS1, 7 },
+    { &TEXT_UART_STATS2,
+      parts_TEXT_UART_STATS2, 7 },
+    { &TEXT_FSM_STATS1,
+      parts_TEXT_FSM_STATS1, 10 },
+    { &TEXT_FSM_STATS2,
+      parts_TEXT_FSM_STATS2, 2 },
+    { &TEXT_SCHEDULER_STATS1,
+      parts_TEXT_SCHEDULER_STATS1, 2 },
+    { &TEXT_SCHEDULER_STATS2,
+      parts_TEXT_SCHEDULER_STATS2, 7 },
+    { &TEXT_SCHEDULER_STATS3,
+      parts_TEXT_SCHEDULER_STATS3, 9 },
+    { &TEXT_SCHEDULER_STATS4,
+      parts_TEXT_SCHEDULER_STATS4, 10 },
+    { &TEXT_ALARMARMINGBEGIN,
+      parts_TEXT_ALARMARMINGBEGIN, 2 },
+    { &TEXT_DOORPASSWORDTODISARM,
+      parts_TEXT_DOORPASSWORDTODISARM, 2 },
+    { &TEXT_DOORPASSWORDTODISARMAGAIN,
+      parts_TEXT_DOORPASSWORDTODISARMAGAIN, 2 },
+};
+
+
+const uint32_t TEMPLATE_TableCount =
+    sizeof(TEMPLATE_Table) / sizeof(TEMPLATE_Table[0]);
@@ -33,6 +33,15 @@
 #include <string.h>
 
 
+static void lock (struct UART *u, bool lock)
+{
+    if (u->mode != UART_ModePolled)
+    {
+        UART_IntLock (u, lock);
+    }
+}
+
+
 bool UART_Init (struct UART *u, void *handler, uint32_t baudRate)
 {
     if (!u)
@@ -50,6 +59,41 @@ bool UART_Init (struct UART *u, void *handler, uint32_t baudRate)
 }
 
 
+bool UART_SetMode (struct UART *u, enum UART_Mode mode)
+{
+    if (!u)
+    {
+        return false;
+    }
+
+    // Polled mientras se reconfigura, el handler de interrupcion no debe
+    // encontrar un modo a medio configurar.
+    u->mode = UART_ModePolled;
+    if (UART_ConfigMode (u, mode))
+    {
+        u->mode = mode;
+    }
+    // Sin canal de DMA libre la transmision queda por interrupcion
+    else if (mode == UART_ModeDma &&
+             UART_ConfigMode (u, UART_ModeInterrupt))
+    {
+        u->mode = UART_ModeInterrupt;
+    }
+    else
+    {
+        UART_ConfigMode (u, UART_ModePolled);
+        return false;
+    }
+
+    if (u->mode != UART_ModePolled)
+    {
+        // Envia lo que se haya acumulado en modo polled
+        UART_SendStart (u);
+    }
+    return (u->mode == mode);
+}
+
+
 uint32_t UART_SendPendingCount (struct UART *u)
 {
     if (!u)
@@ -61,6 +105,18 @@ uint32_t UART_SendPendingCount (struct UART *u)
 }
 
 
+// Bytes que se pueden agregar al buffer de envio sin descartar nada
+uint32_t UART_SendFree (struct UART *u)
+{
+    if (!u)
+    {
+        return 0;
+    }
+
+    return CYCLIC_Free (&u->send);
+}
+
+
 uint32_t UART_RecvPendingCount (struct UART *u)
 {
     if (!u)
@@ -80,7 +136,19 @@ bool UART_PutBinary (struct UART *u, const uint8_t *data,
         return false;
     }
 
-    return CYCLIC_InFromBuffer (&u->send, data, size);
+    // Con interrupcion o DMA no se pisan datos pendientes: el handler o el
+    // GPDMA pueden estar leyendolos. Si el bloque no entra se descarta.
+    lock (u, true);
+    const bool Ret = (u->mode == UART_ModePolled)?
+                        CYCLIC_InFromBuffer (&u->send, data, size) :
+                        CYCLIC_InFromBufferNoOverwrite (&u->send, data, size);
+    lock (u, false);
+
+    if (u->mode != UART_ModePolled)
+    {
+        UART_SendStart (u);
+    }
+    return Ret;
 }
 
 
@@ -90,6 +158,46 @@ bool UART_PutMessage (struct UART *u, const char *msg)
 }
 
 
+// Formatea el variant directamente en el buffer de envio. Solo si el espacio
+// contiguo no alcanza (cerca del final del buffer) pasa por uno temporal.
+bool UART_PutVariant (struct UART *u, struct VARIANT *v)
+{
+    if (!u || !v)
+    {
+        return false;
+    }
+
+    if (v->type == VARIANT_TypeString)
+    {
+        return UART_PutMessage (u, v->s? v->s : "N/A");
+    }
+
+    lock (u, true);
+    uint32_t size;
+    char *dst = (char *) CYCLIC_Reserve (&u->send, &size);
+    const uint32_t Len = VARIANT_Format (v, dst, size);
+    const bool Fits = (Len < size);
+    if (Fits)
+    {
+        CYCLIC_Commit (&u->send, Len);
+    }
+    lock (u, false);
+
+    if (!Fits)
+    {
+        char buf[VARIANT_FORMAT_SIZE];
+        return UART_PutBinary (u, (uint8_t *)buf,
+                               VARIANT_Format (v, buf, sizeof(buf)));
+    }
+
+    if (u->mode != UART_ModePolled)
+    {
+        UART_SendStart (u);
+    }
+    return true;
+}
+
+
 uint32_t UART_Send (struct UART *u)
 {
     if (!u)
@@ -97,20 +205,47 @@ uint32_t UART_Send (struct UART *u)
         return 0;
     }
 
+    if (u->mode != UART_ModePolled)
+    {
+        // Normalmente ya iniciado por UART_PutBinary()
+        return UART_SendStart (u);
+    }
+
     return CYCLIC_OutToStream (&u->send, UART_PutByte, u->handler,
                                UART_HW_FIFO_SIZE);
 }
 
 
-uint32_t UART_Recv (struct UART *u)
+void UART_SetRecvHook (struct UART *u, UART_RecvHookFunc func, void *ctx)
 {
     if (!u)
     {
+        return;
+    }
+
+    lock (u, true);
+    u->recvHook     = func;
+    u->recvHookCtx  = ctx;
+    lock (u, false);
+}
+
+
+uint32_t UART_Recv (struct UART *u)
+{
+    if (!u || u->mode != UART_ModePolled)
+    {
+        // En modo interrupcion la FIFO se vacia en el handler
         return 0;
     }
 
-    return CYCLIC_InFromStream (&u->recv, UART_GetByte, u->handler,
-                                UART_EOF);
+    const uint32_t Received = CYCLIC_InFromStream (&u->recv, UART_GetByte,
+                                                   u->handler, UART_EOF);
+    if (Received && u->recvHook)
+    {
+        u->recvHook (u->recvHookCtx);
+    }
+
+    return Received;
 }
 
 
@@ -121,7 +256,10 @@ bool UART_RecvInjectByte (struct UART *u, uint8_t byte)
         return false;
     }
 
-    return CYCLIC_In (&u->recv, byte);
+    lock (u, true);
+    const bool Ret = CYCLIC_In (&u->recv, byte);
+    lock (u, false);
+    return Ret;
 }
 
 
@@ -136,6 +274,32 @@ uint8_t UART_RecvPeek (struct UART *u, uint32_t offset)
 }
 
 
+const uint8_t * UART_RecvPeekSpan (struct UART *u, uint32_t offset,
+                                   uint32_t *size)
+{
+    if (!u)
+    {
+        return NULL;
+    }
+
+    return CYCLIC_PeekSpan (&u->recv, offset, size);
+}
+
+
+bool UART_RecvDiscard (struct UART *u, uint32_t count)
+{
+    if (!u)
+    {
+        return false;
+    }
+
+    lock (u, true);
+    const bool Ret = CYCLIC_Discard (&u->recv, count);
+    lock (u, false);
+    return Ret;
+}
+
+
 bool UART_RecvDiscardPending (struct UART *u)
 {
     if (!u)
@@ -143,5 +307,8 @@ bool UART_RecvDiscardPending (struct UART *u)
         return false;
     }
 
-    return CYCLIC_DiscardPending (&u->recv);
+    lock (u, true);
+    const bool Ret = CYCLIC_DiscardPending (&u->recv);
+    lock (u, false);
+    return Ret;
 }
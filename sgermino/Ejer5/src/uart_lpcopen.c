@@ -32,6 +32,251 @@
 #include "chip.h"
 
 
+#define UART_COUNT              4
+// Campo TransferSize del registro CONTROL del GPDMA (12 bits)
+#define UART_DMA_MAX_TRANSFER   4095
+
+
+// Instancias en modo interrupcion, indexadas por numero de USART
+static struct UART *    g_irqUart[UART_COUNT]   = { NULL };
+
+static const IRQn_Type  g_irqNumber[UART_COUNT] = { USART0_IRQn, UART1_IRQn,
+                                                    USART2_IRQn, USART3_IRQn };
+
+static const uint32_t   g_dmaConnTx[UART_COUNT] = { GPDMA_CONN_UART0_Tx,
+                                                    GPDMA_CONN_UART1_Tx,
+                                                    GPDMA_CONN_UART2_Tx,
+                                                    GPDMA_CONN_UART3_Tx };
+
+// Instancias en modo DMA, canal asignado y bytes de la transferencia en curso
+static struct UART *    g_dmaUart[UART_COUNT]   = { NULL };
+static uint8_t          g_dmaChannel[UART_COUNT];
+static volatile uint32_t g_dmaSize[UART_COUNT];
+static bool             g_dmaInitialized        = false;
+
+
+static int32_t usartIndex (LPC_USART_T *usart)
+{
+    if (usart == LPC_USART0) return 0;
+    if (usart == LPC_UART1)  return 1;
+    if (usart == LPC_USART2) return 2;
+    if (usart == LPC_USART3) return 3;
+    return -1;
+}
+
+
+// Solo valido si THRE esta activo: la FIFO de transmision esta vacia y
+// acepta UART_HW_FIFO_SIZE bytes sin esperar.
+static bool putByteNoWait (void *handler, uint8_t byte)
+{
+    Chip_UART_SendByte ((LPC_USART_T *)handler, byte);
+    return true;
+}
+
+
+static uint32_t fillSendFifo (struct UART *u)
+{
+    LPC_USART_T *usart = (LPC_USART_T *)u->handler;
+    if (!(Chip_UART_ReadLineStatus(usart) & UART_LSR_THRE))
+    {
+        return 0;
+    }
+
+    return CYCLIC_OutToStream (&u->send, putByteNoWait, usart,
+                               UART_HW_FIFO_SIZE);
+}
+
+
+// Cada lectura de LSR limpia OE: se usa el mismo valor para contar el
+// overrun y decidir si hay otro byte, asi no se pierde un OE que llegue
+// mientras se vacia la FIFO. Con el buffer lleno se descartan los bytes
+// nuevos (contados en overflows) en lugar de pisar los pendientes.
+static uint32_t drainRecvFifo (struct UART *u, LPC_USART_T *usart)
+{
+    uint8_t     data[UART_HW_FIFO_SIZE];
+    uint32_t    count = 0;
+    uint32_t    total = 0;
+    uint32_t    lsr   = Chip_UART_ReadLineStatus (usart);
+
+    while (true)
+    {
+        if (lsr & UART_LSR_OE)
+        {
+            ++ u->recvOverruns;
+        }
+
+        if (!(lsr & UART_LSR_RDR) || count == sizeof(data))
+        {
+            if (count &&
+                CYCLIC_InFromBufferNoOverwrite (&u->recv, data, count))
+            {
+                total += count;
+            }
+            count = 0;
+
+            if (!(lsr & UART_LSR_RDR))
+            {
+                break;
+            }
+        }
+
+        data[count ++] = Chip_UART_ReadByte (usart);
+        lsr = Chip_UART_ReadLineStatus (usart);
+    }
+
+    return total;
+}
+
+
+static void irqHandler (uint32_t index)
+{
+    struct UART *u = g_irqUart[index];
+    if (!u)
+    {
+        return;
+    }
+
+    LPC_USART_T *usart = (LPC_USART_T *)u->handler;
+
+    // Leer IIR y LSR limpia las interrupciones THRE y RLS pendientes
+    Chip_UART_ReadIntIDReg (usart);
+
+    if (drainRecvFifo (u, usart) && u->recvHook)
+    {
+        u->recvHook (u->recvHookCtx);
+    }
+
+    if (Chip_UART_GetIntsEnabled(usart) & UART_IER_THREINT)
+    {
+        fillSendFifo (u);
+        if (!CYCLIC_Pending (&u->send))
+        {
+            Chip_UART_IntDisable (usart, UART_IER_THREINT);
+        }
+    }
+}
+
+
+// Entrega a DMA la porcion contigua de u->send desde outIndex hasta el final
+// de los datos pendientes o del buffer, lo que ocurra primero. outIndex
+// avanza recien al completarse la transferencia.
+static uint32_t startSendDma (uint32_t index)
+{
+    struct UART   *u = g_dmaUart[index];
+    struct CYCLIC *c = &u->send;
+
+    if (g_dmaSize[index])
+    {
+        // Transferencia en curso, el handler de DMA encadena la siguiente
+        return 0;
+    }
+
+    uint32_t size;
+    const uint8_t *span = CYCLIC_PeekSpan (c, 0, &size);
+
+    if (size > UART_DMA_MAX_TRANSFER)
+    {
+        size = UART_DMA_MAX_TRANSFER;
+    }
+
+    if (!size)
+    {
+        return 0;
+    }
+
+    g_dmaSize[index] = size;
+    if (Chip_GPDMA_Transfer (LPC_GPDMA, g_dmaChannel[index],
+                             (uint32_t) span,
+                             g_dmaConnTx[index],
+                             GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA,
+                             size) != SUCCESS)
+    {
+        g_dmaSize[index] = 0;
+        return 0;
+    }
+
+    return size;
+}
+
+
+void DMA_IRQHandler (void)
+{
+    for (uint32_t i = 0; i < UART_COUNT; ++i)
+    {
+        struct UART *u = g_dmaUart[i];
+        if (!u || !g_dmaSize[i])
+        {
+            continue;
+        }
+
+        const Status Result = Chip_GPDMA_Interrupt (LPC_GPDMA,
+                                                    g_dmaChannel[i]);
+        if (Result != SUCCESS &&
+            Chip_GPDMA_IntGetStatus (LPC_GPDMA, GPDMA_STAT_ENABLED_CH,
+                                     g_dmaChannel[i]))
+        {
+            // No es de este canal
+            continue;
+        }
+
+        // Completada (o abortada por error): los bytes se dan por enviados
+        CYCLIC_Consume (&u->send, g_dmaSize[i]);
+        g_dmaSize[i] = 0;
+
+        startSendDma (i);
+    }
+}
+
+
+void UART0_IRQHandler (void)
+{
+    irqHandler (0);
+}
+
+
+void UART1_IRQHandler (void)
+{
+    irqHandler (1);
+}
+
+
+void UART2_IRQHandler (void)
+{
+    irqHandler (2);
+}
+
+
+void UART3_IRQHandler (void)
+{
+    irqHandler (3);
+}
+
+
+// Chip_GPDMA_GetFreeChannel() devuelve 0 tanto para el canal 0 como cuando
+// no hay canales libres. El 0 solo se acepta si antes no estaba habilitado
+// ni asignado a otra UART.
+static int32_t claimDmaChannel (uint32_t index)
+{
+    bool channel0Busy = Chip_GPDMA_IntGetStatus (LPC_GPDMA,
+                                                 GPDMA_STAT_ENABLED_CH, 0);
+    for (uint32_t i = 0; i < UART_COUNT; ++i)
+    {
+        if (g_dmaUart[i] && g_dmaChannel[i] == 0)
+        {
+            channel0Busy = true;
+        }
+    }
+
+    const uint8_t Channel = Chip_GPDMA_GetFreeChannel (LPC_GPDMA,
+                                                       g_dmaConnTx[index]);
+    if (!Channel && channel0Busy)
+    {
+        return -1;
+    }
+    return Channel;
+}
+
+
 bool UART_Config (struct UART *u, uint32_t baudRate)
 {
     if (!u || !u->handler)
@@ -52,6 +297,141 @@ bool UART_Config (struct UART *u, uint32_t baudRate)
 }
 
 
+bool UART_ConfigMode (struct UART *u, enum UART_Mode mode)
+{
+    if (!u || !u->handler)
+    {
+        return false;
+    }
+
+    LPC_USART_T *usart = (LPC_USART_T *)u->handler;
+
+    const int32_t Index = usartIndex (usart);
+    if (Index < 0)
+    {
+        return false;
+    }
+
+    NVIC_DisableIRQ         (g_irqNumber[Index]);
+    Chip_UART_IntDisable    (usart, UART_IER_RBRINT | UART_IER_THREINT |
+                             UART_IER_RLSINT);
+
+    if (g_dmaUart[Index])
+    {
+        NVIC_DisableIRQ     (DMA_IRQn);
+        Chip_GPDMA_Stop     (LPC_GPDMA, g_dmaChannel[Index]);
+        g_dmaUart[Index]    = NULL;
+        g_dmaSize[Index]    = 0;
+        NVIC_EnableIRQ      (DMA_IRQn);
+    }
+
+    if (mode == UART_ModePolled)
+    {
+        g_irqUart[Index] = NULL;
+        Chip_UART_SetupFIFOS (usart, UART_FCR_FIFO_EN | UART_FCR_TRG_LEV0);
+        return true;
+    }
+
+    g_irqUart[Index] = u;
+
+    uint32_t fifoConfig = UART_FCR_FIFO_EN | UART_FCR_TRG_LEV2;
+
+    if (mode == UART_ModeDma)
+    {
+        if (!g_dmaInitialized)
+        {
+            Chip_GPDMA_Init (LPC_GPDMA);
+            g_dmaInitialized = true;
+        }
+
+        const int32_t Channel = claimDmaChannel (Index);
+        if (Channel < 0)
+        {
+            g_irqUart[Index] = NULL;
+            return false;
+        }
+
+        g_dmaChannel[Index] = (uint8_t) Channel;
+        g_dmaSize[Index]    = 0;
+        g_dmaUart[Index]    = u;
+        fifoConfig         |= UART_FCR_DMAMODE_SEL;
+
+        NVIC_EnableIRQ (DMA_IRQn);
+    }
+
+    // Interrupcion cada 8 bytes recibidos, el resto llega por "character
+    // timeout" (CTI)
+    Chip_UART_SetupFIFOS    (usart, fifoConfig);
+    Chip_UART_IntEnable     (usart, UART_IER_RBRINT | UART_IER_RLSINT);
+    NVIC_ClearPendingIRQ    (g_irqNumber[Index]);
+    NVIC_EnableIRQ          (g_irqNumber[Index]);
+    return true;
+}
+
+
+void UART_IntLock (struct UART *u, bool lock)
+{
+    if (!u || !u->handler)
+    {
+        return;
+    }
+
+    const int32_t Index = usartIndex ((LPC_USART_T *)u->handler);
+    if (Index < 0)
+    {
+        return;
+    }
+
+    // En modo DMA el handler de DMA tambien modifica el buffer de envio
+    if (lock)
+    {
+        NVIC_DisableIRQ (g_irqNumber[Index]);
+        if (g_dmaUart[Index])
+        {
+            NVIC_DisableIRQ (DMA_IRQn);
+        }
+    }
+    else
+    {
+        NVIC_EnableIRQ (g_irqNumber[Index]);
+        if (g_dmaUart[Index])
+        {
+            NVIC_EnableIRQ (DMA_IRQn);
+        }
+    }
+}
+
+
+uint32_t UART_SendStart (struct UART *u)
+{
+    if (!u || !u->handler)
+    {
+        return 0;
+    }
+
+    LPC_USART_T *usart = (LPC_USART_T *)u->handler;
+
+    const int32_t Index = usartIndex (usart);
+    if (Index >= 0 && g_dmaUart[Index] == u)
+    {
+        NVIC_DisableIRQ (DMA_IRQn);
+        const uint32_t Sent = startSendDma (Index);
+        NVIC_EnableIRQ  (DMA_IRQn);
+        return Sent;
+    }
+
+    // Mismo esquema que Chip_UART_SendRB(): sin THRE habilitado el handler
+    // no toca el buffer de envio mientras se llena la FIFO.
+    Chip_UART_IntDisable (usart, UART_IER_THREINT);
+    const uint32_t Sent = fillSendFifo (u);
+    if (CYCLIC_Pending (&u->send))
+    {
+        Chip_UART_IntEnable (usart, UART_IER_THREINT);
+    }
+    return Sent;
+}
+
+
 uint32_t UART_GetByte (void *handler)
 {
     if (!handler)
@@ -29,7 +29,32 @@
     POSSIBILITY OF SUCH DAMAGE.
 */
 #include "uart_util.h"
+#include "template.h"
 #include "text.h"
+#include <stddef.h>
+
+
+static void putTemplateArgs (struct UART *u, const struct TEMPLATE *t,
+                             struct VARIANT argValues[], uint32_t argCount)
+{
+    const char *Msg = *t->text;
+
+    for (uint32_t i = 0; i < t->partCount; ++i)
+    {
+        const struct TEMPLATE_Part *p = &t->parts[i];
+
+        UART_PutBinary (u, (const uint8_t *)&Msg[p->offset], p->size);
+
+        if (p->arg < argCount)
+        {
+            UART_PutVariant (u, &argValues[p->arg]);
+        }
+        else if (p->arg == TEMPLATE_ARG_INVALID)
+        {
+            UART_PutMessage (u, TEXT_REPLACEMENTCHAR);
+        }
+    }
+}
 
 
 /*
@@ -39,6 +64,11 @@
         i18n de strings).
     2)  Datos pasados como variants, no posiciones de memoria a interpretar.
     3)  Puede sustituir el mismo dato dos o mas veces.
+
+    Los mensajes de TEMPLATE_Table ya vienen separados en literales y
+    comodines desde la compilacion (ver text_templates.c): enviarlos es solo
+    una secuencia de copias de bloques. Cualquier otro msg se recorre en
+    cada llamada.
 */
 
 bool UART_PutMessageArgs (struct UART *u, const char *msg,
@@ -49,6 +79,13 @@ bool UART_PutMessageArgs (struct UART *u, const char *msg,
         return false;
     }
 
+    const struct TEMPLATE *t = TEMPLATE_Find (msg);
+    if (t)
+    {
+        putTemplateArgs (u, t, argValues, argCount);
+        return true;
+    }
+
     uint32_t i = 0;
 
     while (msg[i])
@@ -73,7 +110,7 @@ bool UART_PutMessageArgs (struct UART *u, const char *msg,
             const uint32_t arg = Next - 49;
             if (arg < argCount)
             {
-                UART_PutMessage (u, VARIANT_ToString(&argValues[arg]));
+                UART_PutVariant (u, &argValues[arg]);
             }
         }
         else if (Next == '%')
@@ -117,6 +154,7 @@ void UART_PutStatusMessage (struct UART *u)
     VARIANT_SetUint32   (&args[3], u->recv.overflows);
     VARIANT_SetUint32   (&args[4], u->recv.peeks);
     VARIANT_SetUint32   (&args[5], u->recv.discards);
-    UART_PutMessageArgs (u, TEXT_UART_STATS2, args, 6);
+    VARIANT_SetUint32   (&args[6], u->recvOverruns);
+    UART_PutMessageArgs (u, TEXT_UART_STATS2, args, 7);
     UART_PutMessage     (u, TEXT_UART_STATSEND);
 }
@@ -29,11 +29,45 @@
     POSSIBILITY OF SUCH DAMAGE.
 */
 #include "variant.h"
-#include <stdio.h>
+#include "fmt.h"
 #include <stdlib.h>
 #include <string.h>
 
 
+// Decimal simple ("123", "-45"): lo que escribe FMT_Uint32/Int32 o ingresa el
+// usuario. Hasta 9 digitos no hay desborde. Cualquier otra forma (hex,
+// octal, espacios, '+') queda para strtoul/strtol.
+static bool parseDecimal (const char *s, uint32_t *value)
+{
+    const bool Negative = (*s == '-');
+    if (Negative)
+    {
+        ++ s;
+    }
+
+    // "0" solo es decimal; "0..." es octal o hex para strtoul
+    if (s[0] == '0' && s[1])
+    {
+        return false;
+    }
+
+    uint32_t v = 0;
+    uint32_t i = 0;
+    for (; i < 9 && s[i] >= '0' && s[i] <= '9'; ++i)
+    {
+        v = v * 10 + (uint32_t)(s[i] - '0');
+    }
+
+    if (!i || s[i])
+    {
+        return false;
+    }
+
+    *value = Negative? (uint32_t)(-(int32_t) v) : v;
+    return true;
+}
+
+
 void VARIANT_SetUint32 (struct VARIANT *v, uint32_t u)
 {
     if (v)
@@ -91,6 +125,12 @@ uint32_t VARIANT_ToUint32 (struct VARIANT *v)
         return 0;
     }
 
+    uint32_t u;
+    if (v->type == VARIANT_TypeString && parseDecimal (v->s, &u))
+    {
+        return u;
+    }
+
     switch (v->type)
     {
         case VARIANT_TypeUint32:
@@ -119,6 +159,12 @@ int32_t VARIANT_ToInt32 (struct VARIANT *v)
         return 0;
     }
 
+    uint32_t u;
+    if (v->type == VARIANT_TypeString && parseDecimal (v->s, &u))
+    {
+        return (int32_t) u;
+    }
+
     switch (v->type)
     {
         case VARIANT_TypeUint32:
@@ -168,41 +214,43 @@ float VARIANT_ToFloat (struct VARIANT *v)
 }
 
 
-const char* VARIANT_ToString (struct VARIANT *v)
+// Como FMT_*: escribe como maximo size - 1 caracteres mas el terminador y
+// devuelve el largo completo del resultado
+uint32_t VARIANT_Format (struct VARIANT *v, char *dst, uint32_t size)
 {
     if (!v)
     {
-        return NULL;
+        return 0;
     }
 
-    v->conv[0] = 'N';
-    v->conv[1] = '/';
-    v->conv[2] = 'A';
-    v->conv[3] = '\0';
-
     switch (v->type)
     {
         case VARIANT_TypeUint32:
-            snprintf (v->conv, sizeof(v->conv), "%lu", v->u);
-            break;
+            return FMT_Uint32   (dst, size, v->u, 0, ' ');
 
         case VARIANT_TypeInt32:
-            snprintf (v->conv, sizeof(v->conv), "%li", v->i);
-            break;
+            return FMT_Int32    (dst, size, v->i, 0, ' ');
 
         case VARIANT_TypeFloat:
-            snprintf (v->conv, sizeof(v->conv), "%f", v->f);
-            break;
+            return FMT_Float    (dst, size, v->f, FMT_FLOAT_DECIMALS, 0, ' ');
 
         case VARIANT_TypePointer:
-            snprintf (v->conv, sizeof(v->conv), "%p", v->p);
-            break;
+            return FMT_Pointer  (dst, size, v->p);
 
         case VARIANT_TypeString:
-            return v->s;
+            break;
     }
 
-    return v->conv;
+    const char *Src = (v->type == VARIANT_TypeString && v->s)? v->s : "N/A";
+    const uint32_t Len = strlen (Src);
+
+    if (size)
+    {
+        const uint32_t Count = (Len < size)? Len : size - 1;
+        memcpy (dst, Src, Count);
+        dst[Count] = '\0';
+    }
+    return Len;
 }
 
 
@@ -0,0 +1,134 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "copos.h"
+#include "systick.h"
+#include "chip.h"
+#include <stdlib.h>
+
+
+// Se compila dos veces: con la rueda de timers (hasta 32 tareas) y con
+// SCHEDULER_TIMER_WHEEL=0, que recorre los SCHEDULER_MAX_TASKS lugares en
+// cada tick
+#if SCHEDULER_TIMER_WHEEL
+    #define BACKEND     "wheel"
+#else
+    #define BACKEND     "scan"
+#endif
+
+#define BENCH_TICKS     20000
+
+
+static const uint32_t   g_taskCounts[] = { 10, 32, 100, 1000 };
+static uint64_t         g_tickCycles[BENCH_TICKS];
+static volatile uint32_t g_sink;
+
+
+static void task (void *ctx, uint32_t ticks)
+{
+    g_sink += ticks;
+}
+
+
+static int cmpCycles (const void *a, const void *b)
+{
+    const uint64_t A = *(const uint64_t *) a;
+    const uint64_t B = *(const uint64_t *) b;
+    return (A > B) - (A < B);
+}
+
+
+/*
+    Costo de schedulerUpdate() (la ISR del tick) con 'count' tareas de
+    periodos entre 1 y 1000 ticks, como los de main.c. Las tareas se
+    despachan fuera de la medicion para que la rueda y los contadores
+    queden como en el target.
+*/
+static void benchTasks (uint32_t count)
+{
+    FAKE_SysTickReset (0);
+    schedulerInit ();
+
+    static const uint32_t Periods[] = { 1, 5, 10, 14, 16, 20, 50, 100,
+                                        140, 500, 1000 };
+    const uint32_t PeriodCount = sizeof(Periods) / sizeof(Periods[0]);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const uint32_t Period = Periods[(uint32_t) rand () % PeriodCount];
+        TEST_CHECK (schedulerAddTask (task, NULL,
+                                      (uint32_t) rand () % Period, Period)
+                    == i);
+    }
+
+    uint64_t total = 0;
+    for (uint32_t tick = 1; tick <= BENCH_TICKS; ++tick)
+    {
+        const uint64_t Start = TEST_Cycles ();
+        schedulerUpdate (tick);
+        g_tickCycles[tick - 1] = TEST_Cycles () - Start;
+        total += g_tickCycles[tick - 1];
+
+        schedulerDispatchTasks (tick);
+    }
+
+    qsort (g_tickCycles, BENCH_TICKS, sizeof(g_tickCycles[0]), cmpCycles);
+
+    printf ("  %s, %4u tasks (%4u slots): %6.1f %s/tick mean, %6u p99\n",
+            BACKEND, count, SCHEDULER_MAX_TASKS,
+            (double) total / BENCH_TICKS, TEST_CYCLES_UNIT,
+            (unsigned) g_tickCycles[BENCH_TICKS * 99 / 100]);
+}
+
+
+static void benchIsr ()
+{
+    srand (1);
+
+    for (uint32_t i = 0; i < sizeof(g_taskCounts) / sizeof(g_taskCounts[0]);
+         ++i)
+    {
+        if (g_taskCounts[i] > SCHEDULER_MAX_TASKS)
+        {
+            printf ("  %s, %4u tasks: over SCHEDULER_MAX_TASKS (%u)\n",
+                    BACKEND, g_taskCounts[i], SCHEDULER_MAX_TASKS);
+            continue;
+        }
+        benchTasks (g_taskCounts[i]);
+    }
+}
+
+
+int main ()
+{
+    TEST_RUN (benchIsr);
+    return TEST_END ();
+}
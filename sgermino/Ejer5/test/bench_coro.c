@@ -0,0 +1,284 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "coro.h"
+#include "indata.h"
+#include <stdlib.h>
+
+
+#define RESUMES     20000000
+#define TRIPS       2000000
+#define SCRIPT      200000
+
+// Cada version en su propia seccion: el linker define __start_ y __stop_
+#define IN_SECTION(s)   __attribute__((noipa, section (#s)))
+
+extern const char __start_coro_password[];
+extern const char __stop_coro_password[];
+extern const char __start_legacy_password[];
+extern const char __stop_legacy_password[];
+
+
+// Lo que APP_PasswordLogic() usa de struct APP; INDATA, UART y PASSWORD se
+// reducen a un estado y contadores para medir solo el despacho
+struct PROMPT
+{
+    enum INDATA_Status  status;
+    bool                request;
+    bool                matches;
+    uint32_t            messages;
+    struct CORO         coro;
+};
+
+
+enum Action
+{
+    Action_None,
+    Action_Asking,
+    Action_AskAgain,
+    Action_Match
+};
+
+
+static void clearRequests (struct PROMPT *p)
+{
+    p->request  = false;
+    p->status   = INDATA_StatusDisabled;
+    CORO_Init (&p->coro);
+}
+
+
+// APP_PasswordLogic() antes de las corrutinas: despacho por estado de INDATA
+IN_SECTION(legacy_password)
+enum Action legacyPassword (struct PROMPT *p)
+{
+    switch (p->status)
+    {
+        case INDATA_StatusDisabled:
+        default:
+            if (p->request)
+            {
+                clearRequests (p);
+                ++ p->messages;
+                p->status = INDATA_StatusPrompt;
+                return Action_Asking;
+            }
+            return Action_None;
+
+        case INDATA_StatusPrompt:
+            return Action_None;
+
+        case INDATA_StatusReady:
+            ++ p->messages;
+            if (p->matches)
+            {
+                ++ p->messages;
+                p->status = INDATA_StatusDisabled;
+                return Action_Match;
+            }
+            ++ p->messages;
+            break;
+
+        case INDATA_StatusInvalid:
+            ++ p->messages;
+            break;
+    }
+
+    p->status = INDATA_StatusDisabled;
+    return Action_AskAgain;
+}
+
+
+// APP_PasswordLogic() actual
+IN_SECTION(coro_password)
+enum Action coroPassword (struct PROMPT *p)
+{
+    struct CORO *c = &p->coro;
+
+    CORO_BEGIN (c);
+
+    CORO_AWAIT (c, p->request, Action_None);
+
+    clearRequests (p);
+    ++ p->messages;
+    p->status = INDATA_StatusPrompt;
+    CORO_YIELD (c, Action_Asking);
+
+    CORO_AWAIT (c, p->status != INDATA_StatusPrompt, Action_None);
+
+    switch (p->status)
+    {
+        case INDATA_StatusReady:
+            ++ p->messages;
+            if (p->matches)
+            {
+                ++ p->messages;
+                p->status = INDATA_StatusDisabled;
+                CORO_RESTART (c, Action_Match);
+            }
+            ++ p->messages;
+            break;
+
+        case INDATA_StatusInvalid:
+            ++ p->messages;
+            break;
+
+        default:
+            CORO_RESTART (c, Action_None);
+    }
+
+    p->status = INDATA_StatusDisabled;
+    CORO_END (c, Action_AskAgain);
+}
+
+
+typedef enum Action (*Logic) (struct PROMPT *p);
+
+
+// El mismo guion de pedidos, ingresos y cancelaciones a las dos versiones
+static void testSameActions ()
+{
+    struct PROMPT   a = { 0 };
+    struct PROMPT   b = { 0 };
+    uint32_t        count[4] = { 0 };
+    bool            same = true;
+
+    srand (16);
+    for (uint32_t i = 0; i < SCRIPT && same; ++i)
+    {
+        const uint32_t R = (uint32_t) rand () % 100;
+        if (R < 10)
+        {
+            a.request = b.request = true;
+        }
+        else if (R < 15 && a.status == INDATA_StatusPrompt)
+        {
+            a.status  = b.status  = INDATA_StatusReady;
+            a.matches = b.matches = rand () & 1;
+        }
+        else if (R < 18 && a.status == INDATA_StatusPrompt)
+        {
+            a.status  = b.status  = INDATA_StatusInvalid;
+        }
+        else if (R < 19)
+        {
+            // APP_ClearRequests() desde un cambio de estado de la FSM
+            clearRequests (&a);
+            clearRequests (&b);
+        }
+
+        const enum Action A = legacyPassword (&a);
+        const enum Action B = coroPassword (&b);
+        same = (A == B && a.status == b.status && a.messages == b.messages);
+        ++ count[A];
+    }
+
+    printf ("  %u calls: %u asking, %u ask again, %u match\n", SCRIPT,
+            count[Action_Asking], count[Action_AskAgain],
+            count[Action_Match]);
+    TEST_CHECK (same);
+    TEST_CHECK (count[Action_Match] && count[Action_AskAgain]);
+}
+
+
+static double resumes (Logic logic, struct PROMPT *p)
+{
+    const uint64_t Start = TEST_Cycles ();
+    for (uint32_t i = 0; i < RESUMES; ++i)
+    {
+        logic (p);
+    }
+    return (double)(TEST_Cycles () - Start) / RESUMES;
+}
+
+
+// Pedido, prompt, espera, ingreso correcto: cuatro llamadas por vuelta
+static double trips (Logic logic, struct PROMPT *p)
+{
+    bool ok = true;
+
+    const uint64_t Start = TEST_Cycles ();
+    for (uint32_t i = 0; i < TRIPS; ++i)
+    {
+        p->request = true;
+        ok &= (logic (p) == Action_Asking);
+        ok &= (logic (p) == Action_None);
+        p->status  = INDATA_StatusReady;
+        p->matches = true;
+        ok &= (logic (p) == Action_Match);
+        ok &= (logic (p) == Action_None);
+    }
+    const double Cycles = (double)(TEST_Cycles () - Start) / (TRIPS * 4);
+
+    TEST_CHECK (ok);
+    return Cycles;
+}
+
+
+static void benchResume (const char *name, Logic logic, const char *start,
+                         const char *stop)
+{
+    struct PROMPT p = { 0 };
+
+    // Sin pedido: la llamada de cada ciclo de uartProcessTask
+    const double Idle = resumes (logic, &p);
+
+    // Prompt abierto: espera que INDATA deje de estar en prompt
+    p.request = true;
+    TEST_CHECK (logic (&p) == Action_Asking);
+    const double Prompt = resumes (logic, &p);
+
+    clearRequests (&p);
+    const double Trip = trips (logic, &p);
+
+    printf ("  %-7s %4u bytes, %5.1f " TEST_CYCLES_UNIT "/resume idle, "
+            "%5.1f in prompt, %5.1f round trip\n", name,
+            (uint32_t)(stop - start), Idle, Prompt, Trip);
+}
+
+
+static void benchCoro ()
+{
+    printf ("  struct CORO: %u bytes per coroutine\n",
+            (uint32_t) sizeof(struct CORO));
+    benchResume ("legacy", legacyPassword, __start_legacy_password,
+                 __stop_legacy_password);
+    benchResume ("coro", coroPassword, __start_coro_password,
+                 __stop_coro_password);
+}
+
+
+int main ()
+{
+    TEST_RUN (testSameActions);
+    TEST_RUN (benchCoro);
+    return TEST_END ();
+}
@@ -0,0 +1,361 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "cyclic.h"
+#include <stdlib.h>
+
+
+#define CAPACITY        4096
+#define BENCH_BYTES     (64u * 1024 * 1024)
+
+
+static uint8_t  g_dataA [CAPACITY];
+static uint8_t  g_dataB [CAPACITY];
+
+
+// CYCLIC_InFromBuffer() y CYCLIC_OutToBuffer() anteriores: un byte por
+// vuelta con la mascara en cada paso. Referencia de resultados y de tiempos,
+// sin inline para pagar la misma llamada que las de cyclic.c.
+__attribute__((noinline))
+static bool loopInFromBuffer (struct CYCLIC *c, const uint8_t *data,
+                              uint32_t size)
+{
+    if (!c || !data || !size)
+    {
+        return false;
+    }
+
+    const uint32_t Pending = CYCLIC_Pending (c);
+
+    for (uint32_t i = size; i; --i)
+    {
+        c->data[c->inIndex] = *data ++;
+        c->inIndex = (c->inIndex + 1) & (c->capacity - 1);
+    }
+
+    c->writes += size;
+    if (size > c->capacity - Pending)
+    {
+        c->overflows += size - (c->capacity - Pending);
+    }
+
+    return true;
+}
+
+
+__attribute__((noinline))
+static bool loopOutToBuffer (struct CYCLIC *c, uint8_t *data, uint32_t count)
+{
+    if (!c || !data || !count)
+    {
+        return false;
+    }
+
+    const uint32_t Pending = CYCLIC_Pending (c);
+    if (!Pending)
+    {
+        return true;
+    }
+
+    if (count > Pending)
+    {
+        count = Pending;
+    }
+
+    c->reads += count;
+
+    while (count --)
+    {
+        *data ++ = c->data[c->outIndex];
+        c->outIndex = (c->outIndex + 1) & (c->capacity - 1);
+    }
+
+    return true;
+}
+
+
+static bool sameState (const struct CYCLIC *a, const struct CYCLIC *b)
+{
+    return (a->inIndex == b->inIndex && a->outIndex == b->outIndex
+            && a->reads == b->reads && a->writes == b->writes
+            && a->overflows == b->overflows
+            && !memcmp (a->data, b->data, a->capacity));
+}
+
+
+// Secuencias al azar de entradas y salidas, con desbordes y cruces del final
+// del buffer: las copias en bloque dejan todo igual que el recorrido
+static void testMatchesByteLoop ()
+{
+    static uint8_t  in      [CAPACITY * 2];
+    static uint8_t  outA    [CAPACITY * 2];
+    static uint8_t  outB    [CAPACITY * 2];
+    struct CYCLIC   a;
+    struct CYCLIC   b;
+
+    for (uint32_t capacity = 16; capacity <= CAPACITY; capacity *= 16)
+    {
+        memset (g_dataA, 0, sizeof(g_dataA));
+        memset (g_dataB, 0, sizeof(g_dataB));
+        CYCLIC_Init (&a, g_dataA, capacity);
+        CYCLIC_Init (&b, g_dataB, capacity);
+
+        for (uint32_t op = 0; op < 200000; ++op)
+        {
+            const uint32_t Size = 1 + rand () % (capacity + capacity / 2);
+
+            if (rand () & 1)
+            {
+                for (uint32_t i = 0; i < Size; ++i)
+                {
+                    in[i] = (uint8_t) rand ();
+                }
+                CYCLIC_InFromBuffer (&a, in, Size);
+                loopInFromBuffer    (&b, in, Size);
+            }
+            else
+            {
+                CYCLIC_OutToBuffer  (&a, outA, Size);
+                loopOutToBuffer     (&b, outB, Size);
+                TEST_CHECK (!memcmp (outA, outB, Size));
+            }
+
+            if (!sameState (&a, &b))
+            {
+                TEST_CHECK (sameState (&a, &b));
+                break;
+            }
+        }
+    }
+}
+
+
+static double rate (uint32_t chunk, bool blocks)
+{
+    static uint8_t  in  [CAPACITY];
+    static uint8_t  out [CAPACITY];
+    struct CYCLIC   c;
+
+    CYCLIC_Init (&c, g_dataA, CAPACITY);
+    memset (in, 0x5A, sizeof(in));
+
+    // Los bloques chicos miden sobre todo el costo por llamada
+    const uint32_t Total = (chunk < 256)? BENCH_BYTES / 8 : BENCH_BYTES;
+    const double Start = TEST_Seconds ();
+
+    for (uint32_t moved = 0; moved < Total; moved += chunk)
+    {
+        if (blocks)
+        {
+            CYCLIC_InFromBuffer (&c, in, chunk);
+            CYCLIC_OutToBuffer  (&c, out, chunk);
+        }
+        else
+        {
+            loopInFromBuffer    (&c, in, chunk);
+            loopOutToBuffer     (&c, out, chunk);
+        }
+    }
+
+    const double Elapsed = TEST_Seconds () - Start;
+    TEST_CHECK (c.reads == c.writes && !c.overflows);
+    return Total / Elapsed;
+}
+
+
+// Bytes/s de entrada mas salida por tamano de bloque, contra el recorrido
+// byte a byte
+static void benchChunks ()
+{
+    static const uint32_t Chunks[] = { 1, 16, 256, 2048 };
+
+    for (uint32_t i = 0; i < sizeof(Chunks) / sizeof(Chunks[0]); ++i)
+    {
+        const double Loop   = rate (Chunks[i], false);
+        const double Blocks = rate (Chunks[i], true);
+
+        printf ("  %4u byte chunks: %8.1f MB/s byte loop, %8.1f MB/s "
+                "memcpy (%.2fx)\n", Chunks[i], Loop / 1e6, Blocks / 1e6,
+                Blocks / Loop);
+    }
+}
+
+
+// Reserve/Commit y PeekSpan/Consume recorren lo mismo que In/Peek, en como
+// maximo dos porciones cuando los datos cruzan el final del buffer
+static void testSpans ()
+{
+    struct CYCLIC c;
+    CYCLIC_Init (&c, g_dataA, 64);
+
+    for (uint32_t start = 0; start < 64; ++start)
+    {
+        c.inIndex = c.outIndex = start;
+
+        uint32_t written = 0;
+        uint32_t spans = 0;
+        uint32_t size;
+        uint8_t *free;
+        while ((free = CYCLIC_Reserve (&c, &size)) && size)
+        {
+            for (uint32_t i = 0; i < size; ++i)
+            {
+                free[i] = (uint8_t)(written + i);
+            }
+            TEST_CHECK (CYCLIC_Commit (&c, size));
+            written += size;
+            ++ spans;
+        }
+
+        // Un lugar queda libre para distinguir lleno de vacio
+        TEST_CHECK (written == 63 && CYCLIC_Pending (&c) == 63);
+        TEST_CHECK (spans == ((start <= 1)? 1 : 2));
+
+        for (uint32_t i = 0; i < 63; ++i)
+        {
+            TEST_CHECK (CYCLIC_Peek (&c, i) == (uint8_t) i);
+        }
+
+        uint32_t read = 0;
+        const uint8_t *data;
+        while ((data = CYCLIC_PeekSpan (&c, 0, &size)))
+        {
+            for (uint32_t i = 0; i < size; ++i)
+            {
+                TEST_CHECK (data[i] == (uint8_t)(read + i));
+            }
+            TEST_CHECK (CYCLIC_Consume (&c, size));
+            read += size;
+        }
+
+        TEST_CHECK (read == 63 && !CYCLIC_Pending (&c));
+    }
+}
+
+
+static uint32_t g_sink;
+
+
+// Como edit() de INDATA_Prompt(): una llamada por byte recibido
+__attribute__((noinline))
+static void handleByte (uint8_t byte)
+{
+    g_sink += byte;
+}
+
+
+static double scanRate (bool spans, bool handler)
+{
+    struct CYCLIC c;
+    CYCLIC_Init (&c, g_dataA, CAPACITY);
+
+    const uint32_t Rounds = 4096;
+    const double Start = TEST_Seconds ();
+    uint32_t sum = 0;
+
+    for (uint32_t r = 0; r < Rounds; ++r)
+    {
+        // Pendientes casi todo el buffer, cruzando el final
+        c.outIndex  = (r * 97) & (CAPACITY - 1);
+        c.inIndex   = (c.outIndex - 1) & (CAPACITY - 1);
+        const uint32_t Pending = CYCLIC_Pending (&c);
+
+        if (spans)
+        {
+            uint32_t offset = 0;
+            uint32_t size;
+            const uint8_t *data;
+            while ((data = CYCLIC_PeekSpan (&c, offset, &size)))
+            {
+                for (uint32_t i = 0; i < size; ++i)
+                {
+                    if (handler)
+                    {
+                        handleByte (data[i]);
+                    }
+                    else
+                    {
+                        sum += data[i];
+                    }
+                }
+                offset += size;
+            }
+        }
+        else
+        {
+            for (uint32_t i = 0; i < Pending; ++i)
+            {
+                if (handler)
+                {
+                    handleByte (CYCLIC_Peek (&c, i));
+                }
+                else
+                {
+                    sum += CYCLIC_Peek (&c, i);
+                }
+            }
+        }
+    }
+
+    g_sink += sum;
+    return (double) Rounds * (CAPACITY - 1) / (TEST_Seconds () - Start);
+}
+
+
+// Recorrer lo pendiente con CYCLIC_Peek() byte a byte contra PeekSpan: solo
+// leyendo (el compilador vectoriza la porcion) y llamando a una funcion por
+// byte, como hace INDATA_Prompt()
+static void benchPeekSpan ()
+{
+    memset (g_dataA, 0x11, sizeof(g_dataA));
+
+    for (uint32_t handler = 0; handler < 2; ++handler)
+    {
+        const double Peek = scanRate (false, handler);
+        const double Span = scanRate (true, handler);
+
+        printf ("  %s: %8.1f MB/s peek, %9.1f MB/s spans (%.2fx)\n",
+                handler? "call per byte" : "sum          ",
+                Peek / 1e6, Span / 1e6, Span / Peek);
+    }
+}
+
+
+int main ()
+{
+    srand (1);
+
+    TEST_RUN (testMatchesByteLoop);
+    TEST_RUN (benchChunks);
+    TEST_RUN (testSpans);
+    TEST_RUN (benchPeekSpan);
+    return TEST_END ();
+}
@@ -0,0 +1,357 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "copos.h"
+#include "fsm.h"
+#include "systick.h"
+#include "chip.h"
+#include <stdlib.h>
+
+
+#define EVENTS          2000
+// Pausa maxima entre eventos, en ticks de 1 ms
+#define MAX_GAP         300
+#define ALARM_PERIOD    50
+#define CALLS           10000000
+
+
+enum State
+{
+    State_Idle = 1,
+    State_Alert,
+    State_COUNT
+};
+
+
+enum Event
+{
+    Event_Timeout = FSM_EventTimeout,
+    Event_Sensor,
+    Event_COUNT
+};
+
+
+static struct FEM   g_fem;
+static uint32_t     g_alarmTask;
+static bool         g_sensorFlag;
+static bool         g_queued;
+static uint32_t     g_arrival;
+static uint32_t     g_handled;
+static uint32_t     g_stateCalls;
+static uint32_t     g_transitions;
+static uint32_t     g_latency[EVENTS];
+
+
+// Cada evento del sensor alterna entre los dos estados; el siguiente llega
+// una pausa al azar despues
+static void transition ()
+{
+    ++ g_transitions;
+    if (g_handled < EVENTS)
+    {
+        g_latency[g_handled ++] = SYSTICK_Now () - g_arrival;
+    }
+    g_arrival = SYSTICK_Now () + 1 + (uint32_t) rand () % MAX_GAP;
+}
+
+
+static void tableSensor (struct FEM *f)
+{
+    transition ();
+}
+
+
+static const struct FSM_TableState States[State_COUNT] =
+{
+    [State_Idle]    = { "Idle", NULL, NULL, 0, FSM_StateNone },
+    [State_Alert]   = { "Alert", NULL, NULL, 0, FSM_StateNone },
+};
+
+
+static const struct FSM_Transition Transitions[State_COUNT][Event_COUNT] =
+{
+    [State_Idle]    = { [Event_Sensor] = { State_Alert, NULL, tableSensor } },
+    [State_Alert]   = { [Event_Sensor] = { State_Idle, NULL, tableSensor } },
+};
+
+
+static const struct FSM_Table Table =
+{
+    .states         = States,
+    .transitions    = &Transitions[0][0],
+    .lca            = NULL,
+    .stateCount     = State_COUNT,
+    .eventCount     = Event_COUNT,
+};
+
+
+// Sin cola: cada estado consulta la bandera en cada llamada, como hacia
+// FEMState_Armada con sensorStatus
+static enum FSM_StateReturn legacyAlert (struct FEM *f,
+                                        enum FSM_Stage stage, uint32_t ticks);
+
+static enum FSM_StateReturn legacyIdle (struct FEM *f,
+                                        enum FSM_Stage stage, uint32_t ticks)
+{
+    ++ g_stateCalls;
+    if (stage == FSM_StageBegin)
+    {
+        FSM_GotoStage (f, FSM_StageMain);
+    }
+    else if (g_sensorFlag)
+    {
+        g_sensorFlag = false;
+        transition      ();
+        FSM_ChangeState (f, legacyAlert);
+    }
+    return FSM_StateReturnYield;
+}
+
+
+static enum FSM_StateReturn legacyAlert (struct FEM *f,
+                                        enum FSM_Stage stage, uint32_t ticks)
+{
+    ++ g_stateCalls;
+    if (stage == FSM_StageBegin)
+    {
+        FSM_GotoStage (f, FSM_StageMain);
+    }
+    else if (g_sensorFlag)
+    {
+        g_sensorFlag = false;
+        transition      ();
+        FSM_ChangeState (f, legacyIdle);
+    }
+    return FSM_StateReturnYield;
+}
+
+
+// El sensor cambia en el tick g_arrival, desde el antirebote o una ISR
+static void sensor ()
+{
+    if (g_queued)
+    {
+        FSM_Post (&g_fem, Event_Sensor);
+    }
+    else
+    {
+        g_sensorFlag = true;
+    }
+}
+
+
+static void advance (uint32_t ticks)
+{
+    while (ticks --)
+    {
+        FAKE_SysTickStep (1);
+        if (SYSTICK_Now () == g_arrival)
+        {
+            sensor ();
+        }
+    }
+}
+
+
+static void costTask (void *ctx, uint32_t ticks)
+{
+    advance ((uint32_t)(uintptr_t) ctx);
+}
+
+
+// alarmFEMTask; con la cola solo trabaja si hay eventos pendientes. Como en
+// main.c, sin la cola una corrida atrasada un tick no llama al estado.
+static void alarmTask (void *ctx, uint32_t ticks)
+{
+    if (g_queued && FSM_Pending (&g_fem))
+    {
+        ++ g_stateCalls;
+    }
+    FSM_Process (&g_fem, ticks, 1);
+    advance (1);
+}
+
+
+static void postHook (void *ctx)
+{
+    schedulerSignalTask (g_alarmTask);
+}
+
+
+static int cmpLatency (const void *a, const void *b)
+{
+    const uint32_t A = *(const uint32_t *) a;
+    const uint32_t B = *(const uint32_t *) b;
+    return (A > B) - (A < B);
+}
+
+
+/*
+    Las tareas de main() con alarmFEMTask cada 50 ms. Sin la cola el evento
+    espera la proxima corrida periodica; con la cola FSM_Post() la libera
+    con schedulerSignalTask(), como fsmPostHook() en main.c.
+*/
+static void simulate (bool queued)
+{
+    FAKE_SysTickReset (0);
+    g_queued        = queued;
+    g_sensorFlag    = false;
+    g_handled       = 0;
+    g_stateCalls    = 0;
+
+    if (queued)
+    {
+        TEST_CHECK (FSM_InitTable (&g_fem, &Table, State_Idle, NULL));
+        FSM_SetPostHook (&g_fem, postHook, NULL);
+    }
+    else
+    {
+        FSM_Init        (&g_fem, NULL);
+        FSM_ChangeState (&g_fem, legacyIdle);
+    }
+
+    srand (18);
+    g_arrival = 1 + (uint32_t) rand () % MAX_GAP;
+
+    schedulerInit           ();
+    schedulerSetAutoOffset  (true);
+    const uint32_t RecvTask = schedulerAddTask (costTask, (void *) 1, 0, 14);
+    const uint32_t SendTask = schedulerAddTask (costTask, (void *) 1, 0, 16);
+    schedulerAddTask (costTask, (void *) 5, 0, 140);
+    schedulerAddTask (costTask, (void *) 1, 1, 500);
+    const uint32_t DebounceTask = schedulerAddTask (costTask, (void *) 2, 1,
+                                                    20);
+    schedulerAddTask (costTask, (void *) 2, 1, 20);
+    g_alarmTask = schedulerAddTask (alarmTask, NULL, 0, ALARM_PERIOD);
+    schedulerSetAutoOffset  (false);
+
+    schedulerSetTaskPriority        (RecvTask, 2);
+    schedulerSetTaskPriority        (SendTask, 1);
+    schedulerSetTaskOverrunPolicy   (SendTask, SCHEDULER_OVERRUN_COALESCE);
+    schedulerSetTaskOverrunPolicy   (DebounceTask, SCHEDULER_OVERRUN_SKIP);
+    schedulerSetDispatchPolicy      (SCHEDULER_DISPATCH_PRIORITY);
+    schedulerStart (1);
+
+    while (g_handled < EVENTS)
+    {
+        FAKE_SysTickSleep = 0;
+        schedulerDispatchTasks (SYSTICK_Now ());
+
+        const uint32_t Sleep = FAKE_SysTickSleep;
+        if (Sleep)
+        {
+            const uint32_t ToArrival = g_arrival - SYSTICK_Now ();
+            advance ((ToArrival && ToArrival < Sleep)? ToArrival : Sleep);
+        }
+    }
+
+    const double Seconds = SYSTICK_Now () / 1000.0;
+    qsort (g_latency, EVENTS, sizeof(g_latency[0]), cmpLatency);
+
+    printf ("  %-6s: median %2u ms, p99 %2u ms, max %2u ms, "
+            "%5.1f state calls/s\n", queued? "queue" : "polled",
+            g_latency[EVENTS / 2], g_latency[EVENTS * 99 / 100],
+            g_latency[EVENTS - 1], g_stateCalls / Seconds);
+
+    TEST_CHECK (!g_fem.eventsLost);
+    if (queued)
+    {
+        TEST_CHECK (g_latency[EVENTS - 1] <= 10);
+        // Una llamada por evento
+        TEST_CHECK (g_stateCalls == EVENTS);
+    }
+    else
+    {
+        TEST_CHECK (g_latency[EVENTS / 2] > 10);
+        TEST_CHECK (g_latency[EVENTS - 1] > ALARM_PERIOD);
+        TEST_CHECK (g_stateCalls > EVENTS);
+    }
+}
+
+
+static void benchLatency ()
+{
+    simulate (false);
+    simulate (true);
+}
+
+
+static double callsPerSecond (bool event)
+{
+    const double Start = TEST_Seconds ();
+    for (uint32_t i = 0; i < CALLS; ++i)
+    {
+        if (event)
+        {
+            sensor ();
+        }
+        FSM_Process (&g_fem, 0, 0);
+    }
+    return CALLS / (TEST_Seconds () - Start);
+}
+
+
+// Costo de host de una corrida de alarmFEMTask sin eventos, y transiciones
+// por segundo con un evento antes de cada corrida
+static void benchCalls ()
+{
+    g_handled = EVENTS;
+
+    for (uint32_t q = 0; q < 2; ++q)
+    {
+        g_queued = q;
+        if (g_queued)
+        {
+            FSM_InitTable   (&g_fem, &Table, State_Idle, NULL);
+        }
+        else
+        {
+            FSM_Init        (&g_fem, NULL);
+            FSM_ChangeState (&g_fem, legacyIdle);
+        }
+
+        const double Idle = callsPerSecond (false);
+        g_transitions = 0;
+        const double Calls = callsPerSecond (true);
+        const double Transitions = Calls * g_transitions / CALLS;
+
+        printf ("  %-6s: %6.1f M calls/s idle, %5.1f M transitions/s\n",
+                q? "queue" : "polled", Idle * 1e-6, Transitions * 1e-6);
+    }
+}
+
+
+int main ()
+{
+    TEST_RUN (benchLatency);
+    TEST_RUN (benchCalls);
+    return TEST_END ();
+}
@@ -0,0 +1,200 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "copos.h"
+#include "uart.h"
+#include "systick.h"
+#include "chip.h"
+#include <stdlib.h>
+
+
+#define BYTES           2000
+// Pausa maxima entre bytes recibidos, en ticks de 1 ms
+#define MAX_GAP         300
+
+
+static struct UART  g_uart;
+static uint32_t     g_processTask;
+static uint32_t     g_arrival;
+static uint32_t     g_received;
+static uint32_t     g_latency[BYTES];
+
+
+// El byte que sigue llega por RX en el tick g_arrival: la USART falsa lo
+// pone en la FIFO y, con el character timeout, llama a la ISR de la UART
+static void arrive ()
+{
+    static const uint8_t Byte = 'i';
+
+    FAKE_UartSetRxLine (LPC_USART2, &Byte, 1);
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        FAKE_UartStep (LPC_USART2);
+    }
+}
+
+
+// Avanza el reloj de a un tick, recibiendo los bytes cuando llegan (tambien
+// en medio de una tarea)
+static void advance (uint32_t ticks)
+{
+    while (ticks --)
+    {
+        FAKE_SysTickStep (1);
+        if (SYSTICK_Now () == g_arrival)
+        {
+            arrive ();
+        }
+    }
+}
+
+
+// Otras tareas de main.c, con un costo supuesto en ticks
+static void costTask (void *ctx, uint32_t ticks)
+{
+    advance ((uint32_t)(uintptr_t) ctx);
+}
+
+
+// uartProcessTask hasta processCommand(): latencia desde la llegada del byte
+static void processTask (void *ctx, uint32_t ticks)
+{
+    if (!UART_RecvPendingCount (&g_uart))
+    {
+        return;
+    }
+
+    UART_RecvDiscardPending (&g_uart);
+    g_latency[g_received ++] = SYSTICK_Now () - g_arrival;
+
+    // Procesar dura un tick: el proximo byte puede llegar mientras tanto y
+    // su senal no debe perderse en esta corrida
+    g_arrival = SYSTICK_Now () + 1 + (uint32_t) rand () % MAX_GAP;
+    advance (1);
+}
+
+
+static void recvHook (void *ctx)
+{
+    schedulerSignalTask (g_processTask);
+}
+
+
+static int cmpLatency (const void *a, const void *b)
+{
+    const uint32_t A = *(const uint32_t *) a;
+    const uint32_t B = *(const uint32_t *) b;
+    return (A > B) - (A < B);
+}
+
+
+/*
+    Las tareas de main() con la UART en modo DMA. Con 'signal' la ISR de
+    recepcion libera uartProcessTask como en main.c; sin el, el byte espera
+    la proxima corrida periodica (140 ms).
+*/
+static void simulate (bool signal)
+{
+    FAKE_Reset          ();
+    FAKE_SysTickReset   (0);
+    UART_Init           (&g_uart, LPC_USART2, 921600);
+    TEST_CHECK          (UART_SetMode (&g_uart, UART_ModeDma));
+    UART_SetRecvHook    (&g_uart, signal? recvHook : NULL, NULL);
+
+    srand (1);
+    g_received  = 0;
+    g_arrival   = 1 + (uint32_t) rand () % MAX_GAP;
+
+    schedulerInit           ();
+    schedulerSetAutoOffset  (true);
+    const uint32_t RecvTask = schedulerAddTask (costTask, (void *) 1, 0, 14);
+    const uint32_t SendTask = schedulerAddTask (costTask, (void *) 1, 0, 16);
+    g_processTask = schedulerAddTask (processTask, NULL, 0, 140);
+    schedulerAddTask (costTask, (void *) 1, 1, 500);
+    const uint32_t DebounceTask = schedulerAddTask (costTask, (void *) 2, 1,
+                                                    20);
+    schedulerAddTask (costTask, (void *) 2, 1, 20);
+    schedulerAddTask (costTask, (void *) 3, 0, 50);
+    schedulerSetAutoOffset  (false);
+
+    schedulerSetTaskPriority        (RecvTask, 2);
+    schedulerSetTaskPriority        (SendTask, 1);
+    schedulerSetTaskOverrunPolicy   (SendTask, SCHEDULER_OVERRUN_COALESCE);
+    schedulerSetTaskOverrunPolicy   (DebounceTask, SCHEDULER_OVERRUN_SKIP);
+    schedulerSetDispatchPolicy      (SCHEDULER_DISPATCH_PRIORITY);
+    schedulerStart (1);
+
+    while (g_received < BYTES)
+    {
+        FAKE_SysTickSleep = 0;
+        schedulerDispatchTasks (SYSTICK_Now ());
+
+        // Duerme hasta la proxima tarea; la interrupcion de RX despierta
+        // antes
+        const uint32_t Sleep = FAKE_SysTickSleep;
+        if (Sleep)
+        {
+            const uint32_t ToArrival = g_arrival - SYSTICK_Now ();
+            advance ((ToArrival && ToArrival < Sleep)? ToArrival : Sleep);
+        }
+    }
+
+    qsort (g_latency, BYTES, sizeof(g_latency[0]), cmpLatency);
+
+    printf ("  %s: median %3u ms, p99 %3u ms, max %3u ms\n",
+            signal? "signaled" : "periodic", g_latency[BYTES / 2],
+            g_latency[BYTES * 99 / 100], g_latency[BYTES - 1]);
+
+    if (signal)
+    {
+        // A lo sumo la tarea en curso mas las de mayor prioridad
+        TEST_CHECK (g_latency[BYTES - 1] <= 5);
+    }
+    else
+    {
+        TEST_CHECK (g_latency[BYTES / 2] > 20);
+        TEST_CHECK (g_latency[BYTES - 1] < 140 + 10);
+    }
+}
+
+
+static void benchSignal ()
+{
+    simulate (false);
+    simulate (true);
+}
+
+
+int main ()
+{
+    TEST_RUN (benchSignal);
+    return TEST_END ();
+}
@@ -0,0 +1,135 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "uart_util.h"
+#include "template.h"
+#include "text.h"
+#include "text_app.h"
+#include "chip.h"
+#include <stdlib.h>
+
+
+#define RENDERS     200000
+
+
+static struct UART      g_uart;
+
+
+// Lo que quedo en el buffer de envio, y lo descarta
+static uint32_t takeOutput (uint8_t *out, uint32_t size)
+{
+    const uint32_t Pending = UART_SendPendingCount (&g_uart);
+    const uint32_t Count = (Pending < size)? Pending : size;
+    CYCLIC_OutToBuffer      (&g_uart.send, out, Count);
+    CYCLIC_DiscardPending   (&g_uart.send);
+    return Count;
+}
+
+
+static void setArgs (struct VARIANT *args)
+{
+    for (uint32_t i = 0; i < 9; ++i)
+    {
+        VARIANT_SetUint32 (&args[i], (uint32_t) rand ());
+    }
+}
+
+
+// Cada template de la tabla produce lo mismo que el recorrido de msg
+static void testTableMatchesScan ()
+{
+    static char     copy    [512];
+    static uint8_t  a       [1024];
+    static uint8_t  b       [1024];
+    struct VARIANT  args    [9];
+
+    printf ("  %u templates in flash\n", TEMPLATE_TableCount);
+
+    for (uint32_t i = 0; i < TEMPLATE_TableCount; ++i)
+    {
+        const char *Msg = *TEMPLATE_Table[i].text;
+        strncpy (copy, Msg, sizeof(copy) - 1);
+
+        setArgs (args);
+        TEST_CHECK (TEMPLATE_Find (Msg) == &TEMPLATE_Table[i]);
+        TEST_CHECK (TEMPLATE_Find (copy) == NULL);
+
+        UART_PutMessageArgs (&g_uart, Msg, args, 9);
+        const uint32_t SizeA = takeOutput (a, sizeof(a));
+        UART_PutMessageArgs (&g_uart, copy, args, 9);
+        const uint32_t SizeB = takeOutput (b, sizeof(b));
+
+        TEST_CHECK (SizeA == SizeB && !memcmp (a, b, SizeA));
+    }
+}
+
+
+static double render (const char *msg, struct VARIANT *args)
+{
+    const uint64_t Start = TEST_Cycles ();
+    for (uint32_t i = 0; i < RENDERS; ++i)
+    {
+        UART_PutMessageArgs     (&g_uart, msg, args, 6);
+        CYCLIC_DiscardPending   (&g_uart.send);
+    }
+    return (double)(TEST_Cycles () - Start) / RENDERS;
+}
+
+
+// TEXT_UART_STATS1: recorrido de msg en cada envio contra la tabla
+static void benchUartStats1 ()
+{
+    static char     copy[512];
+    struct VARIANT  args[9];
+
+    setArgs (args);
+    strncpy (copy, TEXT_UART_STATS1, sizeof(copy) - 1);
+
+    const double Scan  = render (copy, args);
+    const double Table = render (TEXT_UART_STATS1, args);
+
+    printf ("  TEXT_UART_STATS1: %.0f " TEST_CYCLES_UNIT "/render scanning, "
+            "%.0f with the table (%.2fx)\n", Scan, Table, Scan / Table);
+
+    TEST_CHECK (Table < Scan);
+}
+
+
+int main ()
+{
+    srand (1);
+    FAKE_Reset  ();
+    UART_Init   (&g_uart, LPC_USART2, 115200);
+
+    TEST_RUN (testTableMatchesScan);
+    TEST_RUN (benchUartStats1);
+    return TEST_END ();
+}
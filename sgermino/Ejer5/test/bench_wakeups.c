@@ -0,0 +1,135 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "copos.h"
+#include "systick.h"
+#include "chip.h"
+
+
+// Se compila con SCHEDULER_TICKLESS en 1 (bench_wakeups) y en 0
+// (bench_wakeups_ticked): el mismo main.c con y sin sueno entre tareas
+#if SCHEDULER_TICKLESS
+    #define MODE        "tickless"
+#else
+    #define MODE        "ticked  "
+#endif
+
+// Un hiperperiodo de las tareas de main.c, con tick de 1 ms
+#define HYPERPERIOD     14000
+
+
+static uint32_t g_runs;
+
+
+static void task (void *ctx, uint32_t ticks)
+{
+    ++ g_runs;
+}
+
+
+// Las tareas de main() con sus retardos, prioridades y politicas
+static void addMainTasks ()
+{
+    schedulerInit           ();
+    schedulerSetAutoOffset  (true);
+
+    const uint32_t RecvTask = schedulerAddTask (task, NULL, 0, 14);
+    const uint32_t SendTask = schedulerAddTask (task, NULL, 0, 16);
+    schedulerAddTask (task, NULL, 0, 140);
+    schedulerAddTask (task, NULL, 1, 500);
+    const uint32_t DebounceTask = schedulerAddTask (task, NULL, 1, 20);
+    schedulerAddTask (task, NULL, 1, 20);
+    schedulerAddTask (task, NULL, 0, 50);
+
+    schedulerSetTaskPriority        (RecvTask, 2);
+    schedulerSetTaskPriority        (SendTask, 1);
+    schedulerSetTaskOverrunPolicy   (SendTask, SCHEDULER_OVERRUN_COALESCE);
+    schedulerSetTaskOverrunPolicy   (DebounceTask, SCHEDULER_OVERRUN_SKIP);
+    schedulerSetDispatchPolicy      (SCHEDULER_DISPATCH_PRIORITY);
+}
+
+
+/*
+    Despertares del nucleo por segundo sin entradas (sin bytes por UART ni
+    timers de la MEF). Cada vuelta del loop de main() termina en un WFI o en
+    SYSTICK_Sleep(): sin tickless despierta en cada tick, con tickless solo
+    cuando vence la proxima tarea.
+*/
+static void simWakeups ()
+{
+    FAKE_SysTickReset (0);
+    addMainTasks ();
+    schedulerStart (1);
+
+    uint32_t wakeUps = 0;
+    g_runs = 0;
+
+    while (SYSTICK_Now () < HYPERPERIOD)
+    {
+        FAKE_SysTickSleep = 0;
+        schedulerDispatchTasks (SYSTICK_Now ());
+
+#if SCHEDULER_TICKLESS
+        if (!FAKE_SysTickSleep)
+        {
+            // Una tarea quedo lista: SYSTICK_Sleep() vuelve sin dormir
+            continue;
+        }
+        FAKE_SysTickStep (FAKE_SysTickSleep);
+#else
+        FAKE_SysTickStep (1);
+#endif
+        ++ wakeUps;
+    }
+
+    // 7 tareas de periodos 14, 16, 140, 500, 20, 20 y 50 ms
+    const uint32_t Releases = HYPERPERIOD / 14 + HYPERPERIOD / 16
+                              + HYPERPERIOD / 140 + HYPERPERIOD / 500
+                              + 2 * (HYPERPERIOD / 20) + HYPERPERIOD / 50;
+
+    TEST_CHECK (g_runs >= Releases - 7 && g_runs <= Releases);
+#if SCHEDULER_TICKLESS
+    // A lo sumo un despertar por tick con alguna tarea
+    TEST_CHECK (wakeUps <= g_runs);
+#else
+    TEST_CHECK (wakeUps == HYPERPERIOD);
+#endif
+
+    printf ("  %s: %.1f wakeups/s, %.1f task runs/s\n", MODE,
+            wakeUps * 1000.0 / HYPERPERIOD, g_runs * 1000.0 / HYPERPERIOD);
+}
+
+
+int main ()
+{
+    TEST_RUN (simWakeups);
+    return TEST_END ();
+}
@@ -0,0 +1,462 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "chip.h"
+#include <string.h>
+
+
+// Handlers definidos por el codigo bajo prueba
+void    UART0_IRQHandler    (void);
+void    UART1_IRQHandler    (void);
+void    UART2_IRQHandler    (void);
+void    UART3_IRQHandler    (void);
+void    DMA_IRQHandler      (void);
+
+
+LPC_USART_T     FAKE_Usart[4];
+LPC_GPDMA_T     FAKE_Gpdma;
+
+static bool     g_nvicEnabled[FAKE_IRQ_COUNT];
+
+static void     (* const g_uartHandler[4]) (void) = { UART0_IRQHandler,
+                                                      UART1_IRQHandler,
+                                                      UART2_IRQHandler,
+                                                      UART3_IRQHandler };
+
+
+void FAKE_Reset ()
+{
+    memset (FAKE_Usart, 0, sizeof(FAKE_Usart));
+    memset (&FAKE_Gpdma, 0, sizeof(FAKE_Gpdma));
+    memset (g_nvicEnabled, 0, sizeof(g_nvicEnabled));
+
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        FAKE_Usart[i].irq = USART0_IRQn + i;
+    }
+}
+
+
+static void dmaDispatch ();
+
+
+// Una interrupcion pendiente se atiende apenas se habilita
+void NVIC_EnableIRQ (IRQn_Type irq)
+{
+    g_nvicEnabled[irq] = true;
+    if (irq == DMA_IRQn)
+    {
+        dmaDispatch ();
+    }
+}
+
+
+void NVIC_DisableIRQ (IRQn_Type irq)
+{
+    g_nvicEnabled[irq] = false;
+}
+
+
+void NVIC_ClearPendingIRQ (IRQn_Type irq)
+{
+    (void) irq;
+}
+
+
+bool FAKE_NvicEnabled (IRQn_Type irq)
+{
+    return g_nvicEnabled[irq];
+}
+
+
+static uint32_t rxTriggerLevel (LPC_USART_T *u)
+{
+    static const uint32_t Level[4] = { 1, 4, 8, 14 };
+    return Level[(u->FCR >> 6) & 3];
+}
+
+
+// Identificacion de la interrupcion de mayor prioridad, como IIR
+static uint32_t pendingId (LPC_USART_T *u)
+{
+    if ((u->IER & UART_IER_RLSINT) && (u->LSR & UART_LSR_OE))
+    {
+        return UART_IIR_INTID_RLS;
+    }
+    if ((u->IER & UART_IER_RBRINT) && u->rxCount >= rxTriggerLevel (u))
+    {
+        return UART_IIR_INTID_RDA;
+    }
+    // Character timeout: datos en la FIFO y ~4 caracteres sin actividad
+    if ((u->IER & UART_IER_RBRINT) && u->rxCount && u->rxIdle >= 4)
+    {
+        return UART_IIR_INTID_CTI;
+    }
+    if ((u->IER & UART_IER_THREINT) && u->threPending)
+    {
+        return UART_IIR_INTID_THRE;
+    }
+    return UART_IIR_INTSTAT_PEND;
+}
+
+
+void Chip_UART_Init (LPC_USART_T *u)
+{
+    u->IER          = 0;
+    u->FCR          = 0;
+    u->LCR          = 0;
+    u->LSR          = 0;
+    u->rxCount      = 0;
+    u->txCount      = 0;
+    u->threPending  = false;
+    u->rxIdle       = 0;
+}
+
+
+uint32_t Chip_UART_SetBaudFDR (LPC_USART_T *u, uint32_t baudRate)
+{
+    u->baudRate = baudRate;
+    return baudRate;
+}
+
+
+void Chip_UART_ConfigData (LPC_USART_T *u, uint32_t config)
+{
+    u->LCR = config;
+}
+
+
+void Chip_UART_TXEnable (LPC_USART_T *u)
+{
+    (void) u;
+}
+
+
+void Chip_UART_SetupFIFOS (LPC_USART_T *u, uint32_t fcr)
+{
+    u->FCR = fcr;
+}
+
+
+void Chip_UART_IntEnable (LPC_USART_T *u, uint32_t mask)
+{
+    // Habilitar THRE con la FIFO vacia genera la interrupcion, como el 16550
+    if ((mask & UART_IER_THREINT) && !(u->IER & UART_IER_THREINT) &&
+        !u->txCount)
+    {
+        u->threPending = true;
+    }
+    u->IER |= mask;
+}
+
+
+void Chip_UART_IntDisable (LPC_USART_T *u, uint32_t mask)
+{
+    u->IER &= ~mask;
+}
+
+
+uint32_t Chip_UART_GetIntsEnabled (LPC_USART_T *u)
+{
+    return u->IER;
+}
+
+
+uint32_t Chip_UART_ReadIntIDReg (LPC_USART_T *u)
+{
+    const uint32_t Id = pendingId (u);
+    if (Id == UART_IIR_INTID_THRE)
+    {
+        u->threPending = false;
+    }
+    return Id;
+}
+
+
+// Leer LSR limpia OE, como en el periferico
+uint32_t Chip_UART_ReadLineStatus (LPC_USART_T *u)
+{
+    uint32_t lsr = u->LSR & UART_LSR_OE;
+
+    if (u->rxCount)
+    {
+        lsr |= UART_LSR_RDR;
+    }
+    if (!u->txCount)
+    {
+        lsr |= UART_LSR_THRE | UART_LSR_TEMT;
+    }
+
+    u->LSR &= ~UART_LSR_OE;
+    return lsr;
+}
+
+
+uint8_t Chip_UART_ReadByte (LPC_USART_T *u)
+{
+    if (!u->rxCount)
+    {
+        return 0;
+    }
+
+    const uint8_t Data = u->rxFifo[0];
+    memmove (u->rxFifo, &u->rxFifo[1], -- u->rxCount);
+    u->rxIdle = 0;
+
+    if (u->overrunOnRead && !(-- u->overrunOnRead))
+    {
+        u->LSR |= UART_LSR_OE;
+        ++ u->rxLost;
+    }
+    return Data;
+}
+
+
+void Chip_UART_SendByte (LPC_USART_T *u, uint8_t data)
+{
+    if (u->txCount < FAKE_UART_FIFO_SIZE)
+    {
+        u->txFifo[u->txCount ++] = data;
+    }
+    u->threPending = false;
+}
+
+
+void FAKE_UartSetRxLine (LPC_USART_T *u, const uint8_t *data, uint32_t size)
+{
+    u->rxLine       = data;
+    u->rxLineSize   = size;
+    u->rxLineIndex  = 0;
+}
+
+
+uint32_t FAKE_UartCharNs (LPC_USART_T *u)
+{
+    return u->baudRate? 10000000000ull / u->baudRate : 0;
+}
+
+
+static void dmaService (LPC_USART_T *u);
+
+
+void FAKE_UartStep (LPC_USART_T *u)
+{
+    // TX: el shift register saca un byte de la FIFO
+    if (u->txCount)
+    {
+        if (u->txLineSize < FAKE_UART_LINE_SIZE)
+        {
+            u->txLine[u->txLineSize ++] = u->txFifo[0];
+        }
+        memmove (u->txFifo, &u->txFifo[1], -- u->txCount);
+        if (!u->txCount)
+        {
+            u->threPending = true;
+        }
+    }
+
+    dmaService  (u);
+    dmaDispatch ();
+
+    // RX: llega un byte, si la FIFO esta llena se pierde (overrun)
+    if (u->rxLineIndex < u->rxLineSize)
+    {
+        const uint8_t Data = u->rxLine[u->rxLineIndex ++];
+        if (u->rxCount < FAKE_UART_FIFO_SIZE)
+        {
+            u->rxFifo[u->rxCount ++] = Data;
+        }
+        else
+        {
+            u->LSR |= UART_LSR_OE;
+            ++ u->rxLost;
+        }
+        u->rxIdle = 0;
+    }
+    else
+    {
+        ++ u->rxIdle;
+    }
+
+    // NVIC: interrupcion por nivel mientras haya una causa pendiente
+    const uint32_t Index = (uint32_t)(u - FAKE_Usart);
+    for (uint32_t i = 0; i < 4 && g_nvicEnabled[u->irq] &&
+                         pendingId (u) != UART_IIR_INTSTAT_PEND; ++i)
+    {
+        ++ u->irqCalls;
+        g_uartHandler[Index] ();
+    }
+}
+
+
+void Chip_GPDMA_Init (LPC_GPDMA_T *g)
+{
+    memset (g->CH, 0, sizeof(g->CH));
+}
+
+
+// Como LPCOpen: devuelve 0 tambien cuando no hay canales libres
+uint8_t Chip_GPDMA_GetFreeChannel (LPC_GPDMA_T *g, uint32_t connection)
+{
+    (void) connection;
+
+    for (uint8_t i = 0; i < GPDMA_NUMBER_CHANNELS; ++i)
+    {
+        if (!g->CH[i].allocated && !g->CH[i].enabled)
+        {
+            g->CH[i].allocated = true;
+            return i;
+        }
+    }
+    return 0;
+}
+
+
+Status Chip_GPDMA_Transfer (LPC_GPDMA_T *g, uint8_t channel, uint32_t src,
+                            uint32_t dst, GPDMA_FLOW_CONTROL_T type,
+                            uint32_t size)
+{
+    FAKE_GPDMA_CH_T *ch = &g->CH[channel];
+
+    if (ch->enabled || type != GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA ||
+        !size)
+    {
+        return ERROR;
+    }
+
+    ch->enabled     = true;
+    ch->intTc       = false;
+    ch->src         = (const uint8_t *)(uintptr_t) src;
+    ch->remaining   = size;
+    ch->connection  = dst;
+
+    if (g->logCount < FAKE_GPDMA_LOG_SIZE)
+    {
+        g->log[g->logCount].src  = src;
+        g->log[g->logCount].size = size;
+    }
+    ++ g->logCount;
+    return SUCCESS;
+}
+
+
+Status Chip_GPDMA_Interrupt (LPC_GPDMA_T *g, uint8_t channel)
+{
+    if (g->CH[channel].intTc)
+    {
+        g->CH[channel].intTc = false;
+        return SUCCESS;
+    }
+    return ERROR;
+}
+
+
+IntStatus Chip_GPDMA_IntGetStatus (LPC_GPDMA_T *g, GPDMA_STATUS_T type,
+                                   uint8_t channel)
+{
+    switch (type)
+    {
+        case GPDMA_STAT_INT:
+        case GPDMA_STAT_INTTC:
+        case GPDMA_STAT_RAWINTTC:
+            return g->CH[channel].intTc? SET : RESET;
+
+        case GPDMA_STAT_ENABLED_CH:
+            return g->CH[channel].enabled? SET : RESET;
+
+        default:
+            break;
+    }
+    return RESET;
+}
+
+
+void Chip_GPDMA_Stop (LPC_GPDMA_T *g, uint8_t channel)
+{
+    memset (&g->CH[channel], 0, sizeof(FAKE_GPDMA_CH_T));
+}
+
+
+static bool dmaIntPending ()
+{
+    for (uint32_t i = 0; i < GPDMA_NUMBER_CHANNELS; ++i)
+    {
+        if (FAKE_Gpdma.CH[i].intTc)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+static void dmaDispatch ()
+{
+    for (uint32_t i = 0; i < 4 && g_nvicEnabled[DMA_IRQn] &&
+                         dmaIntPending (); ++i)
+    {
+        ++ FAKE_Gpdma.irqCalls;
+        DMA_IRQHandler ();
+    }
+}
+
+
+// Pedidos de la USART en modo DMA: llena la FIFO de TX desde el canal
+static void dmaService (LPC_USART_T *u)
+{
+    if (!(u->FCR & UART_FCR_DMAMODE_SEL))
+    {
+        return;
+    }
+
+    const uint32_t Connection = GPDMA_CONN_UART0_Tx +
+                                4 * (uint32_t)(u - FAKE_Usart);
+
+    for (uint32_t i = 0; i < GPDMA_NUMBER_CHANNELS; ++i)
+    {
+        FAKE_GPDMA_CH_T *ch = &FAKE_Gpdma.CH[i];
+        if (!ch->enabled || ch->connection != Connection)
+        {
+            continue;
+        }
+
+        while (ch->remaining && u->txCount < FAKE_UART_FIFO_SIZE)
+        {
+            u->txFifo[u->txCount ++] = *ch->src ++;
+            -- ch->remaining;
+        }
+
+        if (!ch->remaining)
+        {
+            ch->enabled = false;
+            ch->intTc   = true;
+        }
+    }
+}
@@ -0,0 +1,294 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+
+// Reemplazo de host del chip.h de LPCOpen: solo lo que usan los fuentes de
+// Ejer5 probados en test/. Los registros de la USART son un modelo que
+// avanza por tiempos de caracter (ver FAKE_UartStep()) y llama a los
+// handlers de interrupcion como lo haria el NVIC.
+
+
+typedef enum { ERROR = 0, SUCCESS = !ERROR } Status;
+typedef enum { RESET = 0, SET = !RESET } IntStatus;
+
+
+// --- NVIC -------------------------------------------------------------------
+
+typedef enum
+{
+    DMA_IRQn        = 2,
+    USART0_IRQn     = 24,
+    UART1_IRQn      = 25,
+    USART2_IRQn     = 26,
+    USART3_IRQn     = 27,
+    FAKE_IRQ_COUNT  = 64
+}
+IRQn_Type;
+
+
+void        NVIC_EnableIRQ          (IRQn_Type irq);
+void        NVIC_DisableIRQ         (IRQn_Type irq);
+void        NVIC_ClearPendingIRQ    (IRQn_Type irq);
+bool        FAKE_NvicEnabled        (IRQn_Type irq);
+
+
+// --- SysTick (fake/systick.c reemplaza a src/systick.c) -------------------
+
+// Ultimo pedido a SYSTICK_Sleep()
+extern uint32_t     FAKE_SysTickSleep;
+
+void        FAKE_SysTickReset       (uint32_t now);
+void        FAKE_SysTickStep        (uint32_t ticks);
+
+
+// --- USART ------------------------------------------------------------------
+
+#define UART_IER_RBRINT         (1 << 0)
+#define UART_IER_THREINT        (1 << 1)
+#define UART_IER_RLSINT         (1 << 2)
+
+#define UART_IIR_INTSTAT_PEND   (1 << 0)
+#define UART_IIR_INTID_RLS      (3 << 1)
+#define UART_IIR_INTID_RDA      (2 << 1)
+#define UART_IIR_INTID_CTI      (6 << 1)
+#define UART_IIR_INTID_THRE     (1 << 1)
+
+#define UART_FCR_FIFO_EN        (1 << 0)
+#define UART_FCR_DMAMODE_SEL    (1 << 3)
+#define UART_FCR_TRG_LEV0       (0)
+#define UART_FCR_TRG_LEV1       (1 << 6)
+#define UART_FCR_TRG_LEV2       (2 << 6)
+#define UART_FCR_TRG_LEV3       (3 << 6)
+
+#define UART_LCR_WLEN8          (3 << 0)
+#define UART_LCR_SBS_1BIT       (0 << 2)
+#define UART_LCR_PARITY_DIS     (0 << 3)
+
+#define UART_LSR_RDR            (1 << 0)
+#define UART_LSR_OE             (1 << 1)
+#define UART_LSR_THRE           (1 << 5)
+#define UART_LSR_TEMT           (1 << 6)
+
+#define FAKE_UART_FIFO_SIZE     16
+#define FAKE_UART_LINE_SIZE     (256 * 1024)
+
+
+// Registros con el nombre de LPCOpen mas el estado interno del modelo
+typedef struct
+{
+    uint32_t        IER;
+    uint32_t        FCR;
+    uint32_t        LCR;
+    uint32_t        LSR;
+    uint32_t        baudRate;
+    IRQn_Type       irq;
+    // FIFOs de hardware
+    uint8_t         rxFifo      [FAKE_UART_FIFO_SIZE];
+    uint32_t        rxCount;
+    uint8_t         txFifo      [FAKE_UART_FIFO_SIZE];
+    uint32_t        txCount;
+    // THRE pendiente hasta leer IIR o escribir THR
+    bool            threPending;
+    // Caracteres sin actividad de RX, para el character timeout (CTI)
+    uint32_t        rxIdle;
+    // Linea: lo que llega por RX y lo que salio por TX
+    const uint8_t   *rxLine;
+    uint32_t        rxLineSize;
+    uint32_t        rxLineIndex;
+    uint8_t         txLine      [FAKE_UART_LINE_SIZE];
+    uint32_t        txLineSize;
+    // Estadisticas del modelo
+    uint32_t        rxLost;
+    uint32_t        irqCalls;
+    // Si no es cero, OE se activa al leer ese numero de bytes de RBR
+    uint32_t        overrunOnRead;
+}
+LPC_USART_T;
+
+
+extern LPC_USART_T      FAKE_Usart[4];
+
+#define LPC_USART0      (&FAKE_Usart[0])
+#define LPC_UART1       (&FAKE_Usart[1])
+#define LPC_USART2      (&FAKE_Usart[2])
+#define LPC_USART3      (&FAKE_Usart[3])
+
+
+void        Chip_UART_Init          (LPC_USART_T *u);
+uint32_t    Chip_UART_SetBaudFDR    (LPC_USART_T *u, uint32_t baudRate);
+void        Chip_UART_ConfigData    (LPC_USART_T *u, uint32_t config);
+void        Chip_UART_TXEnable      (LPC_USART_T *u);
+void        Chip_UART_SetupFIFOS    (LPC_USART_T *u, uint32_t fcr);
+void        Chip_UART_IntEnable     (LPC_USART_T *u, uint32_t mask);
+void        Chip_UART_IntDisable    (LPC_USART_T *u, uint32_t mask);
+uint32_t    Chip_UART_GetIntsEnabled(LPC_USART_T *u);
+uint32_t    Chip_UART_ReadIntIDReg  (LPC_USART_T *u);
+uint32_t    Chip_UART_ReadLineStatus(LPC_USART_T *u);
+uint8_t     Chip_UART_ReadByte      (LPC_USART_T *u);
+void        Chip_UART_SendByte      (LPC_USART_T *u, uint8_t data);
+
+// Reinicia el modelo completo (USARTs, NVIC y GPDMA)
+void        FAKE_Reset              ();
+// Bytes que llegaran por RX, uno por tiempo de caracter
+void        FAKE_UartSetRxLine      (LPC_USART_T *u, const uint8_t *data,
+                                     uint32_t size);
+// Avanza un tiempo de caracter: sale un byte de TX, entra uno de RX y se
+// atienden las interrupciones habilitadas
+void        FAKE_UartStep           (LPC_USART_T *u);
+// Nanosegundos por caracter (8N1: 10 bits)
+uint32_t    FAKE_UartCharNs         (LPC_USART_T *u);
+
+
+// --- GPDMA ------------------------------------------------------------------
+
+#define GPDMA_NUMBER_CHANNELS       8
+
+#define GPDMA_CONN_UART0_Tx         ((2UL))
+#define GPDMA_CONN_UART1_Tx         ((6UL))
+#define GPDMA_CONN_UART2_Tx         ((10UL))
+#define GPDMA_CONN_UART3_Tx         ((14UL))
+
+typedef enum
+{
+    GPDMA_STAT_INT,
+    GPDMA_STAT_INTTC,
+    GPDMA_STAT_INTERR,
+    GPDMA_STAT_RAWINTTC,
+    GPDMA_STAT_RAWINTERR,
+    GPDMA_STAT_ENABLED_CH
+}
+GPDMA_STATUS_T;
+
+typedef enum
+{
+    GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA,
+    GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA,
+    GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA,
+    GPDMA_TRANSFERTYPE_P2P_CONTROLLER_DMA
+}
+GPDMA_FLOW_CONTROL_T;
+
+#define FAKE_GPDMA_LOG_SIZE         1024
+
+
+// Canal simulado: lee la memoria de origen recien cuando la USART tiene
+// lugar en la FIFO, como el GPDMA real con control de flujo del periferico
+typedef struct
+{
+    bool            allocated;
+    bool            enabled;
+    bool            intTc;
+    const uint8_t   *src;
+    uint32_t        remaining;
+    uint32_t        connection;
+}
+FAKE_GPDMA_CH_T;
+
+typedef struct
+{
+    uint32_t        src;
+    uint32_t        size;
+}
+FAKE_GPDMA_LOG_T;
+
+typedef struct
+{
+    FAKE_GPDMA_CH_T     CH          [GPDMA_NUMBER_CHANNELS];
+    // Transferencias iniciadas, en orden
+    FAKE_GPDMA_LOG_T    log         [FAKE_GPDMA_LOG_SIZE];
+    uint32_t            logCount;
+    uint32_t            irqCalls;
+}
+LPC_GPDMA_T;
+
+
+extern LPC_GPDMA_T      FAKE_Gpdma;
+
+#define LPC_GPDMA       (&FAKE_Gpdma)
+
+
+void        Chip_GPDMA_Init         (LPC_GPDMA_T *g);
+uint8_t     Chip_GPDMA_GetFreeChannel
+                                    (LPC_GPDMA_T *g, uint32_t connection);
+Status      Chip_GPDMA_Transfer     (LPC_GPDMA_T *g, uint8_t channel,
+                                     uint32_t src, uint32_t dst,
+                                     GPDMA_FLOW_CONTROL_T type,
+                                     uint32_t size);
+Status      Chip_GPDMA_Interrupt    (LPC_GPDMA_T *g, uint8_t channel);
+IntStatus   Chip_GPDMA_IntGetStatus (LPC_GPDMA_T *g, GPDMA_STATUS_T type,
+                                     uint8_t channel);
+void        Chip_GPDMA_Stop         (LPC_GPDMA_T *g, uint8_t channel);
+
+
+// --- EEPROM e IAP (fake/eeprom.c) -------------------------------------------
+
+#define EEPROM_PAGE_SIZE        128
+#define EEPROM_PAGE_NUM         128
+#define EEPROM_AUTOPROG_OFF     0
+
+// Las paginas son RAM: lo escrito se lee enseguida, sin modelar el registro
+// de pagina. Chip_EEPROM_EraseProgramPage() solo cuenta la programacion.
+#define EEPROM_ADDRESS(page, offset) \
+    ((uintptr_t) &FAKE_Eeprom[(page)][0] + (offset))
+
+#define IAP_CMD_SUCCESS         0
+#define IAP_INVALID_COMMAND     1
+
+
+typedef struct
+{
+    uint32_t    AUTOPROG;
+}
+LPC_EEPROM_T;
+
+
+extern LPC_EEPROM_T     FAKE_EepromRegs;
+extern uint8_t          FAKE_Eeprom[EEPROM_PAGE_NUM][EEPROM_PAGE_SIZE];
+extern uint32_t         FAKE_EepromInits;
+extern uint32_t         FAKE_EepromPrograms;
+// ID que devuelve Chip_IAP_ReadUID() y cuantas veces se leyo
+extern uint32_t         FAKE_IapUid[4];
+extern uint32_t         FAKE_IapUidReads;
+
+#define LPC_EEPROM      (&FAKE_EepromRegs)
+
+
+void        Chip_EEPROM_Init        (LPC_EEPROM_T *e);
+void        Chip_EEPROM_SetAutoProg (LPC_EEPROM_T *e, uint32_t mode);
+void        Chip_EEPROM_EraseProgramPage
+                                    (LPC_EEPROM_T *e);
+uint8_t     Chip_IAP_init           (void);
+// Sin Chip_IAP_init() previo devuelve IAP_INVALID_COMMAND
+uint32_t    Chip_IAP_ReadUID        (uint32_t uid[]);
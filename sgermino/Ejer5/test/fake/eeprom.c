@@ -0,0 +1,85 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "chip.h"
+#include <string.h>
+
+
+// Modelo de host de la EEPROM interna y del ID de chip por IAP
+
+LPC_EEPROM_T    FAKE_EepromRegs;
+uint8_t         FAKE_Eeprom[EEPROM_PAGE_NUM][EEPROM_PAGE_SIZE];
+uint32_t        FAKE_EepromInits    = 0;
+uint32_t        FAKE_EepromPrograms = 0;
+uint32_t        FAKE_IapUid[4]      = { 0xA5000001, 0xA5000002,
+                                        0xA5000003, 0xA5000004 };
+uint32_t        FAKE_IapUidReads    = 0;
+
+static bool     g_iapInit           = false;
+
+
+void Chip_EEPROM_Init (LPC_EEPROM_T *e)
+{
+    (void) e;
+    ++ FAKE_EepromInits;
+}
+
+
+void Chip_EEPROM_SetAutoProg (LPC_EEPROM_T *e, uint32_t mode)
+{
+    e->AUTOPROG = mode;
+}
+
+
+void Chip_EEPROM_EraseProgramPage (LPC_EEPROM_T *e)
+{
+    (void) e;
+    ++ FAKE_EepromPrograms;
+}
+
+
+uint8_t Chip_IAP_init ()
+{
+    g_iapInit = true;
+    return IAP_CMD_SUCCESS;
+}
+
+
+uint32_t Chip_IAP_ReadUID (uint32_t uid[])
+{
+    if (!g_iapInit)
+    {
+        return IAP_INVALID_COMMAND;
+    }
+
+    memcpy (uid, FAKE_IapUid, sizeof(FAKE_IapUid));
+    ++ FAKE_IapUidReads;
+    return IAP_CMD_SUCCESS;
+}
@@ -0,0 +1,109 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "systick.h"
+#include "chip.h"
+
+
+// Reemplazo de host de src/systick.c: los ticks avanzan con FAKE_SysTickStep()
+
+uint32_t                    FAKE_SysTickSleep   = 0;
+
+static uint32_t             g_ticks             = 0;
+static SYSTICK_HookFunc     g_tickHook          = NULL;
+static uint32_t             g_tickRateMicro     = 1000;
+
+
+void FAKE_SysTickReset (uint32_t now)
+{
+    g_ticks             = now;
+    g_tickHook          = NULL;
+    g_tickRateMicro     = 1000;
+    FAKE_SysTickSleep   = 0;
+}
+
+
+void FAKE_SysTickStep (uint32_t ticks)
+{
+    while (ticks --)
+    {
+        ++ g_ticks;
+
+        if (g_tickHook)
+        {
+            g_tickHook (g_ticks);
+        }
+    }
+}
+
+
+void SYSTICK_SetMicrosecondPeriod (uint32_t micro)
+{
+    g_tickRateMicro = micro;
+}
+
+
+void SYSTICK_SetMillisecondPeriod (uint32_t milli)
+{
+    g_tickRateMicro = milli * 1000;
+}
+
+
+uint32_t SYSTICK_GetTickRateMicroseconds ()
+{
+    return g_tickRateMicro;
+}
+
+
+uint32_t SYSTICK_Now ()
+{
+    return g_ticks;
+}
+
+
+uint32_t SYSTICK_MaxSleepTicks ()
+{
+    return UINT32_MAX;
+}
+
+
+// No duerme: solo registra cuanto pidio dormir el llamador
+void SYSTICK_Sleep (uint32_t ticks)
+{
+    FAKE_SysTickSleep = ticks;
+}
+
+
+SYSTICK_HookFunc SYSTICK_SetHook (SYSTICK_HookFunc func)
+{
+   SYSTICK_HookFunc old = g_tickHook;
+   g_tickHook = func;
+   return old;
+}
@@ -0,0 +1,155 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "template.h"
+#include "text.h"
+#include "text_app.h"
+#include <stdio.h>
+#include <string.h>
+
+
+// Genera src/text_templates.c: TEMPLATE_Table con cada texto que tenga
+// comodines, separado con el mismo TEMPLATE_Compile() del firmware.
+// text_list.h lo arma el Makefile a partir de text.h y text_app.h.
+
+struct Text
+{
+    const char  *name;
+    const char  **text;
+};
+
+
+static const struct Text g_texts[] =
+{
+    #define TEXT(name) { #name, &name },
+    #include "text_list.h"
+    #undef TEXT
+};
+
+
+// No se generan las tablas al compilar el generador
+const struct TEMPLATE   TEMPLATE_Table[]    = { { NULL, NULL, 0 } };
+const uint32_t          TEMPLATE_TableCount = 0;
+
+
+static bool hasArgs (const struct TEMPLATE_Part *parts, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (parts[i].arg != TEMPLATE_ARG_NONE)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+int main (int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        fprintf (stderr, "uso: %s <fuente con la licencia>\n", argv[0]);
+        return 1;
+    }
+
+    // Copia el comentario de licencia del fuente indicado
+    FILE *license = fopen (argv[1], "r");
+    if (!license)
+    {
+        perror (argv[1]);
+        return 1;
+    }
+
+    char line[256];
+    while (fgets (line, sizeof(line), license))
+    {
+        fputs (line, stdout);
+        if (!strcmp (line, "*/\n"))
+        {
+            break;
+        }
+    }
+    fclose (license);
+
+    printf ("// Generado por test/gen_templates.c a partir de los textos, no "
+            "editar.\n"
+            "// Regenerar con: make -C sgermino/Ejer5/test templates\n"
+            "#include \"template.h\"\n"
+            "#include \"text.h\"\n"
+            "#include \"text_app.h\"\n");
+
+    const uint32_t Count = sizeof(g_texts) / sizeof(g_texts[0]);
+    bool used[sizeof(g_texts) / sizeof(g_texts[0])] = { false };
+    uint32_t parts[sizeof(g_texts) / sizeof(g_texts[0])] = { 0 };
+
+    for (uint32_t i = 0; i < Count; ++i)
+    {
+        struct TEMPLATE_Part p[TEMPLATE_MAX_PARTS];
+        parts[i] = TEMPLATE_Compile (*g_texts[i].text, p, TEMPLATE_MAX_PARTS);
+
+        if (!parts[i])
+        {
+            // Queda para el recorrido en cada envio
+            fprintf (stderr, "%s: mas de %u partes\n", g_texts[i].name,
+                     TEMPLATE_MAX_PARTS);
+            continue;
+        }
+
+        if (!hasArgs (p, parts[i]))
+        {
+            continue;
+        }
+
+        used[i] = true;
+        printf ("\n\nstatic const struct TEMPLATE_Part parts_%s[] =\n{\n",
+                g_texts[i].name);
+        for (uint32_t k = 0; k < parts[i]; ++k)
+        {
+            printf ("    { %4u, %4u, 0x%02X },\n", p[k].offset, p[k].size,
+                    p[k].arg);
+        }
+        printf ("};\n");
+    }
+
+    printf ("\n\nconst struct TEMPLATE TEMPLATE_Table[] =\n{\n");
+    for (uint32_t i = 0; i < Count; ++i)
+    {
+        if (used[i])
+        {
+            printf ("    { &%s,\n      parts_%s, %u },\n",
+                    g_texts[i].name, g_texts[i].name, parts[i]);
+        }
+    }
+    printf ("};\n\n\n"
+            "const uint32_t TEMPLATE_TableCount =\n"
+            "    sizeof(TEMPLATE_Table) / sizeof(TEMPLATE_Table[0]);\n");
+    return 0;
+}
@@ -0,0 +1,83 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#ifdef __x86_64__
+    #include <x86intrin.h>
+#endif
+
+
+// Minimo necesario para las pruebas de host: cada chequeo fallido se
+// informa con su linea y el programa termina con error.
+static unsigned TEST_Failures = 0;
+
+#define TEST_CHECK(cond) \
+    do { if (!(cond)) { ++ TEST_Failures; \
+         printf ("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); } \
+    } while (0)
+
+#define TEST_RUN(func) \
+    do { printf ("%s\n", #func); func (); } while (0)
+
+#define TEST_END() \
+    (printf ("%s: %u failures\n", TEST_Failures? "FAILED" : "OK", \
+             TEST_Failures), TEST_Failures? 1 : 0)
+
+
+// Reloj de los benchmarks: ciclos del TSC en x86-64, ns en el resto
+#ifdef __x86_64__
+    #define TEST_CYCLES_UNIT    "cycles"
+#else
+    #define TEST_CYCLES_UNIT    "ns"
+#endif
+
+static inline uint64_t TEST_Cycles ()
+{
+#ifdef __x86_64__
+    return __rdtsc ();
+#else
+    struct timespec t;
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    return (uint64_t) t.tv_sec * 1000000000ull + t.tv_nsec;
+#endif
+}
+
+
+// Tiempo de pared, para las tasas (bytes/s, llamadas/s)
+static inline double TEST_Seconds ()
+{
+    struct timespec t;
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
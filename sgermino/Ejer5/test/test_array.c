@@ -0,0 +1,208 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "array.h"
+
+
+#define APPENDS         2000000
+
+
+// Capacidad 1 con terminador: ningun elemento, solo el '\0'
+static void testTerminatorOnly ()
+{
+    uint8_t data[1] = { 'x' };
+    struct ARRAY a;
+
+    TEST_CHECK (ARRAY_InitFlags (&a, data, 1, ARRAY_FlagTerminator));
+    TEST_CHECK (ARRAY_Free (&a) == 0);
+    TEST_CHECK (ARRAY_Full (&a));
+    TEST_CHECK (!ARRAY_Append (&a, 'a'));
+    TEST_CHECK (!ARRAY_AppendBinary (&a, (const uint8_t *) "a", 1));
+    TEST_CHECK (ARRAY_AppendString (&a, ""));
+    TEST_CHECK (ARRAY_Elements (&a) == 0);
+    TEST_CHECK (ARRAY_Terminate (&a) && data[0] == '\0');
+
+    // Sin terminador el unico byte es un elemento
+    TEST_CHECK (ARRAY_InitFlags (&a, data, 1, ARRAY_FlagNone));
+    TEST_CHECK (ARRAY_Append (&a, 'a') && ARRAY_Full (&a));
+    TEST_CHECK (!ARRAY_Terminate (&a) && data[0] == 'a');
+}
+
+
+// Lo que entra justo hasta el terminador
+static void testExactFit ()
+{
+    uint8_t data[8];
+    struct ARRAY a;
+
+    TEST_CHECK (ARRAY_Init (&a, data, sizeof(data)));
+    TEST_CHECK (ARRAY_Free (&a) == 7);
+    TEST_CHECK (ARRAY_AppendString (&a, "abc"));
+    TEST_CHECK (ARRAY_AppendBinary (&a, (const uint8_t *) "defg", 4));
+    TEST_CHECK (ARRAY_Full (&a) && ARRAY_Free (&a) == 0);
+    TEST_CHECK (ARRAY_Terminate (&a));
+    TEST_CHECK (!strcmp ((const char *) data, "abcdefg"));
+
+    // Quitar y volver a llenar
+    TEST_CHECK (ARRAY_RemoveChars (&a, 2) == 2);
+    TEST_CHECK (ARRAY_AppendString (&a, "XY") && ARRAY_Full (&a));
+    TEST_CHECK (ARRAY_Terminate (&a));
+    TEST_CHECK (!strcmp ((const char *) data, "abcdeXY"));
+}
+
+
+// Un append que no entra completo no agrega nada
+static void testAllOrNothing ()
+{
+    uint8_t data[8];
+    struct ARRAY a;
+
+    memset (data, '#', sizeof(data));
+    TEST_CHECK (ARRAY_Init (&a, data, sizeof(data)));
+    TEST_CHECK (ARRAY_AppendString (&a, "abc"));
+
+    TEST_CHECK (!ARRAY_AppendBinary (&a, (const uint8_t *) "12345", 5));
+    TEST_CHECK (!ARRAY_AppendString (&a, "12345"));
+    TEST_CHECK (ARRAY_Elements (&a) == 3);
+    TEST_CHECK (!memcmp (data, "abc#####", sizeof(data)));
+
+    // Lo que si entra se sigue pudiendo agregar
+    TEST_CHECK (ARRAY_AppendString (&a, "1234") && ARRAY_Full (&a));
+}
+
+
+// El arena se agota y solo devuelve la ultima porcion tomada
+static void testArena ()
+{
+    struct ARRAY a;
+    struct ARRAY b;
+    struct ARRAY c;
+    struct ARRAY d;
+
+    TEST_CHECK (ARRAY_ArenaFree () == ARRAY_ARENA_SIZE);
+    TEST_CHECK (ARRAY_InitFromArena (&a, 32, ARRAY_FlagNone));
+    TEST_CHECK (ARRAY_InitFromArena (&b, ARRAY_ARENA_SIZE - 64,
+                                     ARRAY_FlagTerminator));
+    TEST_CHECK (ARRAY_InitFromArena (&c, 32, ARRAY_FlagNone));
+    TEST_CHECK (ARRAY_ArenaFree () == 0);
+
+    // Agotado, aun para un byte
+    TEST_CHECK (!ARRAY_InitFromArena (&d, 1, ARRAY_FlagNone));
+    TEST_CHECK (!ARRAY_InitFromArena (&d, 0, ARRAY_FlagNone));
+
+    // Porciones que no se pisan
+    memset (a.data, 'a', a.capacity);
+    memset (c.data, 'c', c.capacity);
+    TEST_CHECK (a.data + a.capacity == b.data);
+    TEST_CHECK (b.data + b.capacity == c.data);
+
+    // Fuera de orden: se rechaza y no cambia nada
+    TEST_CHECK (!ARRAY_ReleaseToArena (&a));
+    TEST_CHECK (!ARRAY_ReleaseToArena (&b));
+    TEST_CHECK (a.capacity == 32 && ARRAY_ArenaFree () == 0);
+
+    TEST_CHECK (ARRAY_ReleaseToArena (&c));
+    TEST_CHECK (ARRAY_ArenaFree () == 32);
+    // Ya devuelta
+    TEST_CHECK (!ARRAY_ReleaseToArena (&c));
+    TEST_CHECK (!ARRAY_ReleaseToArena (&a));
+
+    TEST_CHECK (ARRAY_ReleaseToArena (&b));
+    TEST_CHECK (ARRAY_ReleaseToArena (&a));
+    TEST_CHECK (ARRAY_ArenaFree () == ARRAY_ARENA_SIZE);
+    TEST_CHECK (!ARRAY_InitFromArena (&d, ARRAY_ARENA_SIZE + 1,
+                                      ARRAY_FlagNone));
+}
+
+
+static double appendCycles (const uint8_t *src, uint32_t size, bool bulk)
+{
+    static uint8_t data[256];
+    struct ARRAY a;
+    bool ok = true;
+
+    ARRAY_InitFlags (&a, data, sizeof(data), ARRAY_FlagTerminator);
+
+    const uint64_t Start = TEST_Cycles ();
+    for (uint32_t i = 0; i < APPENDS; ++i)
+    {
+        ARRAY_Reset (&a);
+        __asm__ volatile ("" : : "r" (src) : "memory");
+        if (bulk)
+        {
+            ok &= ARRAY_AppendBinary (&a, src, size);
+        }
+        else
+        {
+            for (uint32_t j = 0; j < size; ++j)
+            {
+                ok &= ARRAY_Append (&a, src[j]);
+            }
+        }
+    }
+    const double Cycles = (double)(TEST_Cycles () - Start) / APPENDS;
+
+    TEST_CHECK (ok && ARRAY_Elements (&a) == size);
+    return Cycles;
+}
+
+
+// ARRAY_AppendBinary() contra ARRAY_Append() de a un byte
+static void benchAppend ()
+{
+    static const uint32_t Sizes[] = { 4, 16, 64, 255 };
+    uint8_t src[255];
+
+    for (uint32_t i = 0; i < sizeof(src); ++i)
+    {
+        src[i] = 'a' + i % 26;
+    }
+
+    for (uint32_t i = 0; i < sizeof(Sizes) / sizeof(Sizes[0]); ++i)
+    {
+        const double Bulk = appendCycles (src, Sizes[i], true);
+        const double Loop = appendCycles (src, Sizes[i], false);
+
+        printf ("  %3u bytes: %6.1f " TEST_CYCLES_UNIT " bulk, %6.1f "
+                "per byte (%.1fx)\n", Sizes[i], Bulk, Loop, Loop / Bulk);
+    }
+}
+
+
+int main ()
+{
+    TEST_RUN (testTerminatorOnly);
+    TEST_RUN (testExactFit);
+    TEST_RUN (testAllOrNothing);
+    TEST_RUN (testArena);
+    TEST_RUN (benchAppend);
+    return TEST_END ();
+}
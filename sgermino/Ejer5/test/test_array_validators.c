@@ -0,0 +1,304 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "array.h"
+#include <stdlib.h>
+
+
+#define FUZZ_RUNS       1000000
+#define FUZZ_MAX_SIZE   64
+#define SMALL_SIZE      32
+#define LARGE_SIZE      4096
+#define BENCH_BYTES     (256u << 20)
+
+
+// ---------------------------------------------------------------------------
+// Referencia byte a byte: la validacion de ARRAY antes de SWAR
+// ---------------------------------------------------------------------------
+
+static bool scalarDecimal (const uint8_t *data, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        if (data[i] < '0' || data[i] > '9')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+static bool scalarAlnum (const uint8_t *data, uint32_t size)
+{
+    uint32_t i = 0;
+    while (i < size)
+    {
+        const uint8_t C = data[i];
+        if ((C >= '0' && C <= '9') || (C >= 'A' && C <= 'Z') ||
+            (C >= 'a' && C <= 'z'))
+        {
+            ++ i;
+            continue;
+        }
+
+        // Latin-1 Supplement y Latin Extended-A en dos bytes UTF-8
+        if (i + 1 >= size || (C & 0xE0) != 0xC0 ||
+            (data[i + 1] & 0xC0) != 0x80)
+        {
+            return false;
+        }
+
+        const uint32_t Code = (C & 0x1F) << 6 | (data[i + 1] & 0x3F);
+        if (Code < 0xC0 || Code == 0xD7 || Code == 0xF7 || Code > 0x17F)
+        {
+            return false;
+        }
+        i += 2;
+    }
+    return true;
+}
+
+
+// ---------------------------------------------------------------------------
+// Entradas
+// ---------------------------------------------------------------------------
+
+// Bordes de los rangos validos, y bytes que rompen la palabra US-ASCII
+static const uint8_t Edges[] =
+{
+    0x00, '/', '0', '9', ':', '@', 'A', 'Z', '[', '`', 'a', 'z', '{', 0x7F,
+    0x80, 0xBF, 0xC0, 0xFF, 0x20, 0x5F, 0x10, 0x30 | 0x80
+};
+
+
+static uint32_t appendChar (uint8_t *data, uint32_t i, uint32_t size)
+{
+    const uint32_t R = (uint32_t) rand () % 100;
+
+    if (R < 45 || i + 1 >= size)
+    {
+        data[i] = '0' + rand () % 10;
+        return 1;
+    }
+    if (R < 85)
+    {
+        data[i] = ((rand () & 1)? 'a' : 'A') + rand () % 26;
+        return 1;
+    }
+    if (R < 99)
+    {
+        // Codigo de dos bytes entre U+00B0 y U+018F: validos salvo los
+        // bordes
+        const uint32_t Code = 0xB0 + (uint32_t) rand () % 0xE0;
+        data[i]     = 0xC0 | (Code >> 6);
+        data[i + 1] = 0x80 | (Code & 0x3F);
+        return 2;
+    }
+    data[i] = Edges[(uint32_t) rand () % sizeof(Edges)];
+    return 1;
+}
+
+
+// Texto casi siempre valido, a veces con un byte cambiado al azar
+static uint32_t makeInput (uint8_t *data, bool decimal)
+{
+    const uint32_t Size = (uint32_t) rand () % (FUZZ_MAX_SIZE + 1);
+
+    uint32_t i = 0;
+    while (i < Size)
+    {
+        if (decimal && rand () % 50)
+        {
+            data[i ++] = '0' + rand () % 10;
+            continue;
+        }
+        i += appendChar (data, i, Size);
+    }
+
+    if (Size && !(rand () % 4))
+    {
+        data[(uint32_t) rand () % Size] = (uint8_t) rand ();
+    }
+    return Size;
+}
+
+
+static void setArray (struct ARRAY *a, uint8_t *data, uint32_t size)
+{
+    ARRAY_InitFlags (a, data, size? size : 1, ARRAY_FlagNone);
+    a->index = size;
+}
+
+
+// Con la referencia como oraculo, en todas las alineaciones de la palabra
+static void testFuzz ()
+{
+    static uint8_t buffer[FUZZ_MAX_SIZE + 8];
+    uint32_t mismatches = 0;
+    uint32_t valid[2]   = { 0 };
+
+    srand (22);
+    for (uint32_t run = 0; run < FUZZ_RUNS; ++run)
+    {
+        const bool      Decimal = run & 1;
+        uint8_t         *data   = &buffer[run % 4];
+        const uint32_t  Size    = makeInput (data, Decimal);
+
+        struct ARRAY a;
+        setArray (&a, data, Size);
+
+        const bool Expected = Decimal? scalarDecimal (data, Size) :
+                                       scalarAlnum (data, Size);
+        const bool Got      = Decimal? ARRAY_CheckDecimalChars (&a) :
+                                       ARRAY_CheckAlnumChars (&a);
+        mismatches += (Expected != Got);
+        valid[Decimal] += Expected;
+    }
+
+    printf ("  %u inputs: %u alnum and %u decimal valid, %u mismatches\n",
+            FUZZ_RUNS, valid[0], valid[1], mismatches);
+    TEST_CHECK (!mismatches);
+    // El guion cubre los dos resultados de cada validador
+    TEST_CHECK (valid[0] > FUZZ_RUNS / 8 && valid[0] < FUZZ_RUNS / 2 - 1000);
+    TEST_CHECK (valid[1] > FUZZ_RUNS / 8 && valid[1] < FUZZ_RUNS / 2 - 1000);
+}
+
+
+// Cada byte de 0 a 255 en cada posicion de una palabra de digitos o letras
+static void testEveryByte ()
+{
+    static const char Digits[] = "01234567";
+    static const char Letters[] = "abcdEFGH";
+    uint32_t mismatches = 0;
+
+    for (uint32_t b = 0; b < 256; ++b)
+    {
+        for (uint32_t pos = 0; pos < 8; ++pos)
+        {
+            uint8_t d[8];
+            uint8_t l[8];
+            memcpy (d, Digits, 8);
+            memcpy (l, Letters, 8);
+            d[pos] = l[pos] = b;
+
+            struct ARRAY a;
+            setArray (&a, d, 8);
+            mismatches += (ARRAY_CheckDecimalChars (&a) !=
+                           scalarDecimal (d, 8));
+            setArray (&a, l, 8);
+            mismatches += (ARRAY_CheckAlnumChars (&a) != scalarAlnum (l, 8));
+        }
+    }
+
+    TEST_CHECK (!mismatches);
+}
+
+
+// ---------------------------------------------------------------------------
+// Rendimiento con entradas validas (se recorren completas)
+// ---------------------------------------------------------------------------
+
+typedef bool (* CheckFunc) (struct ARRAY *a);
+
+static bool scalarDecimalArray (struct ARRAY *a)
+{
+    return scalarDecimal (a->data, a->index);
+}
+
+
+static bool scalarAlnumArray (struct ARRAY *a)
+{
+    return scalarAlnum (a->data, a->index);
+}
+
+
+static double bytesPerSecond (CheckFunc check, uint8_t *data, uint32_t size)
+{
+    struct ARRAY a;
+    setArray (&a, data, size);
+
+    const uint32_t Runs = BENCH_BYTES / size;
+    uint32_t ok = 0;
+
+    const double Start = TEST_Seconds ();
+    for (uint32_t i = 0; i < Runs; ++i)
+    {
+        __asm__ volatile ("" : : "r" (&a) : "memory");
+        ok += check (&a);
+    }
+    const double Elapsed = TEST_Seconds () - Start;
+
+    TEST_CHECK (ok == Runs);
+    return (double) Runs * size / Elapsed;
+}
+
+
+static void benchSize (uint32_t size)
+{
+    static uint8_t digits[LARGE_SIZE];
+    static uint8_t alnum[LARGE_SIZE];
+
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        digits[i]   = '0' + i % 10;
+        alnum[i]    = "aZ9xQ0mK"[i % 8];
+    }
+
+    const double DecSwar   = bytesPerSecond (ARRAY_CheckDecimalChars,
+                                             digits, size);
+    const double DecScalar = bytesPerSecond (scalarDecimalArray, digits,
+                                             size);
+    const double AlnSwar   = bytesPerSecond (ARRAY_CheckAlnumChars, alnum,
+                                             size);
+    const double AlnScalar = bytesPerSecond (scalarAlnumArray, alnum, size);
+
+    printf ("  %4u B: decimal %6.0f MB/s SWAR, %6.0f scalar (%.2fx); "
+            "alnum %6.0f SWAR, %6.0f scalar (%.2fx)\n", size,
+            DecSwar * 1e-6, DecScalar * 1e-6, DecSwar / DecScalar,
+            AlnSwar * 1e-6, AlnScalar * 1e-6, AlnSwar / AlnScalar);
+}
+
+
+static void benchThroughput ()
+{
+    benchSize (SMALL_SIZE);
+    benchSize (LARGE_SIZE);
+}
+
+
+int main ()
+{
+    TEST_RUN (testFuzz);
+    TEST_RUN (testEveryByte);
+    TEST_RUN (benchThroughput);
+    return TEST_END ();
+}
@@ -0,0 +1,257 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "copos.h"
+#include "systick.h"
+#include "chip.h"
+#include <string.h>
+
+
+static uint32_t g_runsThisTick;
+
+
+static void task (void *ctx, uint32_t ticks)
+{
+    ++ g_runsThisTick;
+}
+
+
+static void setup (const uint32_t periods[], uint32_t count)
+{
+    FAKE_SysTickReset (0);
+    schedulerInit   ();
+    schedulerStart  (1);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        TEST_CHECK (schedulerAddTask (task, NULL, 0, periods[i]) == i);
+    }
+}
+
+
+static bool offsetsZero (const sSchedulerAnalysis_t *a)
+{
+    for (uint32_t i = 0; i < SCHEDULER_MAX_TASKS; ++i)
+    {
+        if (a->offset[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+// Los periodos de main.c: hiperperiodo de 14000 ticks. Con 7 tareas se
+// sugieren offsets (490000 revisiones), con 8 ya no (616000).
+static void testMainTasks ()
+{
+    static const uint32_t Periods[] = { 14, 16, 140, 500, 20, 20, 50, 10 };
+    const uint32_t Count = sizeof(Periods) / sizeof(Periods[0]) - 1;
+
+    setup (Periods, Count);
+
+    sSchedulerAnalysis_t a;
+    TEST_CHECK (schedulerAnalyze (&a, NULL) == 0);
+    TEST_CHECK (a.tasks == Count);
+    TEST_CHECK (a.hyperperiod == 14000);
+    TEST_CHECK (a.peakTasks == Count);
+    TEST_CHECK (!offsetsZero (&a));
+    TEST_CHECK (a.balancedPeakTasks > 0);
+    TEST_CHECK (a.balancedPeakTasks < a.peakTasks);
+
+    setup (Periods, Count + 1);
+    TEST_CHECK (schedulerAnalyze (&a, NULL) == 0);
+    TEST_CHECK (a.hyperperiod == 14000);
+    TEST_CHECK (a.peakTasks == Count + 1);
+    TEST_CHECK (offsetsZero (&a));
+    TEST_CHECK (a.balancedPeakTasks == 0);
+}
+
+
+// Hiperperiodo 10000 con 15 tareas: se recorre, pero balancear excede el
+// limite y no se sugieren offsets
+static void testBalanceOverBudget ()
+{
+    static const uint32_t Periods[SCHEDULER_MAX_TASKS] = {
+        10000, 5000, 2500, 2000, 1250, 1000, 625, 500, 400, 250, 200, 125,
+        100, 50, 25 };
+
+    setup (Periods, SCHEDULER_MAX_TASKS);
+
+    sSchedulerAnalysis_t a;
+    TEST_CHECK (schedulerAnalyze (&a, NULL) == 0);
+    TEST_CHECK (a.tasks == SCHEDULER_MAX_TASKS);
+    TEST_CHECK (a.hyperperiod == 10000);
+    TEST_CHECK (a.peakTasks == SCHEDULER_MAX_TASKS);
+    TEST_CHECK (offsetsZero (&a));
+    TEST_CHECK (a.balancedPeakTasks == 0);
+}
+
+
+// Hiperperiodo 40000 con 15 tareas: ni siquiera se recorre
+static void testReplayOverBudget ()
+{
+    static const uint32_t Periods[SCHEDULER_MAX_TASKS] = {
+        40000, 20000, 10000, 8000, 5000, 4000, 2000, 1000, 800, 500, 400,
+        200, 100, 50, 25 };
+
+    setup (Periods, SCHEDULER_MAX_TASKS);
+
+    sSchedulerAnalysis_t a;
+    TEST_CHECK (schedulerAnalyze (&a, NULL) == 0);
+    TEST_CHECK (a.tasks == SCHEDULER_MAX_TASKS);
+    TEST_CHECK (a.hyperperiod == 0);
+    TEST_CHECK (a.peakTasks == 0);
+    TEST_CHECK (offsetsZero (&a));
+
+    // Buscar el delay de una tarea mas tambien excede el limite: queda el
+    // pedido aunque coincida con las demas
+    const uint32_t Due = schedulerTicksToRelease (0);
+    TEST_CHECK (Due > 0);
+    TEST_CHECK (schedulerBalancedDelay (Due, 40000) == Due);
+
+    // Con menos tareas si se busca
+    setup (Periods, 2);
+    TEST_CHECK (schedulerBalancedDelay (Due, 40000) != Due);
+}
+
+
+// Por pasos acotados se llega al mismo resultado que de una vez. Con las
+// tareas de main.c el reporte de perfil reparte el analisis en varias
+// llamadas a uartProcessTask.
+static void testSteps ()
+{
+    static const uint32_t Periods[] = { 14, 16, 140, 500, 20, 20, 50 };
+    const uint32_t Count = sizeof(Periods) / sizeof(Periods[0]);
+
+    setup (Periods, Count);
+
+    sSchedulerAnalysis_t whole;
+    TEST_CHECK (schedulerAnalyze (&whole, NULL) == 0);
+
+    static const uint32_t Budgets[] = { 1, 1000,
+                                        SCHEDULER_ANALYSIS_STEP_CHECKS };
+
+    for (uint32_t b = 0; b < sizeof(Budgets) / sizeof(Budgets[0]); ++b)
+    {
+        static sSchedulerAnalysisJob_t j;
+        TEST_CHECK (schedulerAnalyzeBegin (&j, NULL) == 0);
+
+        uint32_t steps      = 1;
+        uint64_t longest    = 0;
+        bool     more;
+        do
+        {
+            const uint64_t Start = TEST_Cycles ();
+            more = schedulerAnalyzeStep (&j, Budgets[b]);
+            const uint64_t Cycles = TEST_Cycles () - Start;
+
+            longest = (Cycles > longest)? Cycles : longest;
+            steps += more;
+        }
+        while (more);
+
+        TEST_CHECK (!memcmp (&j.analysis, &whole, sizeof(whole)));
+        TEST_CHECK (steps > 1);
+
+        printf ("  %6u checks per step: %6u steps, longest %u %s\n",
+                Budgets[b], steps, (unsigned) longest, TEST_CYCLES_UNIT);
+    }
+}
+
+
+/*
+    Las tareas de main() corridas por el scheduler durante un hiperperiodo:
+    tareas liberadas en un mismo tick, sin y con auto offset. Tambien mide
+    lo que tardan las altas con auto offset, que main() hace al arrancar.
+*/
+static void testMainReplay ()
+{
+    static const uint32_t Delays[]  = {  0,  0,   0,   1,  1,  1,  0 };
+    static const uint32_t Periods[] = { 14, 16, 140, 500, 20, 20, 50 };
+    const uint32_t Count = sizeof(Periods) / sizeof(Periods[0]);
+
+    uint32_t peak[2];
+
+    for (uint32_t autoOffset = 0; autoOffset < 2; ++autoOffset)
+    {
+        FAKE_SysTickReset (0);
+        schedulerInit           ();
+        schedulerSetAutoOffset  (autoOffset);
+
+        const double Start = TEST_Seconds ();
+        for (uint32_t i = 0; i < Count; ++i)
+        {
+            TEST_CHECK (schedulerAddTask (task, NULL, Delays[i], Periods[i])
+                        == i);
+        }
+        const double AddTime = TEST_Seconds () - Start;
+
+        schedulerSetAutoOffset  (false);
+        schedulerStart          (1);
+
+        // Histograma de tareas corridas por tick
+        uint32_t ticksWith[8] = { 0 };
+        for (uint32_t t = 0; t < 14000; ++t)
+        {
+            g_runsThisTick = 0;
+            FAKE_SysTickStep        (1);
+            schedulerDispatchTasks  (SYSTICK_Now ());
+            ++ ticksWith[g_runsThisTick];
+        }
+
+        peak[autoOffset] = 0;
+        for (uint32_t n = 0; n <= Count; ++n)
+        {
+            peak[autoOffset] = ticksWith[n]? n : peak[autoOffset];
+        }
+
+        printf ("  auto offset %s: peak %u tasks/tick, ticks with 1..4 tasks:"
+                " %4u %3u %3u %3u, adds took %.0f us\n",
+                autoOffset? "on " : "off", peak[autoOffset], ticksWith[1],
+                ticksWith[2], ticksWith[3], ticksWith[4], AddTime * 1e6);
+    }
+
+    TEST_CHECK (peak[1] < peak[0]);
+}
+
+
+int main ()
+{
+    TEST_RUN (testMainTasks);
+    TEST_RUN (testBalanceOverBudget);
+    TEST_RUN (testReplayOverBudget);
+    TEST_RUN (testSteps);
+    TEST_RUN (testMainReplay);
+    return TEST_END ();
+}
@@ -0,0 +1,186 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "copos.h"
+#include "systick.h"
+#include "chip.h"
+
+
+#define SIM_TICKS       10000
+#define SLOW_PERIOD     10
+#define SLOW_COST       3
+// Cada tanto una corrida se traba y ocupa varios periodos
+#define STALL_EVERY     10
+#define STALL_COST      35
+#define FAST_PERIOD     5
+
+
+extern sTask_t schedulerTasks[SCHEDULER_MAX_TASKS];
+
+
+static uint32_t g_slowRuns;
+static uint32_t g_busyTicks;
+static uint32_t g_fastRuns;
+static uint32_t g_fastWorst;
+static uint32_t g_fastTotal;
+
+
+// Avanza el reloj lo que dura la corrida: el tick sigue liberando tareas
+static void slowTask (void *ctx, uint32_t ticks)
+{
+    const uint32_t Cost = (++ g_slowRuns % STALL_EVERY)? SLOW_COST
+                                                      : STALL_COST;
+    g_busyTicks += Cost;
+    FAKE_SysTickStep (Cost);
+}
+
+
+// Liberada en cada multiplo de FAST_PERIOD y corrida una vez por liberacion:
+// respuesta desde su liberacion hasta el final de la corrida
+static void fastTask (void *ctx, uint32_t ticks)
+{
+    ++ g_fastRuns;
+    g_busyTicks += 1;
+    FAKE_SysTickStep (1);
+
+    const uint32_t Response = SYSTICK_Now () - g_fastRuns * FAST_PERIOD;
+    g_fastTotal += Response;
+    if (Response > g_fastWorst)
+    {
+        g_fastWorst = Response;
+    }
+}
+
+
+struct RESULT
+{
+    uint32_t    slowRuns;
+    uint32_t    overruns;
+    uint32_t    dropped;
+    uint32_t    busyTicks;
+    uint32_t    fastRuns;
+    uint32_t    fastWorst;
+    double      fastMean;
+};
+
+
+static struct RESULT simulate (eOverrunPolicy_t policy)
+{
+    FAKE_SysTickReset (0);
+    schedulerInit ();
+
+    g_slowRuns  = 0;
+    g_busyTicks = 0;
+    g_fastRuns  = 0;
+    g_fastWorst = 0;
+    g_fastTotal = 0;
+
+    const uint32_t Slow = schedulerAddTask (slowTask, NULL, SLOW_PERIOD,
+                                            SLOW_PERIOD);
+    schedulerAddTask (fastTask, NULL, FAST_PERIOD, FAST_PERIOD);
+    schedulerSetTaskOverrunPolicy   (Slow, policy);
+    schedulerSetDispatchPolicy      (SCHEDULER_DISPATCH_SLOT_ORDER);
+    schedulerStart (1);
+
+    while (SYSTICK_Now () < SIM_TICKS)
+    {
+        FAKE_SysTickSleep = 0;
+        schedulerDispatchTasks (SYSTICK_Now ());
+        if (FAKE_SysTickSleep)
+        {
+            FAKE_SysTickStep (FAKE_SysTickSleep);
+        }
+    }
+
+    const struct RESULT R =
+    {
+        .slowRuns   = g_slowRuns,
+        .overruns   = schedulerTasks[Slow].overruns,
+        .dropped    = schedulerTasks[Slow].droppedRuns,
+        .busyTicks  = g_busyTicks,
+        .fastRuns   = g_fastRuns,
+        .fastWorst  = g_fastWorst,
+        .fastMean   = (double) g_fastTotal / g_fastRuns,
+    };
+
+    printf ("  %s: %3u runs, %3u overruns, %3u dropped, CPU %4.1f%%, "
+            "other task response %.1f mean, %u worst\n",
+            (policy == SCHEDULER_OVERRUN_CATCHUP)? "catch-up" :
+            (policy == SCHEDULER_OVERRUN_COALESCE)? "coalesce" : "skip    ",
+            R.slowRuns, R.overruns, R.dropped,
+            R.busyTicks * 100.0 / SIM_TICKS, R.fastMean, R.fastWorst);
+    return R;
+}
+
+
+// Una tarea de periodo 10 que cada 10 corridas se traba 35 ticks, junto
+// con otra de periodo 5
+static void testPolicies ()
+{
+    const uint32_t Releases = SIM_TICKS / SLOW_PERIOD;
+
+    const struct RESULT CatchUp     = simulate (SCHEDULER_OVERRUN_CATCHUP);
+    const struct RESULT Coalesce    = simulate (SCHEDULER_OVERRUN_COALESCE);
+    const struct RESULT Skip        = simulate (SCHEDULER_OVERRUN_SKIP);
+
+    // Todas ven atrasos; cada liberacion tiene su corrida o se descarta
+    TEST_CHECK (CatchUp.overruns > 0);
+    TEST_CHECK (Coalesce.overruns > 0);
+    TEST_CHECK (Skip.overruns > 0);
+
+    // Catch-up corre cada liberacion, recuperando las atrasadas de corrido
+    TEST_CHECK (CatchUp.dropped == 0);
+    TEST_CHECK (CatchUp.slowRuns + 4 >= Releases);
+
+    // Coalesce corre una vez por todas las pendientes; skip ni siquiera esa
+    TEST_CHECK (Coalesce.dropped > 0);
+    TEST_CHECK (Coalesce.slowRuns + Coalesce.dropped + 4 >= Releases);
+    TEST_CHECK (Skip.dropped > Coalesce.dropped);
+    TEST_CHECK (Skip.slowRuns < Coalesce.slowRuns);
+    TEST_CHECK (Skip.slowRuns + Skip.dropped + 4 >= Releases);
+
+    // Menos corridas de la tarea lenta, menos CPU y menos espera para la otra
+    TEST_CHECK (Coalesce.busyTicks < CatchUp.busyTicks);
+    TEST_CHECK (Skip.busyTicks < Coalesce.busyTicks);
+    TEST_CHECK (Coalesce.fastMean < CatchUp.fastMean);
+    TEST_CHECK (Skip.fastMean < Coalesce.fastMean);
+
+    // El peor caso es esperar una corrida trabada, con cualquier politica
+    TEST_CHECK (CatchUp.fastWorst >= STALL_COST);
+    TEST_CHECK (Skip.fastWorst >= STALL_COST);
+}
+
+
+int main ()
+{
+    TEST_RUN (testPolicies);
+    return TEST_END ();
+}
@@ -0,0 +1,225 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "copos_util.h"
+#include "systick.h"
+#include "text.h"
+#include "chip.h"
+#include <string.h>
+
+
+#define TASKS       SCHEDULER_MAX_TASKS
+
+
+static struct UART      g_uart;
+static uint32_t         g_taskRuns;
+
+
+static void task (void *ctx, uint32_t ticks)
+{
+    ++ g_taskRuns;
+}
+
+
+static void tick (uint32_t count)
+{
+    while (count --)
+    {
+        FAKE_SysTickStep        (1);
+        schedulerDispatchTasks  (SYSTICK_Now ());
+    }
+}
+
+
+static void drain ()
+{
+    while (UART_SendPendingCount (&g_uart) || LPC_USART2->txCount)
+    {
+        FAKE_UartStep (LPC_USART2);
+    }
+}
+
+
+static uint32_t count (const char *text, const char *str)
+{
+    uint32_t n = 0;
+
+    for (const char *s = strstr (text, str); s; s = strstr (s + 1, str))
+    {
+        ++ n;
+    }
+
+    return n;
+}
+
+
+static void setup ()
+{
+    FAKE_Reset      ();
+    UART_Init       (&g_uart, LPC_USART2, 921600);
+    TEST_CHECK      (UART_SetMode (&g_uart, UART_ModeInterrupt));
+
+    FAKE_SysTickReset (0);
+    g_taskRuns = 0;
+
+    schedulerInit   ();
+    schedulerStart  (1);
+    for (uint32_t i = 0; i < TASKS; ++i)
+    {
+        TEST_CHECK (schedulerAddTask (task, NULL, 0, 1 + i % 5) == i);
+    }
+    tick (100);
+    TEST_CHECK (g_taskRuns > 0);
+}
+
+
+// El reporte completo no entra en el buffer de envio: se encola por partes
+// enteras, sin perder datos ni exceder el buffer en una llamada.
+static void testParts ()
+{
+    setup ();
+
+    sProfileReport_t report;
+    memset (&report, 0, sizeof(report));
+
+    uint32_t calls = 0;
+    bool more;
+    do
+    {
+        more = schedulerPutProfileMessage (&g_uart, &report);
+        TEST_CHECK (UART_SendPendingCount (&g_uart) <= UART_SEND_BUFFER_SIZE);
+        ++ calls;
+        drain ();
+    }
+    while (more && calls < 100);
+
+    TEST_CHECK (!more);
+    TEST_CHECK (calls > 1);
+    TEST_CHECK (report.part == 0);
+
+    LPC_USART_T *u = LPC_USART2;
+    u->txLine[u->txLineSize] = '\0';
+    const char *Text = (const char *) u->txLine;
+
+    printf ("  %u bytes in %u calls\n", u->txLineSize, calls);
+
+    TEST_CHECK (u->txLineSize > UART_SEND_BUFFER_SIZE);
+    TEST_CHECK (count (Text, "Clock rate  : 1000000000 Hz") == 1);
+    TEST_CHECK (count (Text, "  function  : ") == TASKS);
+    TEST_CHECK (count (Text, "  overruns  : ") == TASKS);
+    TEST_CHECK (count (Text, "Analysis") == 1);
+    TEST_CHECK (count (Text, "  tasks       : 15") == 1);
+    TEST_CHECK (count (Text, "  hyperperiod : 60 ticks") == 1);
+
+    // Cada tarea una sola vez y en orden
+    const char *last = Text;
+    for (uint32_t i = 0; i < TASKS; ++i)
+    {
+        char line[16];
+        snprintf (line, sizeof(line), "Task %u\r", i);
+        const char *at = strstr (Text, line);
+        TEST_CHECK (at && at > last);
+        last = at? at : last;
+    }
+
+    // Los textos de inicio y fin encierran todo el reporte
+    TEST_CHECK (!strncmp (Text, TEXT_SCHEDULER_STATSBEGIN,
+                          strlen (TEXT_SCHEDULER_STATSBEGIN)));
+    TEST_CHECK (!strcmp (Text + u->txLineSize
+                            - strlen (TEXT_SCHEDULER_STATSEND),
+                         TEXT_SCHEDULER_STATSEND));
+}
+
+
+// Sin lugar en el buffer no se encola nada y el reporte queda donde estaba
+static void testNoRoom ()
+{
+    setup ();
+
+    uint8_t fill[UART_SEND_BUFFER_SIZE - 16];
+    memset (fill, '.', sizeof(fill));
+    TEST_CHECK (UART_PutBinary (&g_uart, fill, sizeof(fill)));
+
+    const uint32_t Pending = UART_SendPendingCount (&g_uart);
+
+    sProfileReport_t report;
+    memset (&report, 0, sizeof(report));
+
+    TEST_CHECK (schedulerPutProfileMessage (&g_uart, &report));
+    TEST_CHECK (UART_SendPendingCount (&g_uart) == Pending);
+
+    const uint32_t Part = report.part;
+    drain ();
+    TEST_CHECK (schedulerPutProfileMessage (&g_uart, &report));
+    TEST_CHECK (report.part > Part);
+}
+
+
+// La cabecera pide su texto mas un argumento formateado. El buffer circular
+// guarda como maximo UART_SEND_BUFFER_SIZE - 1 bytes: un byte menos que eso
+// libre no alcanza, exactamente eso si.
+static void testRoomBoundary ()
+{
+    const uint32_t Need = strlen (TEXT_SCHEDULER_STATSBEGIN)
+                          + strlen (TEXT_SCHEDULER_STATS1)
+                          + VARIANT_FORMAT_SIZE;
+
+    for (uint32_t fits = 0; fits < 2; ++fits)
+    {
+        setup ();
+        // Sin envio por interrupcion el buffer no se vacia hacia la FIFO
+        TEST_CHECK (UART_SetMode (&g_uart, UART_ModePolled));
+        TEST_CHECK (UART_SendFree (&g_uart) == UART_SEND_BUFFER_SIZE - 1);
+
+        static uint8_t fill[UART_SEND_BUFFER_SIZE];
+        memset (fill, '.', sizeof(fill));
+        TEST_CHECK (UART_PutBinary (&g_uart, fill, UART_SEND_BUFFER_SIZE
+                                                   - Need - fits));
+        TEST_CHECK (UART_SendFree (&g_uart) == Need - 1 + fits);
+
+        sProfileReport_t report;
+        memset (&report, 0, sizeof(report));
+
+        TEST_CHECK (schedulerPutProfileMessage (&g_uart, &report));
+        TEST_CHECK (fits? UART_SendFree (&g_uart) < Need
+                        : UART_SendFree (&g_uart) == Need - 1);
+        TEST_CHECK (g_uart.send.overflows == 0);
+    }
+}
+
+
+int main ()
+{
+    TEST_RUN (testParts);
+    TEST_RUN (testNoRoom);
+    TEST_RUN (testRoomBoundary);
+    return TEST_END ();
+}
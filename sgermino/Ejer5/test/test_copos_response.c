@@ -0,0 +1,208 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "copos.h"
+#include "systick.h"
+#include "chip.h"
+
+
+// Diez hiperperiodos de las tareas de main.c, con tick de 1 ms
+#define SIM_TICKS       140000
+
+
+/*
+    Las tareas de main() con un costo supuesto en ticks. Cada corrida avanza
+    el reloj falso lo que cuesta: mientras tanto el tick libera otras tareas,
+    que esperan su turno como en el target (el scheduler no es expropiativo).
+*/
+struct SIM_TASK
+{
+    const char  *name;
+    uint32_t    delay;
+    uint32_t    period;
+    uint32_t    cost;
+    uint8_t     priority;
+    // Resultados
+    uint32_t    firstRelease;
+    uint32_t    runs;
+    uint32_t    worst;
+    uint32_t    best;
+    uint32_t    misses;
+};
+
+
+static struct SIM_TASK g_tasks[] =
+{
+    { "uartRecvTask     ", 0,  14,  1, 2 },
+    { "uartSendTask     ", 0,  16,  1, 1 },
+    { "uartProcessTask  ", 0, 140, 10, 0 },
+    { "ledUpdateTask    ", 1, 500,  1, 0 },
+    { "debounceTecTask  ", 1,  20,  2, 0 },
+    { "sensorOutputsTask", 1,  20,  2, 0 },
+    { "alarmFEMTask     ", 0,  50,  3, 0 },
+};
+
+#define TASK_COUNT  (sizeof(g_tasks) / sizeof(g_tasks[0]))
+
+
+// La corrida numero 'runs' atiende la liberacion numero 'runs' (politica
+// SCHEDULER_OVERRUN_CATCHUP): respuesta desde esa liberacion al final
+static void task (void *ctx, uint32_t ticks)
+{
+    struct SIM_TASK *t = (struct SIM_TASK *) ctx;
+
+    FAKE_SysTickStep (t->cost);
+
+    const uint32_t Released = t->firstRelease + t->runs * t->period;
+    const uint32_t Response = SYSTICK_Now () - Released;
+
+    if (Response > t->worst)
+    {
+        t->worst = Response;
+    }
+    if (Response < t->best)
+    {
+        t->best = Response;
+    }
+    if (Response > t->period)
+    {
+        ++ t->misses;
+    }
+    ++ t->runs;
+}
+
+
+static void simulate (eDispatchPolicy_t policy)
+{
+    FAKE_SysTickReset (0);
+    schedulerInit           ();
+    schedulerSetAutoOffset  (true);
+
+    for (uint32_t i = 0; i < TASK_COUNT; ++i)
+    {
+        struct SIM_TASK *t = &g_tasks[i];
+        TEST_CHECK (schedulerAddTask (task, t, t->delay, t->period) == i);
+        schedulerSetTaskPriority (i, t->priority);
+
+        // Con el retardo elegido por el auto offset
+        t->firstRelease = SYSTICK_Now () + schedulerTicksToRelease (i);
+        t->runs         = 0;
+        t->worst        = 0;
+        t->best         = UINT32_MAX;
+        t->misses       = 0;
+    }
+
+    schedulerSetDispatchPolicy  (policy);
+    schedulerStart              (1);
+
+    while (SYSTICK_Now () < SIM_TICKS)
+    {
+        FAKE_SysTickSleep = 0;
+        schedulerDispatchTasks (SYSTICK_Now ());
+        if (FAKE_SysTickSleep)
+        {
+            FAKE_SysTickStep (FAKE_SysTickSleep);
+        }
+    }
+
+    schedulerSetAutoOffset (false);
+}
+
+
+static void report (const char *policy)
+{
+    printf ("  %s\n", policy);
+    for (uint32_t i = 0; i < TASK_COUNT; ++i)
+    {
+        const struct SIM_TASK *t = &g_tasks[i];
+        printf ("    %s T=%3u C=%2u: worst %2u ticks, best %2u, %u misses\n",
+                t->name, t->period, t->cost, t->worst, t->best, t->misses);
+
+        // Ninguna liberacion quedo sin su corrida ni termino antes de empezar
+        TEST_CHECK (t->runs + 1 >= (SIM_TICKS - t->firstRelease) / t->period);
+        TEST_CHECK (t->best >= t->cost);
+    }
+}
+
+
+// Mayor costo de las otras tareas: bloqueo maximo sin expropiacion
+static uint32_t blocking (uint32_t taskIndex)
+{
+    uint32_t longest = 0;
+    for (uint32_t i = 0; i < TASK_COUNT; ++i)
+    {
+        if (i != taskIndex && g_tasks[i].cost > longest)
+        {
+            longest = g_tasks[i].cost;
+        }
+    }
+    return longest;
+}
+
+
+static void testSlotOrder ()
+{
+    simulate (SCHEDULER_DISPATCH_SLOT_ORDER);
+    report ("slot order");
+}
+
+
+// La tarea de mayor prioridad espera a lo sumo la corrida en curso
+static void testPriority ()
+{
+    simulate (SCHEDULER_DISPATCH_PRIORITY);
+    report ("priority");
+
+    TEST_CHECK (g_tasks[0].worst <= g_tasks[0].cost + blocking (0));
+    TEST_CHECK (!g_tasks[0].misses);
+}
+
+
+// Utilizacion de 0.47 y a lo sumo 10 ticks de bloqueo: EDF no pierde plazos
+static void testEdf ()
+{
+    simulate (SCHEDULER_DISPATCH_EDF);
+    report ("EDF");
+
+    for (uint32_t i = 0; i < TASK_COUNT; ++i)
+    {
+        TEST_CHECK (!g_tasks[i].misses);
+    }
+}
+
+
+int main ()
+{
+    TEST_RUN (testSlotOrder);
+    TEST_RUN (testPriority);
+    TEST_RUN (testEdf);
+    return TEST_END ();
+}
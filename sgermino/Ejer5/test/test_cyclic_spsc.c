@@ -0,0 +1,212 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "cyclic_spsc.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+#define STRESS_BYTES        (16u * 1024 * 1024)
+#define MAX_CHUNK           700
+
+
+struct Stress
+{
+    struct CYCLIC_SPSC  c;
+    uint32_t            total;
+    // Resultado del consumidor
+    uint32_t            received;
+    uint32_t            errors;
+    uint32_t            viaPeek;
+};
+
+
+// Contenido deterministico: el consumidor sabe que byte espera en cada
+// posicion sin compartir nada con el productor
+static uint8_t expected (uint32_t position)
+{
+    return (uint8_t)((position * 2654435761u) >> 24);
+}
+
+
+static uint32_t nextRand (uint32_t *seed)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return *seed >> 8;
+}
+
+
+static void * producer (void *arg)
+{
+    struct Stress   *s      = (struct Stress *) arg;
+    uint8_t         chunk   [MAX_CHUNK];
+    uint32_t        seed    = 1;
+    uint32_t        sent    = 0;
+
+    while (sent < s->total)
+    {
+        uint32_t size = 1 + nextRand (&seed) % MAX_CHUNK;
+        if (size > s->total - sent)
+        {
+            size = s->total - sent;
+        }
+
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            chunk[i] = expected (sent + i);
+        }
+
+        // Escribe lo que entra, el resto se reintenta
+        uint32_t done = 0;
+        while (done < size)
+        {
+            const uint32_t Count = CYCLIC_SPSC_InFromBuffer (&s->c,
+                                                &chunk[done], size - done);
+            if (!Count)
+            {
+                // Con un solo nucleo el consumidor necesita correr
+                sched_yield ();
+            }
+            done += Count;
+        }
+        sent += size;
+    }
+    return NULL;
+}
+
+
+static void * consumer (void *arg)
+{
+    struct Stress   *s      = (struct Stress *) arg;
+    uint8_t         chunk   [MAX_CHUNK];
+    uint32_t        seed    = 2;
+
+    while (s->received < s->total)
+    {
+        const uint32_t Mode = nextRand (&seed) % 4;
+        const uint32_t Want = 1 + nextRand (&seed) % MAX_CHUNK;
+
+        if (Mode == 0)
+        {
+            // Peek + Discard, como INDATA sobre el buffer de recepcion
+            const uint32_t Pending = CYCLIC_SPSC_Pending (&s->c);
+            const uint32_t Count = (Want < Pending)? Want : Pending;
+            for (uint32_t i = 0; i < Count; ++i)
+            {
+                if (CYCLIC_SPSC_Peek (&s->c, i) !=
+                        expected (s->received + i))
+                {
+                    ++ s->errors;
+                }
+            }
+            s->received += CYCLIC_SPSC_Discard (&s->c, Count);
+            s->viaPeek  += Count;
+            if (!Count)
+            {
+                sched_yield ();
+            }
+            continue;
+        }
+
+        const uint32_t Count = CYCLIC_SPSC_OutToBuffer (&s->c, chunk, Want);
+        for (uint32_t i = 0; i < Count; ++i)
+        {
+            if (chunk[i] != expected (s->received + i))
+            {
+                ++ s->errors;
+            }
+        }
+        s->received += Count;
+        if (!Count)
+        {
+            sched_yield ();
+        }
+    }
+    return NULL;
+}
+
+
+static double now ()
+{
+    struct timespec t;
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+
+static void stress (uint32_t capacity, uint32_t startIndex)
+{
+    static uint8_t  data[64 * 1024];
+    struct Stress   s = { .total = STRESS_BYTES };
+
+    TEST_CHECK (CYCLIC_SPSC_Init (&s.c, data, capacity));
+
+    // Indices libres cerca de 2^32 para cruzar el desborde durante la prueba
+    s.c.prod.inIndex  = startIndex;
+    s.c.cons.outIndex = startIndex;
+
+    pthread_t p;
+    pthread_t c;
+    const double Start = now ();
+    pthread_create  (&c, NULL, consumer, &s);
+    pthread_create  (&p, NULL, producer, &s);
+    pthread_join    (p, NULL);
+    pthread_join    (c, NULL);
+    const double Seconds = now () - Start;
+
+    printf ("  capacity %5u: %u bytes, %7.1f MB/s, %u rejected by full "
+            "buffer, %u via peek\n", capacity, s.received,
+            s.received / Seconds / 1e6, s.c.prod.overflows, s.viaPeek);
+
+    TEST_CHECK (s.errors == 0);
+    TEST_CHECK (s.received == STRESS_BYTES);
+    TEST_CHECK (s.c.prod.writes == STRESS_BYTES);
+    TEST_CHECK (s.c.cons.reads + s.c.cons.discards == STRESS_BYTES);
+    TEST_CHECK (CYCLIC_SPSC_Pending (&s.c) == 0);
+    TEST_CHECK (s.c.prod.inIndex == startIndex + STRESS_BYTES);
+}
+
+
+static void testTwoThreadStress ()
+{
+    stress (64, 0);
+    stress (1024, 0xFFFFF000u);
+    stress (64 * 1024, 0x80000000u - 100);
+}
+
+
+int main ()
+{
+    TEST_RUN (testTwoThreadStress);
+    return TEST_END ();
+}
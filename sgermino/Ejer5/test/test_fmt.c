@@ -0,0 +1,506 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "fmt.h"
+#include "variant.h"
+#include <stdlib.h>
+
+
+#define BUF_SIZE        64
+#define BENCH_CALLS     200000
+
+
+static char g_fmt  [BUF_SIZE];
+static char g_ref  [BUF_SIZE];
+
+
+// Cada FMT_* debe dar el mismo texto y el mismo largo que snprintf
+static bool same (uint32_t fmtLen, int refLen)
+{
+    return (refLen >= 0 && fmtLen == (uint32_t) refLen
+            && !strcmp (g_fmt, g_ref));
+}
+
+
+// Una muestra espaciada de todo el rango de 32 bits mas los extremos
+static uint32_t sample (uint32_t i)
+{
+    static const uint32_t Edges[] = { 0, 1, 9, 10, 99, 100, 999999999,
+                                      1000000000, 0x7FFFFFFF, 0x80000000,
+                                      0xFFFFFFFF };
+    const uint32_t Count = sizeof(Edges) / sizeof(Edges[0]);
+
+    return (i < Count)? Edges[i] : (i - Count) * 4294967u + (i & 0xFF);
+}
+
+
+static void testUint32 ()
+{
+    uint32_t errors = 0;
+    for (uint32_t i = 0; i < 1011; ++i)
+    {
+        const uint32_t V = sample (i);
+        const uint32_t W = i % 14;
+
+        if (!same (FMT_Uint32 (g_fmt, BUF_SIZE, V, W, ' '),
+                   snprintf (g_ref, BUF_SIZE, "%*u", W, V))
+            || !same (FMT_Uint32 (g_fmt, BUF_SIZE, V, W, '0'),
+                      snprintf (g_ref, BUF_SIZE, "%0*u", W, V)))
+        {
+            if (!errors ++)
+            {
+                printf ("  %u: '%s' != '%s'\n", V, g_fmt, g_ref);
+            }
+        }
+    }
+    TEST_CHECK (!errors);
+}
+
+
+static void testInt32 ()
+{
+    uint32_t errors = 0;
+    for (uint32_t i = 0; i < 1011; ++i)
+    {
+        const int32_t V = (int32_t) sample (i);
+        const uint32_t W = i % 14;
+
+        if (!same (FMT_Int32 (g_fmt, BUF_SIZE, V, W, ' '),
+                   snprintf (g_ref, BUF_SIZE, "%*d", W, V))
+            || !same (FMT_Int32 (g_fmt, BUF_SIZE, V, W, '0'),
+                      snprintf (g_ref, BUF_SIZE, "%0*d", W, V)))
+        {
+            if (!errors ++)
+            {
+                printf ("  %d: '%s' != '%s'\n", V, g_fmt, g_ref);
+            }
+        }
+    }
+    TEST_CHECK (!errors);
+}
+
+
+static void testHex32 ()
+{
+    uint32_t errors = 0;
+    for (uint32_t i = 0; i < 1011; ++i)
+    {
+        const uint32_t V = sample (i);
+        const uint32_t W = i % 12;
+
+        if (!same (FMT_Hex32 (g_fmt, BUF_SIZE, V, W, ' ', false),
+                   snprintf (g_ref, BUF_SIZE, "%*x", W, V))
+            || !same (FMT_Hex32 (g_fmt, BUF_SIZE, V, W, '0', true),
+                      snprintf (g_ref, BUF_SIZE, "%0*X", W, V)))
+        {
+            if (!errors ++)
+            {
+                printf ("  %08x: '%s' != '%s'\n", V, g_fmt, g_ref);
+            }
+        }
+    }
+    TEST_CHECK (!errors);
+}
+
+
+// Patrones de bits espaciados: normales, subnormales, enteros grandes,
+// infinitos y NaN, con 0 a FMT_FLOAT_MAX_DECIMALS decimales
+static void testFloat ()
+{
+    uint32_t errors = 0;
+    for (uint64_t bits = 0; bits <= UINT32_MAX; bits += 65521)
+    {
+        union
+        {
+            uint32_t    u;
+            float       f;
+        }
+        v = { .u = (uint32_t) bits };
+
+        const uint32_t D = (uint32_t)(bits % (FMT_FLOAT_MAX_DECIMALS + 1));
+        const uint32_t W = (uint32_t)(bits % 16);
+
+        if (!same (FMT_Float (g_fmt, BUF_SIZE, v.f, D, 0, ' '),
+                   snprintf (g_ref, BUF_SIZE, "%.*f", D, v.f))
+            || !same (FMT_Float (g_fmt, BUF_SIZE, v.f, D, W, '0'),
+                      snprintf (g_ref, BUF_SIZE, "%0*.*f", W, D, v.f)))
+        {
+            if (!errors ++)
+            {
+                printf ("  %08x: '%s' != '%s'\n", v.u, g_fmt, g_ref);
+            }
+        }
+    }
+    TEST_CHECK (!errors);
+
+    // Empates exactos: al par, como printf
+    TEST_CHECK (same (FMT_Float (g_fmt, BUF_SIZE, 0.5f, 0, 0, ' '),
+                      snprintf (g_ref, BUF_SIZE, "%.0f", 0.5f)));
+    TEST_CHECK (same (FMT_Float (g_fmt, BUF_SIZE, 2.5f, 0, 0, ' '),
+                      snprintf (g_ref, BUF_SIZE, "%.0f", 2.5f)));
+    TEST_CHECK (same (FMT_Float (g_fmt, BUF_SIZE, 0.125f, 2, 0, ' '),
+                      snprintf (g_ref, BUF_SIZE, "%.2f", 0.125f)));
+    TEST_CHECK (same (FMT_Float (g_fmt, BUF_SIZE, 0.9999999f, 3, 0, ' '),
+                      snprintf (g_ref, BUF_SIZE, "%.3f", 0.9999999f)));
+    TEST_CHECK (same (FMT_Float (g_fmt, BUF_SIZE, -0.0f, 1, 0, ' '),
+                      snprintf (g_ref, BUF_SIZE, "%.1f", -0.0f)));
+}
+
+
+// Con buffers chicos se corta igual que snprintf y se devuelve el largo
+// completo
+static void testTruncation ()
+{
+    for (uint32_t size = 0; size < 14; ++size)
+    {
+        memset (g_fmt, 'x', BUF_SIZE);
+        memset (g_ref, 'x', BUF_SIZE);
+
+        TEST_CHECK (FMT_Int32 (g_fmt, size, -123456789, 11, '0')
+                    == (uint32_t) snprintf (g_ref, size, "%011d",
+                                            -123456789));
+        TEST_CHECK (!memcmp (g_fmt, g_ref, BUF_SIZE));
+
+        TEST_CHECK (FMT_Float (g_fmt, size, 3.14159f, 4, 10, ' ')
+                    == (uint32_t) snprintf (g_ref, size, "%10.4f",
+                                            3.14159f));
+        TEST_CHECK (!memcmp (g_fmt, g_ref, BUF_SIZE));
+    }
+
+    TEST_CHECK (FMT_Uint32 (NULL, 0, 4294967295u, 0, ' ') == 10);
+}
+
+
+static volatile uint32_t g_sink;
+
+
+// Ciclos por llamada de FMT_* y de snprintf con el mismo formato
+static void benchFormats ()
+{
+    static const char *Names[] = { "uint32", "int32 ", "hex32 ",
+                                   "float6" };
+    uint64_t cycles[2][4] = { { 0 } };
+
+    for (uint32_t lib = 0; lib < 2; ++lib)
+    {
+        for (uint32_t f = 0; f < 4; ++f)
+        {
+            const uint64_t Start = TEST_Cycles ();
+            for (uint32_t i = 0; i < BENCH_CALLS; ++i)
+            {
+                const uint32_t V = i * 2654435761u;
+                const float    F = (float)(int32_t) V * 1e-4f;
+                uint32_t       len = 0;
+
+                switch (f + lib * 4)
+                {
+                    case 0: len = FMT_Uint32 (g_fmt, BUF_SIZE, V, 0, ' ');
+                            break;
+                    case 1: len = FMT_Int32 (g_fmt, BUF_SIZE, (int32_t) V,
+                                             0, ' ');
+                            break;
+                    case 2: len = FMT_Hex32 (g_fmt, BUF_SIZE, V, 8, '0',
+                                             false);
+                            break;
+                    case 3: len = FMT_Float (g_fmt, BUF_SIZE, F, 6, 0, ' ');
+                            break;
+                    case 4: len = snprintf (g_fmt, BUF_SIZE, "%u", V);
+                            break;
+                    case 5: len = snprintf (g_fmt, BUF_SIZE, "%d",
+                                            (int32_t) V);
+                            break;
+                    case 6: len = snprintf (g_fmt, BUF_SIZE, "%08x", V);
+                            break;
+                    case 7: len = snprintf (g_fmt, BUF_SIZE, "%.6f", F);
+                            break;
+                }
+                g_sink += len + (uint8_t) g_fmt[0];
+            }
+            cycles[lib][f] = (TEST_Cycles () - Start) / BENCH_CALLS;
+        }
+    }
+
+    for (uint32_t f = 0; f < 4; ++f)
+    {
+        printf ("  %s: %4u %s FMT, %4u snprintf (%.1fx)\n", Names[f],
+                (unsigned) cycles[0][f], TEST_CYCLES_UNIT,
+                (unsigned) cycles[1][f],
+                (double) cycles[1][f] / (cycles[0][f]? cycles[0][f] : 1));
+    }
+}
+
+
+// --- VARIANT ----------------------------------------------------------------
+
+// Lo que devolvia VARIANT_ToUint32()/ToInt32() antes del camino rapido
+static uint32_t refUint32 (const char *s)
+{
+    return (uint32_t) strtoul (s, NULL, 0);
+}
+
+
+static int32_t refInt32 (const char *s)
+{
+    return (int32_t) strtol (s, NULL, 0);
+}
+
+
+static bool sameAsStrto (const char *s)
+{
+    struct VARIANT v;
+    VARIANT_SetString (&v, s);
+
+    const bool Same = (VARIANT_ToUint32 (&v) == refUint32 (s)
+                       && VARIANT_ToInt32 (&v) == refInt32 (s));
+    if (!Same)
+    {
+        printf ("  '%s': %u/%d != %u/%d\n", s, VARIANT_ToUint32 (&v),
+                VARIANT_ToInt32 (&v), refUint32 (s), refInt32 (s));
+    }
+    return Same;
+}
+
+
+// Los bordes del decimal de 9 digitos y todo lo que debe seguir yendo a
+// strtoul/strtol
+static void testVariantLiterals ()
+{
+    static const char *Cases[] =
+    {
+        "0", "-0", "7", "-7", "999999999", "-999999999", "1000000000",
+        "-1000000000", "2147483647", "2147483648", "-2147483648",
+        "-2147483649", "4294967295", "4294967296", "99999999999",
+        "0009", "012", "0x1F", "0XfF", " 12", "+12", "12 ", "", "-",
+        "1a", "--1", "-0x10"
+    };
+
+    for (uint32_t i = 0; i < sizeof(Cases) / sizeof(Cases[0]); ++i)
+    {
+        TEST_CHECK (sameAsStrto (Cases[i]));
+    }
+
+    struct VARIANT v;
+    VARIANT_SetString (&v, "999999999");
+    TEST_CHECK (VARIANT_ToUint32 (&v) == 999999999u);
+    VARIANT_SetString (&v, "4294967295");
+    TEST_CHECK (VARIANT_ToUint32 (&v) == 4294967295u);
+    VARIANT_SetString (&v, "-2147483648");
+    TEST_CHECK (VARIANT_ToInt32 (&v) == INT32_MIN);
+}
+
+
+// Cadenas al azar de digitos, ceros a la izquierda, signos y basura
+static void testVariantFuzz ()
+{
+    static const char Alphabet[] = "0123456789000-+ xa";
+    char     s[16];
+    uint32_t errors = 0;
+
+    for (uint32_t n = 0; n < 200000 && errors < 4; ++n)
+    {
+        const uint32_t Len = (uint32_t) rand () % 13;
+        for (uint32_t i = 0; i < Len; ++i)
+        {
+            // Mayormente digitos para llegar seguido al camino rapido
+            s[i] = (rand () % 8)? (char)('0' + rand () % 10)
+                                : Alphabet[rand () % (sizeof(Alphabet) - 1)];
+        }
+        s[Len] = '\0';
+
+        if (!sameAsStrto (s))
+        {
+            ++ errors;
+        }
+    }
+    TEST_CHECK (!errors);
+}
+
+
+// Ciclos por conversion de un literal de hasta 9 digitos
+static void benchVariantLiterals ()
+{
+    static const char *Literals[] = { "0", "42", "-1500", "123456789",
+                                      "-99999999" };
+    const uint32_t Count = sizeof(Literals) / sizeof(Literals[0]);
+    struct VARIANT v[5];
+
+    for (uint32_t i = 0; i < Count; ++i)
+    {
+        VARIANT_SetString (&v[i], Literals[i]);
+    }
+
+    uint64_t start = TEST_Cycles ();
+    for (uint32_t i = 0; i < BENCH_CALLS; ++i)
+    {
+        g_sink += VARIANT_ToUint32 (&v[i % Count]);
+    }
+    const uint64_t Fast = TEST_Cycles () - start;
+
+    start = TEST_Cycles ();
+    for (uint32_t i = 0; i < BENCH_CALLS; ++i)
+    {
+        g_sink += refUint32 (Literals[i % Count]);
+    }
+    const uint64_t Strto = TEST_Cycles () - start;
+
+    printf ("  ToUint32: %4u %s literal, %4u strtoul (%.1fx)\n",
+            (unsigned)(Fast / BENCH_CALLS), TEST_CYCLES_UNIT,
+            (unsigned)(Strto / BENCH_CALLS), (double) Strto / Fast);
+}
+
+
+// struct VARIANT anterior: un buffer de conversion en cada instancia
+struct OLD_VARIANT
+{
+    enum VARIANT_Type   type;
+    char                conv[16];
+    union
+    {
+        uint32_t    u;
+        int32_t     i;
+        float       f;
+        void        *p;
+        const char  *s;
+    };
+};
+
+
+// Modelos de 32 bits (punteros de 4 bytes) para los tamanos en el target
+struct OLD_VARIANT_ILP32    { uint32_t type; char conv[16]; uint32_t v; };
+struct VARIANT_ILP32        { uint32_t type; uint32_t v; };
+
+
+// VARIANT_ToString() anterior seguido de la copia al destino que hacia
+// UART_PutString(): dos pasadas por el texto
+__attribute__((noinline))
+static uint32_t oldPut (struct OLD_VARIANT *v, char *dst, uint32_t size)
+{
+    switch (v->type)
+    {
+        case VARIANT_TypeUint32:
+            FMT_Uint32 (v->conv, sizeof(v->conv), v->u, 0, ' ');
+            break;
+
+        case VARIANT_TypeInt32:
+            FMT_Int32 (v->conv, sizeof(v->conv), v->i, 0, ' ');
+            break;
+
+        default:
+            FMT_Float (v->conv, sizeof(v->conv), v->f, FMT_FLOAT_DECIMALS,
+                       0, ' ');
+            break;
+    }
+
+    const uint32_t Len = strlen (v->conv);
+    memcpy (dst, v->conv, (Len < size)? Len + 1 : size);
+    return Len;
+}
+
+
+// Los nueve argumentos de FSM_PutStatusMessage() y
+// schedulerPutProfileMessage() en el stack, y el costo de formatear cada
+// tipo antes (conv + copia) y ahora (VARIANT_Format() sobre el destino)
+static void benchVariantFormat ()
+{
+    printf ("  args[9]: %u -> %u bytes on host, %u -> %u on the target\n",
+            (unsigned)(9 * sizeof(struct OLD_VARIANT)),
+            (unsigned)(9 * sizeof(struct VARIANT)),
+            (unsigned)(9 * sizeof(struct OLD_VARIANT_ILP32)),
+            (unsigned)(9 * sizeof(struct VARIANT_ILP32)));
+
+    TEST_CHECK (sizeof(struct VARIANT_ILP32) == 8);
+
+    static const char *Names[] = { "uint32", "int32 ", "float6" };
+    static const enum VARIANT_Type Types[] = { VARIANT_TypeUint32,
+                                               VARIANT_TypeInt32,
+                                               VARIANT_TypeFloat };
+
+    for (uint32_t t = 0; t < 3; ++t)
+    {
+        struct OLD_VARIANT  old = { .type = Types[t] };
+        struct VARIANT      v   = { .type = Types[t] };
+
+        uint64_t start = TEST_Cycles ();
+        for (uint32_t i = 0; i < BENCH_CALLS; ++i)
+        {
+            old.u = i * 2654435761u;
+            if (Types[t] == VARIANT_TypeFloat)
+            {
+                old.f = (float)(int32_t) old.u * 1e-4f;
+            }
+            g_sink += oldPut (&old, g_ref, BUF_SIZE);
+        }
+        const uint64_t Before = TEST_Cycles () - start;
+
+        start = TEST_Cycles ();
+        for (uint32_t i = 0; i < BENCH_CALLS; ++i)
+        {
+            v.u = i * 2654435761u;
+            if (Types[t] == VARIANT_TypeFloat)
+            {
+                v.f = (float)(int32_t) v.u * 1e-4f;
+            }
+            g_sink += VARIANT_Format (&v, g_fmt, BUF_SIZE);
+        }
+        const uint64_t After = TEST_Cycles () - start;
+
+        TEST_CHECK (!strcmp (g_fmt, g_ref));
+
+        printf ("  %s: %4u %s before, %4u after\n", Names[t],
+                (unsigned)(Before / BENCH_CALLS), TEST_CYCLES_UNIT,
+                (unsigned)(After / BENCH_CALLS));
+    }
+
+    // Antes un float se cortaba en 15 caracteres
+    struct VARIANT v;
+    VARIANT_SetFloat (&v, -3.0e38f);
+    TEST_CHECK (VARIANT_Format (&v, g_fmt, BUF_SIZE)
+                == (uint32_t) snprintf (g_ref, BUF_SIZE, "%.6f", -3.0e38f));
+    TEST_CHECK (!strcmp (g_fmt, g_ref));
+}
+
+
+int main ()
+{
+    srand (1);
+
+    TEST_RUN (testUint32);
+    TEST_RUN (testInt32);
+    TEST_RUN (testHex32);
+    TEST_RUN (testFloat);
+    TEST_RUN (testTruncation);
+    TEST_RUN (benchFormats);
+    TEST_RUN (testVariantLiterals);
+    TEST_RUN (testVariantFuzz);
+    TEST_RUN (benchVariantLiterals);
+    TEST_RUN (benchVariantFormat);
+    return TEST_END ();
+}
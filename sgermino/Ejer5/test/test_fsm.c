@@ -0,0 +1,937 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "alarm.h"
+#include "fsm.h"
+#include "swtimer.h"
+#include "systick.h"
+#include "chip.h"
+#include <stdlib.h>
+
+
+#define DOOR_DISARM_MAX_RETRIES     3
+#define SENSOR_DOOR                 0b0001
+
+#define SCRIPT_STEPS                200000
+#define BENCH_CYCLES                200000
+#define TRACE_SIZE                  32
+#define TRANSITIONS                 2000000
+
+
+// Mensajes de la alarma, en lugar del texto enviado por UART
+enum Msg
+{
+    Msg_Newline = 1,
+    Msg_PasswordInput,
+    Msg_PasswordMatch,
+    Msg_WrongPassword,
+    Msg_PasswordToArm,
+    Msg_ArmingBegin,
+    Msg_ArmingCancelled,
+    Msg_ArmingEnd,
+    Msg_ArmedPasswordToDisarm,
+    Msg_SensorWindow,
+    Msg_SensorDoor,
+    Msg_IntruderPasswordToDisarm,
+    Msg_DoorPasswordToDisarm,
+    Msg_DoorPasswordToDisarmAgain
+};
+
+
+enum Led
+{
+    Led_Green,
+    Led_Red,
+    Led_Blue
+};
+
+
+enum Input
+{
+    Input_None,
+    Input_Request,
+    Input_Right,
+    Input_Wrong
+};
+
+
+enum PasswordAction
+{
+    PasswordAction_None,
+    PasswordAction_Asking,
+    PasswordAction_AskAgain,
+    PasswordAction_Match
+};
+
+
+// Lo que main.c guarda en struct APP y envia por UART, para las dos MEF
+struct ALARM
+{
+    struct FEM          fem;
+    uint32_t            sensorStatus;
+    uint32_t            disarmRetries;
+    uint32_t            ledStatus;
+    bool                cancelRequest;
+    bool                prompt;
+    enum Input          input;
+    uint32_t            trace       [TRACE_SIZE];
+    uint32_t            traceCount;
+};
+
+
+static struct ALARM     g_legacy;
+static struct ALARM     g_table;
+
+
+static void put (struct ALARM *a, uint32_t msg)
+{
+    if (a->traceCount < TRACE_SIZE)
+    {
+        a->trace[a->traceCount ++] = msg;
+    }
+}
+
+
+static void updateLed (struct ALARM *a, enum Led led, bool on, bool toggling)
+{
+    const uint32_t Shift = led << 1;
+    a->ledStatus = (a->ledStatus & ~(0b11 << Shift)) |
+                        (on << Shift) | (toggling << (Shift + 1));
+}
+
+
+static void clearRequests (struct ALARM *a)
+{
+    a->cancelRequest = false;
+    if (a->prompt)
+    {
+        put (a, Msg_Newline);
+    }
+    a->prompt   = false;
+    a->input    = Input_None;
+}
+
+
+// APP_PasswordLogic() con el ingreso por INDATA reemplazado por 'input'
+static enum PasswordAction passwordLogic (struct ALARM *a)
+{
+    const enum Input Input = a->input;
+    a->input = Input_None;
+
+    if (!a->prompt)
+    {
+        if (Input != Input_Request)
+        {
+            return PasswordAction_None;
+        }
+        clearRequests   (a);
+        put             (a, Msg_PasswordInput);
+        updateLed       (a, Led_Blue, true, false);
+        a->prompt = true;
+        return PasswordAction_Asking;
+    }
+
+    if (Input == Input_None || Input == Input_Request)
+    {
+        return PasswordAction_None;
+    }
+
+    a->prompt = false;
+    updateLed (a, Led_Blue, false, false);
+    if (Input == Input_Right)
+    {
+        put (a, Msg_PasswordMatch);
+        return PasswordAction_Match;
+    }
+    put (a, Msg_WrongPassword);
+    return PasswordAction_AskAgain;
+}
+
+
+static struct ALARM * alarmOf (struct FEM *f)
+{
+    return (struct ALARM *) f->app;
+}
+
+
+// ---------------------------------------------------------------------------
+// MEF por punteros a funcion: los estados de main.c antes del motor por
+// tabla, con el estado de la alarma consultado en cada llamada
+// ---------------------------------------------------------------------------
+
+static enum FSM_StateReturn legacyDiegoArmando (struct FEM *f,
+                                        enum FSM_Stage stage, uint32_t ticks);
+static enum FSM_StateReturn legacyArmada (struct FEM *f,
+                                        enum FSM_Stage stage, uint32_t ticks);
+static enum FSM_StateReturn legacyIntruso (struct FEM *f,
+                                        enum FSM_Stage stage, uint32_t ticks);
+static enum FSM_StateReturn legacyDesarmando (struct FEM *f,
+                                        enum FSM_Stage stage, uint32_t ticks);
+
+
+static enum FSM_StateReturn legacyDesarmada (struct FEM *f,
+                                        enum FSM_Stage stage, uint32_t ticks)
+{
+    struct ALARM *a = alarmOf (f);
+
+    switch (stage)
+    {
+        case FSM_StageBegin:
+            clearRequests   (a);
+            updateLed       (a, Led_Green, true, false);
+            put             (a, Msg_PasswordToArm);
+            FSM_GotoStage   (f, FSM_StageMain);
+            break;
+
+        case FSM_StageMain:
+        {
+            const enum PasswordAction Pl = passwordLogic (a);
+            if (Pl == PasswordAction_Asking)
+            {
+                updateLed       (a, Led_Green, false, false);
+            }
+            else if (Pl == PasswordAction_AskAgain)
+            {
+                FSM_GotoStage   (f, FSM_StageBegin);
+            }
+            else if (Pl == PasswordAction_Match)
+            {
+                FSM_ChangeState (f, legacyDiegoArmando);
+            }
+            break;
+        }
+
+        case FSM_StageEnd:
+            break;
+    }
+
+    return FSM_StateReturnYield;
+}
+
+
+static enum FSM_StateReturn legacyDiegoArmando (struct FEM *f,
+                                        enum FSM_Stage stage, uint32_t ticks)
+{
+    struct ALARM *a = alarmOf (f);
+
+    switch (stage)
+    {
+        case FSM_StageBegin:
+            clearRequests   (a);
+            put             (a, Msg_ArmingBegin);
+            put             (a, ARMING_PERIOD_MSEC / 1000);
+            updateLed       (a, Led_Green, true, true);
+            FSM_GotoStage   (f, FSM_StageMain);
+            break;
+
+        case FSM_StageMain:
+            if (a->cancelRequest)
+            {
+                clearRequests   (a);
+                put             (a, Msg_ArmingCancelled);
+                FSM_ChangeState (f, legacyDesarmada);
+            }
+            else if (FSM_StageTimeout (f, ARMING_PERIOD_MSEC))
+            {
+                FSM_GotoStage   (f, FSM_StageEnd);
+            }
+            break;
+
+        case FSM_StageEnd:
+            put             (a, Msg_ArmingEnd);
+            updateLed       (a, Led_Green, false, false);
+            FSM_ChangeState (f, legacyArmada);
+            break;
+    }
+
+    return FSM_StateReturnYield;
+}
+
+
+static enum FSM_StateReturn legacyArmada (struct FEM *f,
+                                        enum FSM_Stage stage, uint32_t ticks)
+{
+    struct ALARM *a = alarmOf (f);
+
+    switch (stage)
+    {
+        case FSM_StageBegin:
+            clearRequests   (a);
+            put             (a, Msg_ArmedPasswordToDisarm);
+            updateLed       (a, Led_Red, true, false);
+            FSM_GotoStage   (f, FSM_StageMain);
+            break;
+
+        case FSM_StageMain:
+        {
+            if (a->sensorStatus)
+            {
+                FSM_GotoStage   (f, FSM_StageEnd);
+                return FSM_StateReturnAgain;
+            }
+
+            const enum PasswordAction Pl = passwordLogic (a);
+            if (Pl == PasswordAction_Asking)
+            {
+                updateLed       (a, Led_Red, false, false);
+            }
+            else if (Pl == PasswordAction_AskAgain)
+            {
+                FSM_GotoStage   (f, FSM_StageBegin);
+            }
+            else if (Pl == PasswordAction_Match)
+            {
+                FSM_ChangeState (f, legacyDesarmada);
+            }
+            break;
+        }
+
+        case FSM_StageEnd:
+            if (a->sensorStatus & ~SENSOR_DOOR)
+            {
+                put             (a, Msg_SensorWindow);
+                FSM_ChangeState (f, legacyIntruso);
+            }
+            else if (a->sensorStatus & SENSOR_DOOR)
+            {
+                put             (a, Msg_SensorDoor);
+                FSM_ChangeState (f, legacyDesarmando);
+            }
+            updateLed (a, Led_Red, false, false);
+            break;
+    }
+
+    return FSM_StateReturnYield;
+}
+
+
+static enum FSM_StateReturn legacyIntruso (struct FEM *f,
+                                        enum FSM_Stage stage, uint32_t ticks)
+{
+    struct ALARM *a = alarmOf (f);
+
+    switch (stage)
+    {
+        case FSM_StageBegin:
+            clearRequests   (a);
+            put             (a, Msg_IntruderPasswordToDisarm);
+            updateLed       (a, Led_Red, true, true);
+            FSM_GotoStage   (f, FSM_StageMain);
+            break;
+
+        case FSM_StageMain:
+        {
+            const enum PasswordAction Pl = passwordLogic (a);
+            if (Pl == PasswordAction_Asking)
+            {
+                updateLed       (a, Led_Red, false, false);
+            }
+            else if (Pl == PasswordAction_AskAgain)
+            {
+                FSM_GotoStage   (f, FSM_StageBegin);
+            }
+            else if (Pl == PasswordAction_Match)
+            {
+                FSM_ChangeState (f, legacyDesarmada);
+            }
+            break;
+        }
+
+        case FSM_StageEnd:
+            break;
+    }
+
+    return FSM_StateReturnYield;
+}
+
+
+static enum FSM_StateReturn legacyDesarmando (struct FEM *f,
+                                        enum FSM_Stage stage, uint32_t ticks)
+{
+    struct ALARM *a = alarmOf (f);
+
+    switch (stage)
+    {
+        case FSM_StageBegin:
+            a->disarmRetries = 0;
+            clearRequests       (a);
+            FSM_StateCountdown  (f, DOOR_DISARMING_MSEC);
+            put                 (a, Msg_DoorPasswordToDisarm);
+            put                 (a, FSM_StateCountdownSeconds (f));
+            updateLed           (a, Led_Red, true, false);
+            FSM_GotoStage       (f, FSM_StageMain);
+            return FSM_StateReturnAgain;
+
+        case FSM_StageMain:
+        {
+            if (FSM_StateCountdown (f, 0))
+            {
+                FSM_ChangeState (f, legacyIntruso);
+                return FSM_StateReturnYield;
+            }
+
+            const enum PasswordAction Pl = passwordLogic (a);
+            if (Pl == PasswordAction_Asking)
+            {
+                updateLed       (a, Led_Red, false, false);
+            }
+            else if (Pl == PasswordAction_AskAgain)
+            {
+                if (++ a->disarmRetries >= DOOR_DISARM_MAX_RETRIES)
+                {
+                    FSM_ChangeState (f, legacyIntruso);
+                    return FSM_StateReturnYield;
+                }
+                updateLed   (a, Led_Red, true, false);
+                put         (a, Msg_DoorPasswordToDisarmAgain);
+                put         (a, DOOR_DISARM_MAX_RETRIES - a->disarmRetries);
+                put         (a, Msg_DoorPasswordToDisarm);
+                put         (a, FSM_StateCountdownSeconds (f));
+            }
+            else if (Pl == PasswordAction_Match)
+            {
+                FSM_ChangeState (f, legacyDiegoArmando);
+            }
+            break;
+        }
+
+        case FSM_StageEnd:
+            break;
+    }
+
+    return FSM_StateReturnYield;
+}
+
+
+// ---------------------------------------------------------------------------
+// Acciones de AlarmTable (alarm.c), como en main.c
+// ---------------------------------------------------------------------------
+
+static void postSensorEvent (struct ALARM *a)
+{
+    if (a->sensorStatus & ~SENSOR_DOOR)
+    {
+        FSM_Post (&a->fem, APP_EventSensorWindow);
+    }
+    else if (a->sensorStatus & SENSOR_DOOR)
+    {
+        FSM_Post (&a->fem, APP_EventSensorDoor);
+    }
+}
+
+
+void FEMState_DesarmadaEntry (struct FEM *f)
+{
+    struct ALARM *a = alarmOf (f);
+
+    clearRequests   (a);
+    updateLed       (a, Led_Green, true, false);
+    put             (a, Msg_PasswordToArm);
+}
+
+
+void FEMState_DiegoArmandoEntry (struct FEM *f)
+{
+    struct ALARM *a = alarmOf (f);
+
+    clearRequests   (a);
+    put             (a, Msg_ArmingBegin);
+    put             (a, ARMING_PERIOD_MSEC / 1000);
+    updateLed       (a, Led_Green, true, true);
+}
+
+
+void FEMState_DiegoArmandoCancel (struct FEM *f)
+{
+    struct ALARM *a = alarmOf (f);
+
+    clearRequests   (a);
+    put             (a, Msg_ArmingCancelled);
+}
+
+
+void FEMState_DiegoArmandoTimeout (struct FEM *f)
+{
+    struct ALARM *a = alarmOf (f);
+
+    put             (a, Msg_ArmingEnd);
+    updateLed       (a, Led_Green, false, false);
+}
+
+
+void FEMState_ArmadaEntry (struct FEM *f)
+{
+    struct ALARM *a = alarmOf (f);
+
+    clearRequests   (a);
+    put             (a, Msg_ArmedPasswordToDisarm);
+    updateLed       (a, Led_Red, true, false);
+    postSensorEvent (a);
+}
+
+
+void FEMState_ArmadaExit (struct FEM *f)
+{
+    updateLed (alarmOf (f), Led_Red, false, false);
+}
+
+
+void FEMState_ArmadaSensorWindow (struct FEM *f)
+{
+    put (alarmOf (f), Msg_SensorWindow);
+}
+
+
+void FEMState_ArmadaSensorDoor (struct FEM *f)
+{
+    put (alarmOf (f), Msg_SensorDoor);
+}
+
+
+void FEMState_IntrusoEntry (struct FEM *f)
+{
+    struct ALARM *a = alarmOf (f);
+
+    clearRequests   (a);
+    put             (a, Msg_IntruderPasswordToDisarm);
+    updateLed       (a, Led_Red, true, true);
+}
+
+
+void FEMState_PasswordAsking (struct FEM *f)
+{
+    struct ALARM *a = alarmOf (f);
+
+    updateLed (a, Led_Green, false, false);
+    updateLed (a, Led_Red, false, false);
+}
+
+
+void FEMState_DesarmandoEntry (struct FEM *f)
+{
+    struct ALARM *a = alarmOf (f);
+
+    a->disarmRetries = 0;
+    clearRequests   (a);
+    put             (a, Msg_DoorPasswordToDisarm);
+    put             (a, FSM_StateCountdownSeconds (f));
+    updateLed       (a, Led_Red, true, false);
+}
+
+
+void FEMState_DesarmandoAskAgain (struct FEM *f)
+{
+    struct ALARM *a = alarmOf (f);
+
+    if (++ a->disarmRetries >= DOOR_DISARM_MAX_RETRIES)
+    {
+        FSM_Dispatch (f, APP_EventRetriesExhausted);
+        return;
+    }
+
+    updateLed   (a, Led_Red, true, false);
+    put         (a, Msg_DoorPasswordToDisarmAgain);
+    put         (a, DOOR_DISARM_MAX_RETRIES - a->disarmRetries);
+    put         (a, Msg_DoorPasswordToDisarm);
+    put         (a, FSM_StateCountdownSeconds (f));
+}
+
+
+// ---------------------------------------------------------------------------
+// Guion
+// ---------------------------------------------------------------------------
+
+static void setup ()
+{
+    FAKE_SysTickReset (0);
+    memset (&g_legacy, 0, sizeof(g_legacy));
+    memset (&g_table, 0, sizeof(g_table));
+
+    FSM_Init        (&g_legacy.fem, &g_legacy);
+    FSM_ChangeState (&g_legacy.fem, legacyDesarmada);
+    TEST_CHECK (FSM_InitTable (&g_table.fem, &AlarmTable,
+                               APP_StateDesarmada, &g_table));
+}
+
+
+// alarmFEMTask de antes, llamada hasta que una corrida no cambie ni de
+// estado ni de etapa: la MEF por tabla completa en un FSM_Process() lo que
+// la anterior hacia en varios periodos
+static void runLegacy (struct ALARM *a)
+{
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        const FSM_StateFunc State = a->fem.state;
+        const enum FSM_Stage Stage = a->fem.stage;
+        FSM_Process (&a->fem, SYSTICK_Now (), 0);
+
+        if (a->fem.state == State && a->fem.stage == Stage)
+        {
+            break;
+        }
+    }
+}
+
+
+// uartProcessTask y alarmFEMTask actuales
+static void runTable (struct ALARM *a)
+{
+    SWTIMER_Process (SYSTICK_Now ());
+
+    if (FSM_Handles (&a->fem, APP_EventPasswordMatch))
+    {
+        switch (passwordLogic (a))
+        {
+            case PasswordAction_Asking:
+                FSM_Post (&a->fem, APP_EventPasswordAsking);
+                break;
+
+            case PasswordAction_AskAgain:
+                FSM_Post (&a->fem, APP_EventPasswordAskAgain);
+                break;
+
+            case PasswordAction_Match:
+                FSM_Post (&a->fem, APP_EventPasswordMatch);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    FSM_Process (&a->fem, SYSTICK_Now (), 1);
+}
+
+
+static void input (enum Input in)
+{
+    g_legacy.input = g_table.input = in;
+}
+
+
+static void cancel ()
+{
+    g_legacy.cancelRequest = true;
+    FSM_Post (&g_table.fem, APP_EventCancel);
+}
+
+
+static void toggleSensor (uint32_t sensor)
+{
+    g_legacy.sensorStatus ^= sensor;
+    g_table.sensorStatus  ^= sensor;
+    postSensorEvent (&g_table);
+}
+
+
+static void step ()
+{
+    g_legacy.traceCount = 0;
+    g_table.traceCount  = 0;
+    runLegacy   (&g_legacy);
+    runTable    (&g_table);
+}
+
+
+static enum APP_State legacyState (struct ALARM *a)
+{
+    const FSM_StateFunc State = a->fem.state;
+
+    return (State == legacyDesarmada)?      APP_StateDesarmada :
+           (State == legacyDiegoArmando)?   APP_StateDiegoArmando :
+           (State == legacyArmada)?         APP_StateArmada :
+           (State == legacyIntruso)?        APP_StateIntruso :
+           (State == legacyDesarmando)?     APP_StateDesarmando :
+                                            APP_StateNone;
+}
+
+
+static bool sameAlarm ()
+{
+    return (legacyState (&g_legacy) == g_table.fem.stateId &&
+            g_legacy.traceCount == g_table.traceCount &&
+            !memcmp (g_legacy.trace, g_table.trace,
+                     g_table.traceCount * sizeof(uint32_t)) &&
+            g_legacy.ledStatus == g_table.ledStatus &&
+            g_legacy.disarmRetries == g_table.disarmRetries);
+}
+
+
+// Las dos MEF reciben el mismo guion de passwords, cancelaciones, sensores
+// y paso del tiempo; tras cada paso deben estar en el mismo estado, con los
+// mismos mensajes y leds.
+static void testSameAsLegacy ()
+{
+    uint32_t visits[APP_State_COUNT] = { 0 };
+    uint32_t lost = 0;
+    bool same = true;
+
+    setup ();
+    step ();
+    srand (17);
+
+    for (uint32_t i = 0; i < SCRIPT_STEPS && same; ++i)
+    {
+        const uint32_t R = (uint32_t) rand () % 100;
+        if (R < 25)
+        {
+            FAKE_SysTickStep (1 + (uint32_t) rand () % 2000);
+        }
+        else if (R < 45 && !g_table.prompt)
+        {
+            input (Input_Request);
+        }
+        else if (R < 60 && g_table.prompt)
+        {
+            input ((rand () % 3)? Input_Wrong : Input_Right);
+        }
+        else if (R < 63)
+        {
+            cancel ();
+        }
+        else if (R < 75)
+        {
+            toggleSensor (1u << ((uint32_t) rand () % 4));
+        }
+
+        step ();
+        same = sameAlarm ();
+        ++ visits[g_table.fem.stateId];
+        lost += g_table.fem.eventsLost;
+    }
+
+    printf ("  %u steps:", SCRIPT_STEPS);
+    for (uint32_t s = APP_StateDesarmada; s < APP_State_COUNT; ++s)
+    {
+        printf (" %s %u", AlarmTable.states[s].info, visits[s]);
+        TEST_CHECK (visits[s]);
+    }
+    printf ("\n");
+
+    TEST_CHECK (same);
+    TEST_CHECK (!lost);
+}
+
+
+typedef void (* RunFunc) (struct ALARM *a);
+
+
+// Desarmada -pedido-> Password -incorrecto-> Desarmada -pedido-> Password
+// -correcto-> DiegoArmando -cancelar-> Desarmada: cinco transiciones
+static double transitionsPerSecond (RunFunc run, struct ALARM *a)
+{
+    const double Start = TEST_Seconds ();
+    for (uint32_t i = 0; i < BENCH_CYCLES; ++i)
+    {
+        a->input = Input_Request;
+        run (a);
+        a->input = Input_Wrong;
+        run (a);
+        a->input = Input_Request;
+        run (a);
+        a->input = Input_Right;
+        run (a);
+        if (a == &g_table)
+        {
+            FSM_Post (&a->fem, APP_EventCancel);
+        }
+        a->cancelRequest = true;
+        run (a);
+        a->traceCount = 0;
+    }
+    return BENCH_CYCLES * 5 / (TEST_Seconds () - Start);
+}
+
+
+static void benchTransitions ()
+{
+    setup ();
+    step ();
+
+    const double Legacy = transitionsPerSecond (runLegacy, &g_legacy);
+    const double Table  = transitionsPerSecond (runTable, &g_table);
+
+    printf ("  legacy %.2f M transitions/s, table %.2f M transitions/s "
+            "(%.2fx)\n", Legacy * 1e-6, Table * 1e-6, Table / Legacy);
+    TEST_CHECK (legacyState (&g_legacy) == APP_StateDesarmada);
+    TEST_CHECK (g_table.fem.stateId == APP_StateDesarmada);
+}
+
+
+// FSM_InitTable() acepta el lca constante de AlarmTable y rechaza una copia
+// con cualquiera de sus entradas cambiada, o sin lca con estados anidados
+static void testLcaChecked ()
+{
+    const uint32_t Count = APP_State_COUNT * APP_State_COUNT;
+    uint8_t lca[APP_State_COUNT * APP_State_COUNT];
+    struct FSM_Table table = AlarmTable;
+    struct FEM f;
+    uint32_t rejected = 0;
+
+    TEST_CHECK (FSM_InitTable (&f, &AlarmTable, APP_StateDesarmada, NULL));
+
+    memcpy (lca, AlarmTable.lca, sizeof(lca));
+    table.lca = lca;
+    TEST_CHECK (FSM_InitTable (&f, &table, APP_StateDesarmada, NULL));
+
+    for (uint32_t i = 0; i < Count; ++i)
+    {
+        lca[i] = (lca[i] + 1) % APP_State_COUNT;
+        rejected += !FSM_InitTable (&f, &table, APP_StateDesarmada, NULL);
+        lca[i] = AlarmTable.lca[i];
+    }
+    TEST_CHECK (rejected == Count);
+
+    table.lca = NULL;
+    TEST_CHECK (!FSM_InitTable (&f, &table, APP_StateDesarmada, NULL));
+}
+
+
+// La busqueda que evita el lca precalculado: subir desde el origen hasta un
+// ancestro propio del destino
+static bool isAncestor (uint8_t ancestor, uint8_t state)
+{
+    while (state != FSM_StateNone)
+    {
+        state = AlarmTable.states[state].parent;
+        if (state == ancestor)
+        {
+            return true;
+        }
+    }
+    return (ancestor == FSM_StateNone);
+}
+
+
+__attribute__((noipa))
+static uint8_t lcaSearch (uint8_t a, uint8_t b)
+{
+    uint8_t lca = AlarmTable.states[a].parent;
+    while (!isAncestor (lca, b))
+    {
+        lca = AlarmTable.states[lca].parent;
+    }
+    return lca;
+}
+
+
+__attribute__((noipa))
+static uint8_t lcaLookup (uint8_t a, uint8_t b)
+{
+    return AlarmTable.lca[a * AlarmTable.stateCount + b];
+}
+
+
+// Ciclos de FSM_Dispatch() desde 'state' con 'event', segun cuantos estados
+// sale y entra la transicion
+static double dispatchCycles (uint8_t state, uint8_t event)
+{
+    struct FEM *f = &g_table.fem;
+
+    const uint64_t Start = TEST_Cycles ();
+    for (uint32_t i = 0; i < TRANSITIONS; ++i)
+    {
+        f->stateId = state;
+        FSM_Dispatch (f, event);
+        g_table.traceCount = 0;
+    }
+    return (double)(TEST_Cycles () - Start) / TRANSITIONS;
+}
+
+
+static double lcaCycles (uint8_t (* lcaFunc) (uint8_t a, uint8_t b))
+{
+    uint32_t sum = 0;
+
+    const uint64_t Start = TEST_Cycles ();
+    for (uint32_t i = 0; i < TRANSITIONS; ++i)
+    {
+        for (uint8_t a = 1; a < APP_State_COUNT; ++a)
+        {
+            for (uint8_t b = 1; b < APP_State_COUNT; ++b)
+            {
+                sum += lcaFunc (a, b);
+            }
+        }
+    }
+    const uint32_t Pairs = (APP_State_COUNT - 1) * (APP_State_COUNT - 1);
+    TEST_CHECK (sum);
+    return (double)(TEST_Cycles () - Start) / ((double) TRANSITIONS * Pairs);
+}
+
+
+static void benchTransitionCost ()
+{
+    setup ();
+    step ();
+
+    // Interna: solo la accion
+    const double Internal = dispatchCycles (APP_StateDesarmada,
+                                            APP_EventPasswordAsking);
+    // Self: sale y entra a Desarmada
+    const double Self = dispatchCycles (APP_StateDesarmada,
+                                        APP_EventPasswordAskAgain);
+    // Atendida por Activa: sale de Intruso y Activa, entra a Desarmada
+    const double Parent = dispatchCycles (APP_StateIntruso,
+                                          APP_EventPasswordMatch);
+    // Desde la raiz: entra a Password, Activa y Armada
+    const double Root = dispatchCycles (APP_StateDiegoArmando,
+                                        APP_EventTimeout);
+
+    printf ("  FSM_Dispatch: %.0f internal, %.0f self, %.0f from parent, "
+            "%.0f from root " TEST_CYCLES_UNIT "\n", Internal, Self, Parent,
+            Root);
+
+    bool same = true;
+    for (uint8_t a = 1; a < APP_State_COUNT; ++a)
+    {
+        for (uint8_t b = 1; b < APP_State_COUNT; ++b)
+        {
+            same &= (lcaLookup (a, b) == lcaSearch (a, b));
+        }
+    }
+    TEST_CHECK (same);
+
+    const double Lookup = lcaCycles (lcaLookup);
+    const double Search = lcaCycles (lcaSearch);
+    printf ("  lca: %.1f " TEST_CYCLES_UNIT " lookup, %.1f searching parents "
+            "(mean of all pairs)\n", Lookup, Search);
+}
+
+
+int main ()
+{
+    TEST_RUN (testSameAsLegacy);
+    TEST_RUN (testLcaChecked);
+    TEST_RUN (benchTransitions);
+    TEST_RUN (benchTransitionCost);
+    return TEST_END ();
+}
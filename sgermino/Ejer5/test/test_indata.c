@@ -0,0 +1,151 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "indata.h"
+#include "chip.h"
+#include <string.h>
+
+
+static struct UART      g_uart;
+static struct INDATA    g_indata;
+
+
+static void setup (enum INDATA_Type type)
+{
+    UART_RecvDiscardPending (&g_uart);
+    TEST_CHECK (INDATA_Begin (&g_indata, type));
+}
+
+
+static void input (const char *text)
+{
+    while (*text)
+    {
+        TEST_CHECK (UART_RecvInjectByte (&g_uart, (uint8_t) *text ++));
+    }
+}
+
+
+static bool dataIs (const char *text)
+{
+    return (g_indata.a.index == strlen (text)
+            && !memcmp (g_indata.a.data, text, g_indata.a.index));
+}
+
+
+// Lo que sigue al Enter no es parte del dato y queda en el buffer de
+// recepcion, por ej. el proximo comando
+static void testStopsAtEnter ()
+{
+    setup (INDATA_TypeDecimal);
+    input ("12\rxy");
+
+    TEST_CHECK (INDATA_Prompt (&g_indata));
+    TEST_CHECK (INDATA_Status (&g_indata) == INDATA_StatusReady);
+    TEST_CHECK (dataIs ("12"));
+    TEST_CHECK (UART_RecvPendingCount (&g_uart) == 2);
+    TEST_CHECK (UART_RecvPeek (&g_uart, 0) == 'x');
+}
+
+
+// Igual con un dato invalido
+static void testStopsAtInvalid ()
+{
+    setup (INDATA_TypeDecimal);
+    input ("1a\rz");
+
+    TEST_CHECK (INDATA_Prompt (&g_indata));
+    TEST_CHECK (INDATA_Status (&g_indata) == INDATA_StatusInvalid);
+    TEST_CHECK (UART_RecvPendingCount (&g_uart) == 1);
+    TEST_CHECK (UART_RecvPeek (&g_uart, 0) == 'z');
+}
+
+
+// Sin Enter se consume todo y el dato sigue en la proxima llamada
+static void testAcrossCalls ()
+{
+    setup (INDATA_TypeDecimal);
+    input ("1");
+
+    TEST_CHECK (INDATA_Prompt (&g_indata));
+    TEST_CHECK (INDATA_Status (&g_indata) == INDATA_StatusPrompt);
+    TEST_CHECK (UART_RecvPendingCount (&g_uart) == 0);
+
+    input ("2\r");
+    TEST_CHECK (INDATA_Prompt (&g_indata));
+    TEST_CHECK (INDATA_Status (&g_indata) == INDATA_StatusReady);
+    TEST_CHECK (dataIs ("12"));
+    TEST_CHECK (UART_RecvPendingCount (&g_uart) == 0);
+}
+
+
+// Suprimir y flecha derecha con el cursor en el ultimo caracter, de uno y
+// de dos bytes
+static void testLastChar ()
+{
+    setup (INDATA_TypeAlphanum);
+    input ("123\x1B[D\x1B[3~");
+    TEST_CHECK (INDATA_Prompt (&g_indata));
+    TEST_CHECK (dataIs ("12"));
+    TEST_CHECK (g_indata.cursor == 2);
+
+    input ("\x1B[D\x1B[C");
+    TEST_CHECK (INDATA_Prompt (&g_indata));
+    TEST_CHECK (g_indata.cursor == 2);
+
+    input ("\xC3\xB1\x1B[D");
+    TEST_CHECK (INDATA_Prompt (&g_indata));
+    TEST_CHECK (dataIs ("12\xC3\xB1"));
+    TEST_CHECK (g_indata.cursor == 2);
+
+    input ("\x1B[C");
+    TEST_CHECK (INDATA_Prompt (&g_indata));
+    TEST_CHECK (g_indata.cursor == 4);
+
+    input ("\x1B[D\x1B[3~");
+    TEST_CHECK (INDATA_Prompt (&g_indata));
+    TEST_CHECK (dataIs ("12"));
+    TEST_CHECK (g_indata.cursor == 2);
+}
+
+
+int main ()
+{
+    FAKE_Reset  ();
+    UART_Init   (&g_uart, LPC_USART2, 115200);
+    INDATA_Init (&g_indata, &g_uart);
+
+    TEST_RUN (testStopsAtEnter);
+    TEST_RUN (testStopsAtInvalid);
+    TEST_RUN (testAcrossCalls);
+    TEST_RUN (testLastChar);
+    return TEST_END ();
+}
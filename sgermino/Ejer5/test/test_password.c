@@ -0,0 +1,361 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "password.h"
+#include "chip.h"
+#include <stdlib.h>
+
+
+#define HASH_SECONDS        0.5
+#define COMPARE_SAMPLES     20001
+#define COMPARE_BATCH       16
+
+// magic + PASSWORD + check, como struct Record de password.c
+#define RECORD_SIZE         (4 + sizeof(struct PASSWORD) + 4)
+
+
+struct Vector
+{
+    const char      *message;
+    const char      *digest;
+};
+
+
+// FIPS 180-2, apendice B
+static const struct Vector g_vectors[] =
+{
+    { "",
+      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+    { "abc",
+      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+    { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" }
+};
+
+
+static void toHex (const uint8_t digest[SHA256_DIGEST_SIZE], char *hex)
+{
+    for (uint32_t i = 0; i < SHA256_DIGEST_SIZE; ++i)
+    {
+        sprintf (&hex[i * 2], "%02x", digest[i]);
+    }
+}
+
+
+static void setPlain (struct ARRAY *a, uint8_t *buffer, const char *str)
+{
+    ARRAY_InitFlags     (a, buffer, PASSWORD_MAX_SIZE + 2, ARRAY_FlagNone);
+    ARRAY_AppendString  (a, str);
+}
+
+
+static bool checkPlain (struct PASSWORD *p, const char *str)
+{
+    uint8_t buffer[PASSWORD_MAX_SIZE + 2];
+    struct ARRAY a;
+    setPlain (&a, buffer, str);
+    return PASSWORD_Check (p, &a);
+}
+
+
+static bool setPlainPassword (struct PASSWORD *p, const char *str)
+{
+    uint8_t buffer[PASSWORD_MAX_SIZE + 2];
+    struct ARRAY a;
+    setPlain (&a, buffer, str);
+    return PASSWORD_Set (p, &a);
+}
+
+
+// Digesto de una vez y de a un byte: el resultado no depende de como se
+// parten los datos entre SHA256_Update()
+static void testSha256Vectors ()
+{
+    for (uint32_t v = 0; v < sizeof(g_vectors) / sizeof(g_vectors[0]); ++v)
+    {
+        const uint8_t *msg  = (const uint8_t *) g_vectors[v].message;
+        const uint32_t Size = strlen (g_vectors[v].message);
+        uint8_t digest[SHA256_DIGEST_SIZE];
+        char hex[SHA256_DIGEST_SIZE * 2 + 1];
+        struct SHA256 s;
+
+        TEST_CHECK (SHA256_Init (&s));
+        TEST_CHECK (SHA256_Update (&s, msg, Size));
+        TEST_CHECK (SHA256_Final (&s, digest));
+        toHex (digest, hex);
+        TEST_CHECK (!strcmp (hex, g_vectors[v].digest));
+
+        SHA256_Init (&s);
+        for (uint32_t i = 0; i < Size; ++i)
+        {
+            SHA256_Update (&s, &msg[i], 1);
+        }
+        SHA256_Final (&s, digest);
+        toHex (digest, hex);
+        TEST_CHECK (!strcmp (hex, g_vectors[v].digest));
+    }
+}
+
+
+// Set, Check y Load a traves de la pagina de EEPROM de fake/eeprom.c
+static void testRoundTrip ()
+{
+    memset (FAKE_Eeprom, 0xFF, sizeof(FAKE_Eeprom));
+
+    struct PASSWORD p;
+    memset (&p, 0, sizeof(p));
+
+    // Pagina borrada: no hay password guardado
+    TEST_CHECK (!PASSWORD_Load (&p));
+
+    TEST_CHECK (setPlainPassword (&p, "1234"));
+    TEST_CHECK (FAKE_EepromPrograms == 1);
+    // El ID del chip se leyo despues de Chip_IAP_init()
+    TEST_CHECK (FAKE_IapUidReads == 1);
+
+    TEST_CHECK (checkPlain (&p, "1234"));
+    TEST_CHECK (!checkPlain (&p, "1235"));
+    TEST_CHECK (!checkPlain (&p, "123"));
+    TEST_CHECK (!checkPlain (&p, "12345"));
+    TEST_CHECK (!checkPlain (&p, ""));
+
+    struct PASSWORD loaded;
+    memset (&loaded, 0, sizeof(loaded));
+    TEST_CHECK (PASSWORD_Load (&loaded));
+    TEST_CHECK (!memcmp (&loaded, &p, sizeof(p)));
+    TEST_CHECK (checkPlain (&loaded, "1234"));
+
+    // Mismo password, otra sal: otro hash
+    TEST_CHECK (setPlainPassword (&p, "1234"));
+    TEST_CHECK (memcmp (loaded.salt, p.salt, sizeof(p.salt)));
+    TEST_CHECK (memcmp (loaded.hash, p.hash, sizeof(p.hash)));
+    TEST_CHECK (checkPlain (&p, "1234"));
+
+    // Largo maximo y uno mas
+    char longest[PASSWORD_MAX_SIZE + 2];
+    memset (longest, 'x', PASSWORD_MAX_SIZE);
+    longest[PASSWORD_MAX_SIZE] = '\0';
+    TEST_CHECK (setPlainPassword (&p, longest));
+    TEST_CHECK (checkPlain (&p, longest));
+
+    const struct PASSWORD Saved = p;
+    longest[PASSWORD_MAX_SIZE]      = 'x';
+    longest[PASSWORD_MAX_SIZE + 1]  = '\0';
+    TEST_CHECK (!setPlainPassword (&p, longest));
+    TEST_CHECK (!checkPlain (&p, longest));
+    TEST_CHECK (!memcmp (&p, &Saved, sizeof(p)));
+    TEST_CHECK (FAKE_EepromPrograms == 3);
+
+    TEST_CHECK (!PASSWORD_Load (NULL));
+    TEST_CHECK (!PASSWORD_Set (&p, NULL));
+    TEST_CHECK (!PASSWORD_Check (&p, NULL));
+
+    TEST_CHECK (FAKE_EepromInits == 1);
+    TEST_CHECK (FAKE_EepromRegs.AUTOPROG == EEPROM_AUTOPROG_OFF);
+}
+
+
+// Cualquier bit invertido del registro (magic, sal, hash o check) hace
+// fallar PASSWORD_Load() y APP_Init() vuelve al password inicial
+static void testCorruptRecord ()
+{
+    struct PASSWORD p;
+    memset (&p, 0, sizeof(p));
+    TEST_CHECK (setPlainPassword (&p, "4321"));
+
+    uint8_t *page = FAKE_Eeprom[PASSWORD_EEPROM_PAGE];
+    uint32_t rejected = 0;
+
+    for (uint32_t i = 0; i < RECORD_SIZE * 8; ++i)
+    {
+        struct PASSWORD loaded;
+        page[i / 8] ^= 1 << (i % 8);
+        rejected += !PASSWORD_Load (&loaded);
+        page[i / 8] ^= 1 << (i % 8);
+    }
+    TEST_CHECK (rejected == RECORD_SIZE * 8);
+
+    struct PASSWORD loaded;
+    TEST_CHECK (PASSWORD_Load (&loaded));
+    TEST_CHECK (checkPlain (&loaded, "4321"));
+
+    // Lo mismo que APP_Init() con un registro danado
+    page[RECORD_SIZE / 2] ^= 0x80;
+    if (!PASSWORD_Load (&loaded))
+    {
+        TEST_CHECK (setPlainPassword (&loaded, "1234"));
+    }
+    TEST_CHECK (checkPlain (&loaded, "1234"));
+    TEST_CHECK (!checkPlain (&loaded, "4321"));
+    TEST_CHECK (PASSWORD_Load (&p));
+    TEST_CHECK (!memcmp (&p, &loaded, sizeof(p)));
+
+    printf ("  %u of %u single-bit corruptions rejected\n", rejected,
+            (unsigned)(RECORD_SIZE * 8));
+}
+
+
+static void benchHashes ()
+{
+    struct PASSWORD p;
+    uint8_t buffer[PASSWORD_MAX_SIZE + 2];
+    struct ARRAY plain;
+    setPlain            (&plain, buffer, "1234");
+    PASSWORD_Set        (&p, &plain);
+
+    uint32_t checks = 0;
+    uint32_t ok     = 0;
+    const double Start = TEST_Seconds ();
+    double elapsed;
+    do
+    {
+        for (uint32_t i = 0; i < 100; ++i)
+        {
+            ok += PASSWORD_Check (&p, &plain);
+        }
+        checks += 100;
+        elapsed = TEST_Seconds () - Start;
+    }
+    while (elapsed < HASH_SECONDS);
+
+    TEST_CHECK (ok == checks);
+
+    // Cada verificacion: sal + password en un bloque y luego
+    // PASSWORD_HASH_ROUNDS bloques de hash + sal
+    const double Blocks = (double) checks * (PASSWORD_HASH_ROUNDS + 1);
+    printf ("  %.0f PASSWORD_Check/s, %.2f M SHA-256 blocks/s "
+            "(%u rounds)\n", checks / elapsed, Blocks / elapsed * 1e-6,
+            PASSWORD_HASH_ROUNDS);
+}
+
+
+typedef bool (*CompareFunc) (struct ARRAY *a, struct ARRAY *b);
+
+
+static int cmpCycles (const void *a, const void *b)
+{
+    const uint64_t A = *(const uint64_t *) a;
+    const uint64_t B = *(const uint64_t *) b;
+    return (A > B) - (A < B);
+}
+
+
+static double median (uint64_t *samples)
+{
+    qsort (samples, COMPARE_SAMPLES, sizeof(samples[0]), cmpCycles);
+    return (double) samples[COMPARE_SAMPLES / 2] / COMPARE_BATCH;
+}
+
+
+// Mediana de los ciclos por comparacion con la diferencia en el primer y en
+// el ultimo byte. Las muestras se alternan para que los cambios de
+// frecuencia del host afecten a los dos casos por igual.
+static void compareCycles (CompareFunc compare, uint32_t size,
+                           double *first, double *last)
+{
+    static uint8_t da[1024];
+    static uint8_t db[2][1024];
+    static uint64_t samples[2][COMPARE_SAMPLES];
+    struct ARRAY a;
+    struct ARRAY b[2];
+
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        da[i] = db[0][i] = db[1][i] = (uint8_t)(i * 31 + 7);
+    }
+    db[0][0]        ^= 0x01;
+    db[1][size - 1] ^= 0x01;
+
+    ARRAY_InitFlags (&a, da, size, ARRAY_FlagNone);
+    a.index = size;
+    for (uint32_t k = 0; k < 2; ++k)
+    {
+        ARRAY_InitFlags (&b[k], db[k], size, ARRAY_FlagNone);
+        b[k].index = size;
+    }
+
+    uint32_t equal = 0;
+    for (uint32_t s = 0; s < COMPARE_SAMPLES; ++s)
+    {
+        for (uint32_t k = 0; k < 2; ++k)
+        {
+            const uint64_t Start = TEST_Cycles ();
+            for (uint32_t i = 0; i < COMPARE_BATCH; ++i)
+            {
+                __asm__ volatile ("" : : "r" (&a), "r" (&b[k]) : "memory");
+                equal += compare (&a, &b[k]);
+            }
+            samples[k][s] = TEST_Cycles () - Start;
+        }
+    }
+
+    TEST_CHECK (equal == 0);
+
+    *first  = median (samples[0]);
+    *last   = median (samples[1]);
+}
+
+
+// El tiempo de ARRAY_CheckEqualContentsConstTime() no debe depender de
+// donde esta el primer byte distinto; memcmp() corta en el primero
+static void benchCompareTiming ()
+{
+    static const uint32_t Sizes[] = { SHA256_DIGEST_SIZE, 1024 };
+
+    for (uint32_t s = 0; s < sizeof(Sizes) / sizeof(Sizes[0]); ++s)
+    {
+        const uint32_t Size = Sizes[s];
+        double ctFirst, ctLast, mcFirst, mcLast;
+
+        compareCycles (ARRAY_CheckEqualContentsConstTime, Size, &ctFirst,
+                       &ctLast);
+        compareCycles (ARRAY_CheckEqualContents, Size, &mcFirst, &mcLast);
+
+        printf ("  %4u B: const-time %.1f first / %.1f last %s (%.2fx); "
+                "memcmp %.1f / %.1f (%.2fx)\n", Size, ctFirst, ctLast,
+                TEST_CYCLES_UNIT, ctLast / ctFirst, mcFirst, mcLast,
+                mcLast / mcFirst);
+
+        // Margen para el ruido del host
+        TEST_CHECK (ctLast / ctFirst > 0.8 && ctLast / ctFirst < 1.25);
+    }
+}
+
+
+int main ()
+{
+    TEST_RUN (testSha256Vectors);
+    TEST_RUN (testRoundTrip);
+    TEST_RUN (testCorruptRecord);
+    TEST_RUN (benchHashes);
+    TEST_RUN (benchCompareTiming);
+    return TEST_END ();
+}
@@ -0,0 +1,170 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "copos.h"
+#include "swtimer.h"
+#include "systick.h"
+#include "chip.h"
+
+
+static struct SWTIMER   g_timer;
+static uint32_t         g_fired;
+static uint32_t         g_firedAt;
+
+
+static void timerFunc (void *ctx)
+{
+    ++ g_fired;
+    g_firedAt = SYSTICK_Now ();
+}
+
+
+static void task (void *ctx, uint32_t ticks)
+{
+}
+
+
+static void setup (uint32_t now)
+{
+    FAKE_SysTickReset (now);
+    g_fired     = 0;
+    g_firedAt   = 0;
+    SWTIMER_Init (&g_timer, timerFunc, NULL);
+}
+
+
+// Un plazo que cruza el desborde del contador de ticks vence una sola vez,
+// en el tick correcto
+static void testWrapAround ()
+{
+    setup (0xFFFFFFF0);
+
+    const uint32_t Start = SYSTICK_Now ();
+    TEST_CHECK (SWTIMER_Start (&g_timer, Start, 0x20));
+
+    for (uint32_t i = 0; i < 0x40; ++i)
+    {
+        uint32_t ticks;
+        const uint32_t Now = SYSTICK_Now ();
+        const bool Pending = SWTIMER_TicksToNext (Now, &ticks);
+
+        TEST_CHECK (Pending == !g_fired);
+        if (Pending)
+        {
+            TEST_CHECK (ticks == ((Now - Start < 0x20)? 0x20 - (Now - Start)
+                                                      : 0));
+        }
+
+        SWTIMER_Process (Now);
+        FAKE_SysTickStep (1);
+    }
+
+    TEST_CHECK (g_fired == 1);
+    TEST_CHECK (g_firedAt == 0x10);
+    TEST_CHECK (!SWTIMER_Active (&g_timer));
+}
+
+
+// Sin tarea que los revise: el dispatcher duerme hasta el proximo timer y lo
+// dispara al despertar, tambien a traves del desborde
+static void testSchedulerWakeUp ()
+{
+    setup (0xFFFFFF00);
+
+    schedulerInit               ();
+    schedulerSetTimerService    (SWTIMER_Process, SWTIMER_TicksToNext);
+    schedulerStart              (1);
+    TEST_CHECK (schedulerAddTask (task, NULL, 0, 1000) == 0);
+
+    const uint32_t Deadline = SYSTICK_Now () + 0x180;
+    TEST_CHECK (SWTIMER_Start (&g_timer, SYSTICK_Now (), 0x180));
+
+    uint32_t wakeUps = 0;
+    while ((int32_t)(SYSTICK_Now () - Deadline) < 0x100 && wakeUps < 1000)
+    {
+        schedulerDispatchTasks (SYSTICK_Now ());
+        FAKE_SysTickStep (FAKE_SysTickSleep? FAKE_SysTickSleep : 1);
+        ++ wakeUps;
+    }
+
+    TEST_CHECK (g_fired == 1);
+    TEST_CHECK (g_firedAt == Deadline);
+    // Tick de inicio, la tarea (periodo 1000) y el timer
+    TEST_CHECK (wakeUps <= 4);
+
+    schedulerSetTimerService (NULL, NULL);
+}
+
+
+// Arranca un timer que ya vencio: lo atiende el proximo dispatch
+static void startExpiredTask (void *ctx, uint32_t ticks)
+{
+    SWTIMER_Start (&g_timer, ticks, 0);
+}
+
+
+// Un timer vencido durante una tarea no deja dormir, uno por vencer acorta
+// la espera de la tarea periodica
+static void testIdleTicks ()
+{
+    setup (0);
+
+    schedulerInit               ();
+    schedulerSetTimerService    (SWTIMER_Process, SWTIMER_TicksToNext);
+    schedulerStart              (1);
+    TEST_CHECK (schedulerAddTask (task, NULL, 0, 1000) == 0);
+    TEST_CHECK (schedulerAddTask (startExpiredTask, NULL, 0, 0) == 1);
+
+    FAKE_SysTickStep        (1);
+    schedulerDispatchTasks  (SYSTICK_Now ());
+    TEST_CHECK (SWTIMER_Active (&g_timer));
+    TEST_CHECK (FAKE_SysTickSleep == 0);
+
+    schedulerDispatchTasks  (SYSTICK_Now ());
+    TEST_CHECK (g_fired == 1);
+    TEST_CHECK (FAKE_SysTickSleep > 900);
+
+    TEST_CHECK (SWTIMER_Start (&g_timer, SYSTICK_Now (), 3));
+    schedulerDispatchTasks  (SYSTICK_Now ());
+    TEST_CHECK (FAKE_SysTickSleep == 3);
+
+    schedulerSetTimerService (NULL, NULL);
+    SWTIMER_Stop (&g_timer);
+}
+
+
+int main ()
+{
+    TEST_RUN (testWrapAround);
+    TEST_RUN (testSchedulerWakeUp);
+    TEST_RUN (testIdleTicks);
+    return TEST_END ();
+}
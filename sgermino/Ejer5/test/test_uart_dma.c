@@ -0,0 +1,259 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "uart.h"
+#include "uart_io.h"
+#include "chip.h"
+#include <stdlib.h>
+
+
+#define INPUT_SIZE          (32 * 1024)
+
+
+static struct UART      g_uart;
+static uint8_t          g_input     [INPUT_SIZE];
+static uint8_t          g_expected  [INPUT_SIZE];
+
+
+static void setup ()
+{
+    FAKE_Reset      ();
+    UART_Init       (&g_uart, LPC_USART2, 921600);
+    TEST_CHECK      (UART_SetMode (&g_uart, UART_ModeDma));
+}
+
+
+static void step (uint32_t count)
+{
+    while (count --)
+    {
+        FAKE_UartStep (LPC_USART2);
+    }
+}
+
+
+static void drain ()
+{
+    for (uint32_t i = 0; i < 2 * UART_SEND_BUFFER_SIZE &&
+                         (UART_SendPendingCount (&g_uart) ||
+                          LPC_USART2->txCount); ++i)
+    {
+        step (1);
+    }
+}
+
+
+static bool channelsIdle ()
+{
+    for (uint32_t i = 0; i < GPDMA_NUMBER_CHANNELS; ++i)
+    {
+        if (FAKE_Gpdma.CH[i].enabled || FAKE_Gpdma.CH[i].intTc)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// Mensajes de largo variable con la linea corriendo: la salida debe ser la
+// entrada completa, en orden
+static void testOrdering ()
+{
+    setup ();
+
+    uint32_t put = 0;
+    while (put < INPUT_SIZE)
+    {
+        const uint32_t Free = UART_SEND_BUFFER_SIZE - 1 -
+                              UART_SendPendingCount (&g_uart);
+        uint32_t size = 1 + (uint32_t) rand () % 300;
+        if (size > INPUT_SIZE - put)
+        {
+            size = INPUT_SIZE - put;
+        }
+
+        if (size <= Free)
+        {
+            TEST_CHECK (UART_PutBinary (&g_uart, &g_input[put], size));
+            put += size;
+        }
+        step (1 + (uint32_t) rand () % 64);
+    }
+    drain ();
+
+    printf ("  %u bytes in %u transfers, %u DMA interrupts\n",
+            LPC_USART2->txLineSize, FAKE_Gpdma.logCount,
+            FAKE_Gpdma.irqCalls);
+
+    TEST_CHECK (LPC_USART2->txLineSize == INPUT_SIZE);
+    TEST_CHECK (!memcmp (LPC_USART2->txLine, g_input, INPUT_SIZE));
+}
+
+
+// Ninguna transferencia cruza el final del buffer: se parte en dos
+static void testWrapAround ()
+{
+    setup ();
+
+    const uint32_t Begin = (uint32_t)(uintptr_t) g_uart.sendData;
+    const uint32_t End   = Begin + UART_SEND_BUFFER_SIZE;
+
+    // Deja inIndex y outIndex cerca del final del buffer
+    UART_PutBinary  (&g_uart, g_input, UART_SEND_BUFFER_SIZE - 100);
+    drain           ();
+    const uint32_t First = FAKE_Gpdma.logCount;
+
+    UART_PutBinary  (&g_uart, g_input, 300);
+    drain           ();
+
+    bool split = false;
+    for (uint32_t i = 0; i < FAKE_Gpdma.logCount; ++i)
+    {
+        const FAKE_GPDMA_LOG_T *l = &FAKE_Gpdma.log[i];
+        TEST_CHECK (l->src >= Begin && l->src + l->size <= End);
+
+        if (i >= First && l->src + l->size == End &&
+            i + 1 < FAKE_Gpdma.logCount && FAKE_Gpdma.log[i + 1].src == Begin)
+        {
+            split = true;
+        }
+    }
+
+    TEST_CHECK (split);
+    TEST_CHECK (!memcmp (&LPC_USART2->txLine[UART_SEND_BUFFER_SIZE - 100],
+                         g_input, 300));
+}
+
+
+// outIndex avanza solo al completar: al terminar no queda nada pendiente ni
+// en vuelo y las lecturas igualan a las escrituras
+static void testCompletionAccounting ()
+{
+    setup ();
+
+    UART_PutBinary (&g_uart, g_input, 1000);
+    step (10);
+
+    // Transferencia en curso: los bytes siguen pendientes
+    TEST_CHECK (!channelsIdle ());
+    TEST_CHECK (UART_SendPendingCount (&g_uart) == 1000);
+
+    drain ();
+
+    TEST_CHECK (channelsIdle ());
+    TEST_CHECK (UART_SendPendingCount (&g_uart) == 0);
+    TEST_CHECK (g_uart.send.reads == 1000);
+    TEST_CHECK (g_uart.send.writes == 1000);
+    TEST_CHECK (LPC_USART2->txLineSize == 1000);
+}
+
+
+// Con el buffer lleno y una transferencia en vuelo un bloque que no entra se
+// descarta entero: lo que sale es exactamente lo aceptado
+static void testOverflowInFlight ()
+{
+    setup ();
+
+    uint32_t expected = 0;
+    uint32_t rejected = 0;
+
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        const uint32_t Size = 100 + (uint32_t) rand () % 100;
+        const uint32_t Offset = (uint32_t) rand () % (INPUT_SIZE - Size);
+        const uint8_t *Data = &g_input[Offset];
+
+        if (UART_PutBinary (&g_uart, Data, Size))
+        {
+            memcpy (&g_expected[expected], Data, Size);
+            expected += Size;
+        }
+        else
+        {
+            rejected += Size;
+        }
+        step (8);
+    }
+    drain ();
+
+    printf ("  accepted %u bytes, rejected %u\n", expected, rejected);
+
+    TEST_CHECK (rejected > 0);
+    TEST_CHECK (g_uart.send.overflows == rejected);
+    TEST_CHECK (LPC_USART2->txLineSize == expected);
+    TEST_CHECK (!memcmp (LPC_USART2->txLine, g_expected, expected));
+    TEST_CHECK (channelsIdle ());
+}
+
+
+// Sin canales libres UART_SetMode() falla y la UART transmite por
+// interrupcion en lugar de usar un canal ajeno
+static void testNoFreeChannel ()
+{
+    FAKE_Reset      ();
+    UART_Init       (&g_uart, LPC_USART2, 921600);
+    UART_SetMode    (&g_uart, UART_ModePolled);
+
+    Chip_GPDMA_Init (LPC_GPDMA);
+    for (uint32_t i = 0; i < GPDMA_NUMBER_CHANNELS; ++i)
+    {
+        Chip_GPDMA_GetFreeChannel (LPC_GPDMA, 0);
+    }
+    FAKE_Gpdma.CH[0].enabled = true;
+
+    TEST_CHECK (!UART_SetMode (&g_uart, UART_ModeDma));
+    TEST_CHECK (g_uart.mode == UART_ModeInterrupt);
+
+    UART_PutBinary  (&g_uart, g_input, 500);
+    drain           ();
+
+    TEST_CHECK (FAKE_Gpdma.logCount == 0);
+    TEST_CHECK (LPC_USART2->txLineSize == 500);
+    TEST_CHECK (!memcmp (LPC_USART2->txLine, g_input, 500));
+}
+
+
+int main ()
+{
+    srand (1);
+    for (uint32_t i = 0; i < INPUT_SIZE; ++i)
+    {
+        g_input[i] = (uint8_t) rand ();
+    }
+
+    TEST_RUN (testOrdering);
+    TEST_RUN (testWrapAround);
+    TEST_RUN (testCompletionAccounting);
+    TEST_RUN (testOverflowInFlight);
+    TEST_RUN (testNoFreeChannel);
+    return TEST_END ();
+}
@@ -0,0 +1,229 @@
+/*
+    RETRO-CIAA™ Library
+    Copyright 2018 Santiago Germino (royconejo@gmail.com)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+    3.  Neither the name of the copyright holder nor the names of its
+        contributors may be used to endorse or promote products derived from
+        this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "test.h"
+#include "uart.h"
+#include "uart_io.h"
+#include "chip.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+#define INPUT_SIZE          (64 * 1024)
+// Periodo de uartProcessTask / uartRecvTask en main.c
+#define APP_PERIOD_NS       (14 * 1000000ull)
+
+
+static struct UART      g_uart;
+static uint8_t          g_input     [INPUT_SIZE];
+static uint8_t          g_output    [INPUT_SIZE];
+
+
+struct Result
+{
+    uint32_t    delivered;
+    uint32_t    mismatches;
+    uint32_t    hwOverruns;
+    uint32_t    ringOverflows;
+    double      seconds;
+};
+
+
+static void setup (uint32_t baudRate, enum UART_Mode mode)
+{
+    FAKE_Reset      ();
+    UART_Init       (&g_uart, LPC_USART2, baudRate);
+    UART_SetMode    (&g_uart, mode);
+}
+
+
+// Recibe INPUT_SIZE bytes; la aplicacion vacia u->recv cada APP_PERIOD_NS
+// (en modo polled ademas llama a UART_Recv, como uartRecvTask)
+static struct Result receive (uint32_t baudRate, enum UART_Mode mode)
+{
+    setup               (baudRate, mode);
+    FAKE_UartSetRxLine  (LPC_USART2, g_input, INPUT_SIZE);
+
+    const uint64_t  CharNs  = FAKE_UartCharNs (LPC_USART2);
+    struct Result   r       = { 0 };
+    uint64_t        now     = 0;
+    uint64_t        nextApp = APP_PERIOD_NS;
+
+    while (LPC_USART2->rxLineIndex < INPUT_SIZE || LPC_USART2->rxCount ||
+           UART_RecvPendingCount (&g_uart))
+    {
+        FAKE_UartStep (LPC_USART2);
+        now += CharNs;
+
+        if (now < nextApp)
+        {
+            continue;
+        }
+        nextApp += APP_PERIOD_NS;
+
+        UART_Recv (&g_uart);
+        const uint32_t Pending = UART_RecvPendingCount (&g_uart);
+        const uint32_t Room = INPUT_SIZE - r.delivered;
+        const uint32_t Count = (Pending < Room)? Pending : Room;
+        CYCLIC_OutToBuffer (&g_uart.recv, &g_output[r.delivered], Count);
+        r.delivered += Count;
+    }
+
+    // Lo recibido debe ser una subsecuencia ordenada de la entrada
+    uint32_t in = 0;
+    for (uint32_t i = 0; i < r.delivered; ++i)
+    {
+        while (in < INPUT_SIZE && g_input[in] != g_output[i])
+        {
+            ++ in;
+        }
+        if (in == INPUT_SIZE)
+        {
+            ++ r.mismatches;
+            break;
+        }
+        ++ in;
+    }
+
+    r.hwOverruns    = LPC_USART2->rxLost;
+    r.ringOverflows = g_uart.recv.overflows;
+    r.seconds       = now / 1e9;
+    return r;
+}
+
+
+static void report (const char *name, uint32_t baudRate, struct Result r)
+{
+    printf ("  %-9s %6u baud: %5u/%u bytes, %7.0f B/s, "
+            "FIFO overruns %5u, ring overflows %5u\n",
+            name, baudRate, r.delivered, INPUT_SIZE,
+            r.delivered / r.seconds, r.hwOverruns, r.ringOverflows);
+}
+
+
+static void testReceiveThroughput ()
+{
+    static const uint32_t Bauds[] = { 115200, 921600 };
+
+    for (uint32_t i = 0; i < sizeof(Bauds) / sizeof(Bauds[0]); ++i)
+    {
+        const struct Result Polled = receive (Bauds[i], UART_ModePolled);
+        report ("polled", Bauds[i], Polled);
+
+        const struct Result Irq = receive (Bauds[i], UART_ModeInterrupt);
+        report ("interrupt", Bauds[i], Irq);
+
+        TEST_CHECK (Irq.mismatches == 0);
+        // Lo que no entra en u->recv se descarta y se cuenta, no se pisa
+        TEST_CHECK (Irq.delivered + Irq.ringOverflows == INPUT_SIZE);
+        // El handler vacia la FIFO antes de que se llene
+        TEST_CHECK (Irq.hwOverruns == 0);
+        TEST_CHECK (g_uart.recvOverruns == 0);
+        TEST_CHECK (Polled.hwOverruns > 0);
+    }
+
+    // A 115200 el buffer de recepcion alcanza para el periodo de la app
+    const struct Result Irq = receive (115200, UART_ModeInterrupt);
+    TEST_CHECK (Irq.delivered == INPUT_SIZE);
+    TEST_CHECK (Irq.ringOverflows == 0);
+}
+
+
+// Un OE que llega mientras el handler vacia la FIFO tambien se cuenta
+static void testOverrunWhileDraining ()
+{
+    static const uint8_t Data[8] = "01234567";
+
+    setup               (115200, UART_ModeInterrupt);
+    FAKE_UartSetRxLine  (LPC_USART2, Data, sizeof(Data));
+    LPC_USART2->overrunOnRead = 3;
+
+    for (uint32_t i = 0; i < sizeof(Data) + 8; ++i)
+    {
+        FAKE_UartStep (LPC_USART2);
+    }
+
+    TEST_CHECK (UART_RecvPendingCount (&g_uart) == sizeof(Data));
+    TEST_CHECK (g_uart.recvOverruns == 1);
+}
+
+
+static void testTransmit ()
+{
+    static const uint32_t Bauds[] = { 115200, 921600 };
+    const uint32_t Size = 8 * 1024;
+
+    for (uint32_t i = 0; i < sizeof(Bauds) / sizeof(Bauds[0]); ++i)
+    {
+        setup (Bauds[i], UART_ModeInterrupt);
+
+        const uint64_t  CharNs  = FAKE_UartCharNs (LPC_USART2);
+        uint32_t        put     = 0;
+        uint64_t        now     = 0;
+
+        while (LPC_USART2->txLineSize < Size)
+        {
+            const uint32_t Free = UART_SEND_BUFFER_SIZE - 1 -
+                                  UART_SendPendingCount (&g_uart);
+            const uint32_t Count = (Size - put < Free)? Size - put : Free;
+            if (Count)
+            {
+                UART_PutBinary (&g_uart, &g_input[put], Count);
+                put += Count;
+            }
+
+            FAKE_UartStep (LPC_USART2);
+            now += CharNs;
+        }
+
+        printf ("  interrupt %6u baud: sent %u bytes, %7.0f B/s, "
+                "%u interrupts\n", Bauds[i], Size, Size / (now / 1e9),
+                LPC_USART2->irqCalls);
+
+        TEST_CHECK (!memcmp (LPC_USART2->txLine, g_input, Size));
+        // Sin huecos en la linea: un caracter por paso
+        TEST_CHECK (now <= (Size + 2) * CharNs);
+    }
+}
+
+
+int main ()
+{
+    srand (1);
+    for (uint32_t i = 0; i < INPUT_SIZE; ++i)
+    {
+        g_input[i] = (uint8_t) rand ();
+    }
+
+    TEST_RUN (testReceiveThroughput);
+    TEST_RUN (testOverrunWhileDraining);
+    TEST_RUN (testTransmit);
+    return TEST_END ();
+}